@@ -0,0 +1,251 @@
+/* sample_histogram.c - log-linear latency histogram shared by the course projects.  */
+
+#include   "sample_histogram.h"
+#include   <stdio.h>
+#include   <string.h>
+
+#define SAMPLE_HISTOGRAM_HALF               (1UL << (SAMPLE_HISTOGRAM_PRECISION_BITS - 1))
+
+/* Define the number of percentiles printed.  */
+#define SAMPLE_HISTOGRAM_PRINTED            4
+
+static UINT     sample_histogram_index(ULONG value);
+static ULONG    sample_histogram_value(UINT index);
+
+
+/* Empty a histogram.  */
+VOID    sample_histogram_reset(SAMPLE_HISTOGRAM *histogram_ptr)
+{
+UINT    old_posture;
+
+    old_posture = tx_interrupt_control(TX_INT_DISABLE);
+    memset(histogram_ptr, 0, sizeof(SAMPLE_HISTOGRAM));
+    histogram_ptr -> sample_histogram_min = ~((ULONG)0);
+    tx_interrupt_control(old_posture);
+}
+
+
+/* Count a value.  */
+VOID    sample_histogram_record(SAMPLE_HISTOGRAM *histogram_ptr, ULONG value)
+{
+UINT    old_posture;
+UINT    index = sample_histogram_index(value);
+
+    old_posture = tx_interrupt_control(TX_INT_DISABLE);
+    histogram_ptr -> sample_histogram_buckets[index]++;
+    histogram_ptr -> sample_histogram_count++;
+    histogram_ptr -> sample_histogram_total += value;
+    if (value < histogram_ptr -> sample_histogram_min)
+    {
+        histogram_ptr -> sample_histogram_min = value;
+    }
+    if (value > histogram_ptr -> sample_histogram_max)
+    {
+        histogram_ptr -> sample_histogram_max = value;
+    }
+    tx_interrupt_control(old_posture);
+}
+
+
+/* Add the counts of one histogram to another, such as those of several threads.  The
+   counts are added in place, so no copy of the source is made on the stack.  */
+VOID    sample_histogram_merge(SAMPLE_HISTOGRAM *target_ptr, SAMPLE_HISTOGRAM *source_ptr)
+{
+UINT    old_posture;
+UINT    i;
+
+    old_posture = tx_interrupt_control(TX_INT_DISABLE);
+    for (i = 0; i < SAMPLE_HISTOGRAM_BUCKETS; i++)
+    {
+        target_ptr -> sample_histogram_buckets[i] += source_ptr -> sample_histogram_buckets[i];
+    }
+    target_ptr -> sample_histogram_count += source_ptr -> sample_histogram_count;
+    target_ptr -> sample_histogram_total += source_ptr -> sample_histogram_total;
+    if (source_ptr -> sample_histogram_min < target_ptr -> sample_histogram_min)
+    {
+        target_ptr -> sample_histogram_min = source_ptr -> sample_histogram_min;
+    }
+    if (source_ptr -> sample_histogram_max > target_ptr -> sample_histogram_max)
+    {
+        target_ptr -> sample_histogram_max = source_ptr -> sample_histogram_max;
+    }
+    tx_interrupt_control(old_posture);
+}
+
+
+/* Copy a histogram that is still being recorded into, and optionally empty it to start
+   the next interval.  */
+VOID    sample_histogram_snapshot(SAMPLE_HISTOGRAM *snapshot_ptr, SAMPLE_HISTOGRAM *histogram_ptr, UINT reset)
+{
+UINT    old_posture;
+
+    old_posture = tx_interrupt_control(TX_INT_DISABLE);
+    memcpy(snapshot_ptr, histogram_ptr, sizeof(SAMPLE_HISTOGRAM));
+    if (reset)
+    {
+        memset(histogram_ptr, 0, sizeof(SAMPLE_HISTOGRAM));
+        histogram_ptr -> sample_histogram_min = ~((ULONG)0);
+    }
+    tx_interrupt_control(old_posture);
+}
+
+
+/* Return the value below which the given share of the values lie, in hundredths of a
+   percent.  The value is the highest of its bucket, and never above the maximum.  */
+ULONG   sample_histogram_percentile(SAMPLE_HISTOGRAM *histogram_ptr, ULONG percentile)
+{
+ULONG64 rank;
+ULONG64 seen = 0;
+ULONG   value;
+UINT    i;
+
+    if (histogram_ptr -> sample_histogram_count == 0)
+    {
+        return(0);
+    }
+
+    /* Find the bucket holding the value of that rank, counting from 1.  */
+    rank = ((ULONG64)histogram_ptr -> sample_histogram_count * percentile + 9999) / 10000;
+    if (rank == 0)
+    {
+        rank = 1;
+    }
+
+    for (i = 0; i < SAMPLE_HISTOGRAM_BUCKETS; i++)
+    {
+        seen += histogram_ptr -> sample_histogram_buckets[i];
+        if (seen >= rank)
+        {
+            break;
+        }
+    }
+
+    value = sample_histogram_value(i);
+    if (value > histogram_ptr -> sample_histogram_max)
+    {
+        value = histogram_ptr -> sample_histogram_max;
+    }
+    return(value);
+}
+
+
+ULONG   sample_histogram_mean(SAMPLE_HISTOGRAM *histogram_ptr)
+{
+
+    if (histogram_ptr -> sample_histogram_count == 0)
+    {
+        return(0);
+    }
+
+    return((ULONG)(histogram_ptr -> sample_histogram_total / histogram_ptr -> sample_histogram_count));
+}
+
+
+/* Print the count and the distribution on one line.  The percentiles are found in one
+   pass over the live buckets with interrupts disabled rather than from a copy, so that
+   this can run on the small stack of the timer thread.  */
+VOID    sample_histogram_print(SAMPLE_HISTOGRAM *histogram_ptr, CHAR *name, CHAR *unit)
+{
+static const ULONG  percentiles[SAMPLE_HISTOGRAM_PRINTED] = { SAMPLE_HISTOGRAM_P50, SAMPLE_HISTOGRAM_P90,
+                                                              SAMPLE_HISTOGRAM_P99, SAMPLE_HISTOGRAM_P999 };
+ULONG               values[SAMPLE_HISTOGRAM_PRINTED];
+ULONG64             rank;
+ULONG64             seen = 0;
+ULONG64             total;
+ULONG               count;
+ULONG               min;
+ULONG               max;
+UINT                old_posture;
+UINT                i;
+UINT                j = 0;
+
+    old_posture = tx_interrupt_control(TX_INT_DISABLE);
+    count = histogram_ptr -> sample_histogram_count;
+    min = histogram_ptr -> sample_histogram_min;
+    max = histogram_ptr -> sample_histogram_max;
+    total = histogram_ptr -> sample_histogram_total;
+
+    /* The percentiles ascend, so each continues the walk where the previous one stopped.  */
+    for (i = 0; (count != 0) && (i < SAMPLE_HISTOGRAM_BUCKETS) && (j < SAMPLE_HISTOGRAM_PRINTED); i++)
+    {
+        seen += histogram_ptr -> sample_histogram_buckets[i];
+        for (; j < SAMPLE_HISTOGRAM_PRINTED; j++)
+        {
+            rank = ((ULONG64)count * percentiles[j] + 9999) / 10000;
+            if (seen < rank)
+            {
+                break;
+            }
+            values[j] = sample_histogram_value(i);
+            if (values[j] > max)
+            {
+                values[j] = max;
+            }
+        }
+    }
+    tx_interrupt_control(old_posture);
+
+    if (count == 0)
+    {
+        printf("%s: no samples\n", name);
+        return;
+    }
+
+    printf("%s: count %lu, min %lu, mean %lu, p50 %lu, p90 %lu, p99 %lu, p99.9 %lu, max %lu %s\n",
+           name, count, min, (ULONG)(total / count),
+           values[0], values[1], values[2], values[3], max, unit);
+}
+
+
+/* Map a value to its bucket.  Small values are exact; larger ones keep their top
+   SAMPLE_HISTOGRAM_PRECISION_BITS bits.  */
+static UINT     sample_histogram_index(ULONG value)
+{
+UINT    shift;
+UINT    msb;
+#ifndef __GNUC__
+ULONG   bits;
+UINT    step;
+#endif /* __GNUC__ */
+
+    if (value < (SAMPLE_HISTOGRAM_HALF << 1))
+    {
+        return((UINT)value);
+    }
+
+    /* Find the most significant bit.  */
+#ifdef __GNUC__
+    msb = 31 - (UINT)__builtin_clz((unsigned int)value);
+#else
+    msb = 0;
+    bits = value;
+    for (step = 16; step > 0; step >>= 1)
+    {
+        if (bits >> step)
+        {
+            bits >>= step;
+            msb += step;
+        }
+    }
+#endif /* __GNUC__ */
+
+    shift = msb - (SAMPLE_HISTOGRAM_PRECISION_BITS - 1);
+    return((UINT)(shift * SAMPLE_HISTOGRAM_HALF + (value >> shift)));
+}
+
+
+/* Return the highest value of a bucket.  */
+static ULONG    sample_histogram_value(UINT index)
+{
+UINT    shift;
+ULONG   mantissa;
+
+    if (index < (SAMPLE_HISTOGRAM_HALF << 1))
+    {
+        return((ULONG)index);
+    }
+
+    shift = index / SAMPLE_HISTOGRAM_HALF - 1;
+    mantissa = index % SAMPLE_HISTOGRAM_HALF + SAMPLE_HISTOGRAM_HALF;
+    return((((mantissa + 1) << shift) - 1));
+}
@@ -0,0 +1,53 @@
+/* sample_histogram.h - log-linear latency histogram shared by the course projects.
+
+   Values below 2^SAMPLE_HISTOGRAM_PRECISION_BITS have a bucket each.  Above that every power of
+   two is split into 2^(SAMPLE_HISTOGRAM_PRECISION_BITS - 1) equal buckets, so a reported value
+   is within 1 / 2^(SAMPLE_HISTOGRAM_PRECISION_BITS - 1) of the true one across the whole ULONG
+   range.  A histogram is a plain structure with no allocation; recording takes constant time
+   and may be done from threads and timer callbacks alike.  Merging and printing work on the
+   histogram in place, as a copy would not fit on the timer thread stack; a snapshot buffer
+   should be static for the same reason.  The unit is up to the caller, for example timer
+   ticks or microseconds.  */
+
+#ifndef SAMPLE_HISTOGRAM_H
+#define SAMPLE_HISTOGRAM_H
+
+#include   "tx_api.h"
+
+#ifndef SAMPLE_HISTOGRAM_PRECISION_BITS
+#define SAMPLE_HISTOGRAM_PRECISION_BITS     5
+#endif /* SAMPLE_HISTOGRAM_PRECISION_BITS */
+
+#if (SAMPLE_HISTOGRAM_PRECISION_BITS < 1) || (SAMPLE_HISTOGRAM_PRECISION_BITS > 16)
+#error "SAMPLE_HISTOGRAM_PRECISION_BITS must be between 1 and 16"
+#endif
+
+/* Define the number of buckets covering every ULONG value.  */
+#define SAMPLE_HISTOGRAM_BUCKETS            ((34 - SAMPLE_HISTOGRAM_PRECISION_BITS) << \
+                                             (SAMPLE_HISTOGRAM_PRECISION_BITS - 1))
+
+/* Define the usual percentiles, in hundredths of a percent.  */
+#define SAMPLE_HISTOGRAM_P50                5000
+#define SAMPLE_HISTOGRAM_P90                9000
+#define SAMPLE_HISTOGRAM_P99                9900
+#define SAMPLE_HISTOGRAM_P999               9990
+
+typedef struct SAMPLE_HISTOGRAM_STRUCT
+{
+    ULONG                   sample_histogram_count;
+    ULONG                   sample_histogram_min;
+    ULONG                   sample_histogram_max;
+    ULONG64                 sample_histogram_total;
+    ULONG                   sample_histogram_buckets[SAMPLE_HISTOGRAM_BUCKETS];
+} SAMPLE_HISTOGRAM;
+
+/* Define histogram functions.  */
+VOID    sample_histogram_reset(SAMPLE_HISTOGRAM *histogram_ptr);
+VOID    sample_histogram_record(SAMPLE_HISTOGRAM *histogram_ptr, ULONG value);
+VOID    sample_histogram_merge(SAMPLE_HISTOGRAM *target_ptr, SAMPLE_HISTOGRAM *source_ptr);
+VOID    sample_histogram_snapshot(SAMPLE_HISTOGRAM *snapshot_ptr, SAMPLE_HISTOGRAM *histogram_ptr, UINT reset);
+ULONG   sample_histogram_percentile(SAMPLE_HISTOGRAM *histogram_ptr, ULONG percentile);
+ULONG   sample_histogram_mean(SAMPLE_HISTOGRAM *histogram_ptr);
+VOID    sample_histogram_print(SAMPLE_HISTOGRAM *histogram_ptr, CHAR *name, CHAR *unit);
+
+#endif /* SAMPLE_HISTOGRAM_H */
@@ -9,11 +9,31 @@
 /*                                                                        */
 /**************************************************************************/
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stddef.h>
+#include <stdio.h>
+#include <errno.h>
 #include <sys/socket.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <semaphore.h>
+#include <time.h>
 #include <unistd.h>
 #include <net/if.h>
 #include <net/ethernet.h>
+#include <netinet/in.h>
 #include <linux/if_packet.h>
+#include <linux/filter.h>
+#include <linux/virtio_net.h>
+#include <linux/bpf.h>
+#include <linux/if_link.h>
+#include <linux/if_xdp.h>
+#include <linux/io_uring.h>
 #include "nx_api.h"
 
 #ifdef NX_ENABLE_PPPOE
@@ -43,260 +63,5008 @@
 
    42          18          Padding on ARP and RARP messages only.  */
 
-#define NX_ETHERNET_IP              0x0800
-#define NX_ETHERNET_ARP             0x0806
-#define NX_ETHERNET_RARP            0x8035
-#define NX_ETHERNET_IPV6            0x86DD
-#define NX_ETHERNET_PPPOE_DISCOVERY 0x8863
-#define NX_ETHERNET_PPPOE_SESSION   0x8864
-#define NX_ETHERNET_SIZE            14
-#define NX_ETHERNET_MAC_SIZE        6
+#define NX_ETHERNET_IP              0x0800
+#define NX_ETHERNET_ARP             0x0806
+#define NX_ETHERNET_RARP            0x8035
+#define NX_ETHERNET_IPV6            0x86DD
+#define NX_ETHERNET_PPPOE_DISCOVERY 0x8863
+#define NX_ETHERNET_PPPOE_SESSION   0x8864
+#define NX_ETHERNET_SIZE            14
+#define NX_ETHERNET_MAC_SIZE        6
+
+/* Define the maximum number of frames the receive thread drains from the socket
+   per wakeup.  When this is larger than 1, frames are received with recvmmsg()
+   directly into pre-allocated packets and all of them are handed to NetX within
+   one context save/restore window.  */
+#ifndef NX_LINUX_RECEIVE_BATCH_SIZE
+#define NX_LINUX_RECEIVE_BATCH_SIZE 1
+#endif
+
+/* Define the maximum number of packets one received frame may be spread over.
+   When the packet pool payload cannot hold a full frame, the driver receives
+   with scatter-gather vectors that point into a chain of pool packets, so
+   frames never go through an intermediate buffer.  */
+#ifndef NX_DISABLE_PACKET_CHAIN
+#ifndef NX_LINUX_RECEIVE_VECTOR_COUNT
+#define NX_LINUX_RECEIVE_VECTOR_COUNT 8
+#endif
+#else
+#undef NX_LINUX_RECEIVE_VECTOR_COUNT
+#define NX_LINUX_RECEIVE_VECTOR_COUNT 1
+#endif /* NX_DISABLE_PACKET_CHAIN */
+
+/* Define the number of receive queues.  When this is larger than 1, the driver
+   opens one AF_PACKET socket per queue and joins them in a PACKET_FANOUT_HASH
+   group, so the kernel spreads flows across the sockets while keeping each flow
+   on a single queue.  Every queue has its own receive thread, which keeps
+   frames of a flow in order.  Define NX_LINUX_RECEIVE_QUEUE_FIRST_CPU to pin
+   the thread of queue N to CPU (NX_LINUX_RECEIVE_QUEUE_FIRST_CPU + N).  */
+#ifndef NX_LINUX_RECEIVE_QUEUE_COUNT
+#define NX_LINUX_RECEIVE_QUEUE_COUNT 1
+#endif
+
+/* Define NX_LINUX_ENABLE_RX_RING to receive through a memory-mapped TPACKET_V3
+   ring instead of recvfrom().  The kernel writes frames into blocks of the ring
+   and the receive thread walks the block descriptors, so no system call is made
+   per frame; the thread only polls when the ring is empty.  A block is handed to
+   the driver when it is full or when the retire timeout (in milliseconds)
+   expires, so keep the timeout small for request/response traffic.  If the ring
+   cannot be set up, the driver falls back to recvfrom().  */
+#ifdef NX_LINUX_ENABLE_RX_RING
+#ifndef NX_LINUX_RX_RING_BLOCK_SIZE
+#define NX_LINUX_RX_RING_BLOCK_SIZE     (1 << 16)
+#endif
+#ifndef NX_LINUX_RX_RING_BLOCK_COUNT
+#define NX_LINUX_RX_RING_BLOCK_COUNT    16
+#endif
+#ifndef NX_LINUX_RX_RING_FRAME_SIZE
+#define NX_LINUX_RX_RING_FRAME_SIZE     2048
+#endif
+#ifndef NX_LINUX_RX_RING_RETIRE_TIMEOUT
+#define NX_LINUX_RX_RING_RETIRE_TIMEOUT 1
+#endif
+#endif /* NX_LINUX_ENABLE_RX_RING */
+
+/* Define NX_LINUX_ENABLE_DEFERRED_RECEIVE to move receive processing onto the IP
+   thread.  The receive thread reads frames straight into pool packets, queues
+   the packets on a ring owned by its queue and notifies the IP thread with
+   _nx_ip_driver_deferred_processing().  Ethernet type dispatch runs in
+   NX_LINK_DEFERRED_PROCESSING, so the simulated ISR window only covers packet
+   allocation and the notification.  Frames are dropped when the ring is full.
+   NX_LINUX_DEFERRED_RING_SIZE must be a power of 2.  */
+#ifdef NX_LINUX_ENABLE_DEFERRED_RECEIVE
+#ifdef NX_LINUX_ENABLE_RX_RING
+#error "NX_LINUX_ENABLE_DEFERRED_RECEIVE and NX_LINUX_ENABLE_RX_RING cannot be used together."
+#endif /* NX_LINUX_ENABLE_RX_RING */
+#ifndef NX_LINUX_DEFERRED_RING_SIZE
+#define NX_LINUX_DEFERRED_RING_SIZE     64
+#endif
+#endif /* NX_LINUX_ENABLE_DEFERRED_RECEIVE */
+
+/* Define NX_LINUX_ENABLE_TX_RING to transmit through a memory-mapped
+   PACKET_TX_RING instead of one sendto() per frame.  Frames are copied into ring
+   slots and the kernel is kicked once per batch: when NX_LINUX_TX_RING_FLUSH_THRESHOLD
+   frames are pending, or when the IP thread runs its deferred driver processing
+   after the current burst of NX_LINK_PACKET_SEND requests.  If the ring is full,
+   the driver waits up to NX_LINUX_TX_RING_WAIT milliseconds for a free slot.  */
+#ifdef NX_LINUX_ENABLE_TX_RING
+#ifndef NX_LINUX_TX_RING_BLOCK_SIZE
+#define NX_LINUX_TX_RING_BLOCK_SIZE       4096
+#endif
+#ifndef NX_LINUX_TX_RING_BLOCK_COUNT
+#define NX_LINUX_TX_RING_BLOCK_COUNT      128
+#endif
+#ifndef NX_LINUX_TX_RING_FRAME_SIZE
+#define NX_LINUX_TX_RING_FRAME_SIZE       2048
+#endif
+#ifndef NX_LINUX_TX_RING_FLUSH_THRESHOLD
+#define NX_LINUX_TX_RING_FLUSH_THRESHOLD  32
+#endif
+#ifndef NX_LINUX_TX_RING_WAIT
+#define NX_LINUX_TX_RING_WAIT             10
+#endif
+#define NX_LINUX_TX_RING_FRAME_COUNT      ((NX_LINUX_TX_RING_BLOCK_SIZE / NX_LINUX_TX_RING_FRAME_SIZE) * \
+                                           NX_LINUX_TX_RING_BLOCK_COUNT)
+#define NX_LINUX_TX_RING_DATA_OFFSET      (TPACKET2_HDRLEN - sizeof(struct sockaddr_ll))
+#endif /* NX_LINUX_ENABLE_TX_RING */
+
+/* Define NX_LINUX_ENABLE_ASYNC_TRANSMIT to hand frames to a dedicated transmit
+   thread instead of sending them synchronously from the calling NetX thread.
+   The transmit thread sends up to NX_LINUX_TRANSMIT_BATCH_SIZE queued frames,
+   then releases them back to the pool in one simulated TX complete interrupt.
+   NX_LINUX_TRANSMIT_QUEUE_SIZE must be a power of 2; frames are dropped when
+   the queue is full.  */
+#ifdef NX_LINUX_ENABLE_ASYNC_TRANSMIT
+#ifndef NX_LINUX_TRANSMIT_QUEUE_SIZE
+#define NX_LINUX_TRANSMIT_QUEUE_SIZE      256
+#endif
+#ifndef NX_LINUX_TRANSMIT_BATCH_SIZE
+#define NX_LINUX_TRANSMIT_BATCH_SIZE      32
+#endif
+#endif /* NX_LINUX_ENABLE_ASYNC_TRANSMIT */
+
+/* Define NX_LINUX_ENABLE_CHECKSUM_OFFLOAD to advertise receive checksums only for
+   frames the kernel has validated, and to offload transmit checksums.  Receive
+   sockets enable PACKET_AUXDATA, and each packet is marked when its status has
+   TP_STATUS_CSUM_VALID or TP_STATUS_CSUMNOTREADY.  NetX looks at the interface
+   capability only, so the driver verifies the IPv4 header and TCP/UDP/ICMP
+   checksums of unmarked frames and drops the bad ones.  Frames are sent with a
+   virtio-net header on a PACKET_VNET_HDR socket, and the kernel completes the
+   TCP/UDP checksums NetX leaves to the driver.  */
+#ifdef NX_LINUX_ENABLE_CHECKSUM_OFFLOAD
+#ifndef NX_ENABLE_INTERFACE_CAPABILITY
+#error "NX_LINUX_ENABLE_CHECKSUM_OFFLOAD requires NX_ENABLE_INTERFACE_CAPABILITY."
+#endif /* NX_ENABLE_INTERFACE_CAPABILITY */
+
+/* Define the control buffer that receives the PACKET_AUXDATA message.  */
+typedef union NX_LINUX_AUXDATA_CONTROL_UNION
+{
+    struct cmsghdr  nx_linux_auxdata_header;
+    UCHAR           nx_linux_auxdata_buffer[CMSG_SPACE(sizeof(struct tpacket_auxdata))];
+} NX_LINUX_AUXDATA_CONTROL;
+#endif /* NX_LINUX_ENABLE_CHECKSUM_OFFLOAD */
+
+/* Define NX_LINUX_ENABLE_GSO to let NetX send TCP segments larger than the link
+   MTU.  The interface advertises an IP MTU of NX_LINUX_GSO_MTU, and a TCP frame
+   larger than NX_LINK_MTU is sent in one call with a virtio-net header of type
+   VIRTIO_NET_HDR_GSO_TCPV4/TCPV6, which the kernel segments to link-size frames.
+   NetX never sends segments larger than the MSS of the peer, so the driver raises
+   the MSS option of received SYN segments when the peer accepts full link-size
+   segments.  NetX no longer fragments UDP datagrams and ICMP messages to the link
+   MTU, so the driver does: larger IPv4 datagrams are split into fragments, and
+   larger IPv6 ones are split behind a fragment header.  Those that cannot be
+   fragmented, IPv4 ones with Don't Fragment set and IPv6 ones with extension
+   headers, are dropped and counted as tx_oversize_drops.
+
+   NetX counts its congestion window and slow start in segments of that MSS, so
+   the raised MSS makes each step of its congestion control that many link-size
+   segments on the wire; at the full NX_LINUX_GSO_MTU that is about 44 times the
+   burst and growth of an unmodified connection.  The raised MSS is therefore
+   limited to NX_LINUX_GSO_MSS_MULTIPLE times the MSS of the peer.  Raise it for
+   throughput on lossless links, or set it to 1 to leave the MSS alone.  */
+#ifdef NX_LINUX_ENABLE_GSO
+#ifndef NX_LINUX_ENABLE_CHECKSUM_OFFLOAD
+#error "NX_LINUX_ENABLE_GSO requires NX_LINUX_ENABLE_CHECKSUM_OFFLOAD."
+#endif /* NX_LINUX_ENABLE_CHECKSUM_OFFLOAD */
+#ifndef NX_LINUX_GSO_MTU
+#define NX_LINUX_GSO_MTU                  64000
+#endif
+#ifndef NX_LINUX_GSO_MSS_MULTIPLE
+#define NX_LINUX_GSO_MSS_MULTIPLE         4
+#endif
+#if NX_LINUX_GSO_MSS_MULTIPLE < 1
+#error "NX_LINUX_GSO_MSS_MULTIPLE must be at least 1."
+#endif
+#define NX_LINUX_TRANSMIT_BUFFER_SIZE     (NX_LINUX_GSO_MTU + NX_ETHERNET_SIZE)
+#else
+#define NX_LINUX_TRANSMIT_BUFFER_SIZE     NX_MAX_PACKET_SIZE
+#endif /* NX_LINUX_ENABLE_GSO */
+
+/* Define NX_LINUX_ENABLE_GRO to coalesce TCP segments before they reach NetX.
+   Within one receive batch (a recvmmsg() call, an RX ring block, a deferred
+   drain, or the frames an AF_XDP or io_uring wakeup reaps), consecutive in-order
+   segments of the same flow that only carry data and an acknowledgment are
+   chained into one packet, so NetX runs its TCP input once per run of segments
+   instead of once per MSS.  The merged packet keeps the TCP checksum of its
+   first segment, so every segment is verified before it is merged and NetX must
+   skip receive checksums.  Frames received one by one are never merged, so one
+   of those receive paths is required.  */
+#ifdef NX_LINUX_ENABLE_GRO
+#ifndef NX_LINUX_ENABLE_CHECKSUM_OFFLOAD
+#error "NX_LINUX_ENABLE_GRO requires NX_LINUX_ENABLE_CHECKSUM_OFFLOAD."
+#endif /* NX_LINUX_ENABLE_CHECKSUM_OFFLOAD */
+#if (NX_LINUX_RECEIVE_BATCH_SIZE <= 1) && !defined(NX_LINUX_ENABLE_RX_RING) && !defined(NX_LINUX_ENABLE_DEFERRED_RECEIVE) && \
+    !defined(NX_LINUX_ENABLE_XSK) && !defined(NX_LINUX_ENABLE_IO_URING)
+#error "NX_LINUX_ENABLE_GRO requires NX_LINUX_RECEIVE_BATCH_SIZE > 1, NX_LINUX_ENABLE_RX_RING, NX_LINUX_ENABLE_DEFERRED_RECEIVE, NX_LINUX_ENABLE_XSK or NX_LINUX_ENABLE_IO_URING."
+#endif
+#ifdef NX_DISABLE_PACKET_CHAIN
+#error "NX_LINUX_ENABLE_GRO requires packet chaining."
+#endif /* NX_DISABLE_PACKET_CHAIN */
+#endif /* NX_LINUX_ENABLE_GRO */
+
+/* Define the number of multicast MAC addresses the driver can join.  Joined
+   addresses are kept in a table and programmed into the interface with
+   PACKET_ADD_MEMBERSHIP.  Define NX_LINUX_ENABLE_MULTICAST_FILTER to also drop
+   multicast frames whose destination is not in the table in the receive loop,
+   before the frame is copied into a packet or handed to NetX.  Broadcast frames
+   are always accepted.  */
+#ifndef NX_LINUX_MULTICAST_TABLE_SIZE
+#define NX_LINUX_MULTICAST_TABLE_SIZE     16
+#endif
+
+/* Define NX_LINUX_ENABLE_RECEIVE_FILTER to attach a classic BPF program to the
+   receive sockets.  The program accepts frames sent to our unicast address, to
+   broadcast and to the joined multicast addresses, and drops the frames this host
+   transmits, which the kernel otherwise loops back to packet sockets.  Foreign
+   frames are dropped in the kernel, without waking the receive thread.  The
+   program is rebuilt when the physical address changes or a multicast address is
+   joined or left.  */
+#ifdef NX_LINUX_ENABLE_RECEIVE_FILTER
+#define NX_LINUX_RECEIVE_FILTER_SIZE      (3 + 5 * (NX_LINUX_MULTICAST_TABLE_SIZE + 2))
+#if NX_LINUX_MULTICAST_TABLE_SIZE > 48
+#error "NX_LINUX_ENABLE_RECEIVE_FILTER supports at most 48 multicast addresses."
+#endif
+#endif /* NX_LINUX_ENABLE_RECEIVE_FILTER */
+
+/* Define NX_LINUX_ENABLE_XSK to receive and transmit through AF_XDP sockets.
+   The default packet pool of the IP instance is registered as the UMEM of each
+   socket, so the kernel writes received frames straight into the NetX packets
+   posted on the fill ring, and packets are sent from where NetX built them and
+   released when they come back on the completion ring.  Receive queue N binds
+   its socket to queue N of the interface, and a small XDP program attached in
+   generic (SKB) mode redirects the frames of those queues, so no special NIC is
+   needed and veth works.  The program takes every frame of a bound queue, so
+   give each instance its own Linux interface.  Each queue keeps up to
+   NX_LINUX_XSK_FILL_COUNT packets of the pool posted for receive; size the pool
+   for them.  A queue whose socket cannot be set up, for example on a kernel
+   without AF_XDP or without CAP_NET_ADMIN and CAP_BPF, stays on AF_PACKET.
+   Chained packets, packets of other pools, and frames that find the transmit
+   ring full are sent with sendto().  AF_XDP carries no checksum status, so with
+   NX_LINUX_ENABLE_CHECKSUM_OFFLOAD the driver verifies every received frame, and
+   frames whose checksums are left to the kernel go out on the virtio-net socket.
+   NX_LINUX_XSK_RING_SIZE must be a power of 2.  */
+#ifdef NX_LINUX_ENABLE_XSK
+#ifndef NX_LINUX_XSK_RING_SIZE
+#define NX_LINUX_XSK_RING_SIZE            64
+#endif
+#ifndef NX_LINUX_XSK_FILL_COUNT
+#define NX_LINUX_XSK_FILL_COUNT           8
+#endif
+#ifndef NX_LINUX_XSK_FLUSH_THRESHOLD
+#define NX_LINUX_XSK_FLUSH_THRESHOLD      16
+#endif
+#if NX_LINUX_XSK_FILL_COUNT > NX_LINUX_XSK_RING_SIZE
+#error "NX_LINUX_XSK_FILL_COUNT cannot be larger than NX_LINUX_XSK_RING_SIZE."
+#endif
+
+/* Define the smallest UMEM chunk the kernel accepts.  */
+#define NX_LINUX_XSK_MIN_CHUNK_SIZE       2048
+
+#ifndef AF_XDP
+#define AF_XDP                            44
+#endif
+#ifndef SOL_XDP
+#define SOL_XDP                           283
+#endif
+
+/* Define a ring mapped from an AF_XDP socket.  The driver is the only producer of
+   the fill and transmit rings and the only consumer of the receive and completion
+   rings.  */
+typedef struct NX_LINUX_XSK_RING_STRUCT
+{
+    UCHAR          *nx_linux_xsk_ring_map;
+    size_t          nx_linux_xsk_ring_map_size;
+    UINT           *nx_linux_xsk_ring_producer;
+    UINT           *nx_linux_xsk_ring_consumer;
+    VOID           *nx_linux_xsk_ring_entries;
+} NX_LINUX_XSK_RING;
+#endif /* NX_LINUX_ENABLE_XSK */
+
+/* Define NX_LINUX_ENABLE_IO_URING to receive and transmit through an io_uring per
+   receive queue.  Each queue keeps one multishot receive armed on its socket, fed
+   from a provided buffer ring of NX_LINUX_IO_URING_BUFFER_COUNT packets of the
+   default pool, so frames are written straight into NetX packets and a wakeup
+   reaps every frame that arrived since the last one.  Unchained packets are sent
+   in place as send operations on the ring of queue 0, submitted in batches of
+   NX_LINUX_IO_URING_FLUSH_THRESHOLD or when the IP thread is done with the
+   current burst.  Their completions come back on the same ring, and the receive
+   thread of queue 0 releases the packets along with the frames it receives.
+   NetX threads are the only submitters: when the kernel ends a multishot receive,
+   for example because every posted packet is in use, the receive thread asks the
+   IP thread to arm it again.  A queue whose ring cannot be set up, for example on
+   a kernel older than Linux 6.0, stays on recvfrom() and sendto().  Chained
+   packets, and frames sent while NX_LINUX_IO_URING_ENTRIES sends are in flight,
+   are sent with sendto().  With NX_LINUX_ENABLE_CHECKSUM_OFFLOAD the driver
+   verifies every received frame, as the multishot receive carries no checksum
+   status, and frames whose checksums are left to the kernel go out on the
+   virtio-net socket.  NX_LINUX_IO_URING_BUFFER_COUNT must be a power of 2.  */
+#ifdef NX_LINUX_ENABLE_IO_URING
+#ifdef NX_LINUX_ENABLE_RX_RING
+#error "NX_LINUX_ENABLE_IO_URING cannot be used with NX_LINUX_ENABLE_RX_RING."
+#endif /* NX_LINUX_ENABLE_RX_RING */
+#ifdef NX_LINUX_ENABLE_XSK
+#error "NX_LINUX_ENABLE_IO_URING cannot be used with NX_LINUX_ENABLE_XSK."
+#endif /* NX_LINUX_ENABLE_XSK */
+#ifndef NX_LINUX_IO_URING_ENTRIES
+#define NX_LINUX_IO_URING_ENTRIES         64
+#endif
+#ifndef NX_LINUX_IO_URING_BUFFER_COUNT
+#define NX_LINUX_IO_URING_BUFFER_COUNT    8
+#endif
+#ifndef NX_LINUX_IO_URING_FLUSH_THRESHOLD
+#define NX_LINUX_IO_URING_FLUSH_THRESHOLD 16
+#endif
+#if NX_LINUX_IO_URING_BUFFER_COUNT > NX_LINUX_IO_URING_ENTRIES
+#error "NX_LINUX_IO_URING_BUFFER_COUNT cannot be larger than NX_LINUX_IO_URING_ENTRIES."
+#endif
+#if NX_LINUX_IO_URING_FLUSH_THRESHOLD > NX_LINUX_IO_URING_ENTRIES
+#error "NX_LINUX_IO_URING_FLUSH_THRESHOLD cannot be larger than NX_LINUX_IO_URING_ENTRIES."
+#endif
+
+#ifndef __NR_io_uring_setup
+#define __NR_io_uring_setup               425
+#endif
+#ifndef __NR_io_uring_enter
+#define __NR_io_uring_enter               426
+#endif
+#ifndef __NR_io_uring_register
+#define __NR_io_uring_register            427
+#endif
+
+/* Define an io_uring mapped by a receive queue.  NetX threads, with preemption
+   disabled, are the only producer of the submission queue, and the receive thread
+   of the queue is the only consumer of the completion queue.  */
+typedef struct NX_LINUX_IO_URING_STRUCT
+{
+    int             nx_linux_io_uring_fd;
+    UCHAR          *nx_linux_io_uring_sq_map;
+    size_t          nx_linux_io_uring_sq_map_size;
+    UCHAR          *nx_linux_io_uring_cq_map;
+    size_t          nx_linux_io_uring_cq_map_size;
+    struct io_uring_sqe
+                   *nx_linux_io_uring_sqes;
+    size_t          nx_linux_io_uring_sqes_size;
+    UINT           *nx_linux_io_uring_sq_head;
+    UINT           *nx_linux_io_uring_sq_tail;
+    UINT           *nx_linux_io_uring_sq_array;
+    UINT            nx_linux_io_uring_sq_entries;
+    UINT            nx_linux_io_uring_sq_next;
+    UINT           *nx_linux_io_uring_cq_head;
+    UINT           *nx_linux_io_uring_cq_tail;
+    struct io_uring_cqe
+                   *nx_linux_io_uring_cqes;
+    UINT            nx_linux_io_uring_cq_mask;
+} NX_LINUX_IO_URING;
+#endif /* NX_LINUX_ENABLE_IO_URING */
+
+/* Define NX_LINUX_ENABLE_BUSY_POLL to keep the receive threads awake after
+   traffic.  Once a receive thread has been woken with work to do, it waits for
+   the next event with non-blocking polls for up to NX_LINUX_BUSY_POLL_BUDGET
+   microseconds before it sleeps in the kernel again, so a frame arriving within
+   the budget does not wait for a scheduler wakeup.  An idle thread sleeps as
+   before.  A spinning thread keeps its CPU busy, so pin the receive threads with
+   NX_LINUX_RECEIVE_QUEUE_FIRST_CPU.  The receive sockets also get SO_BUSY_POLL
+   with the same budget, which lets each poll drive the device queue of a NAPI
+   driver when net.core.busy_poll is set; raising it needs CAP_NET_ADMIN and is
+   skipped without it.  nx_linux_receive_poll_time and nx_linux_receive_sleep_time
+   add up the nanoseconds the receive threads spent spinning and sleeping.  */
+#ifdef NX_LINUX_ENABLE_BUSY_POLL
+#ifndef NX_LINUX_BUSY_POLL_BUDGET
+#define NX_LINUX_BUSY_POLL_BUDGET         100
+#endif
+#endif /* NX_LINUX_ENABLE_BUSY_POLL */
+
+/* Define NX_LINUX_ENABLE_STATISTICS to count, per interface, the frames and
+   bytes received and sent, the received frames dropped by reason, the packet
+   allocation failures and the system calls made.  The counters are 64-bit and
+   updated with relaxed atomics, as the receive threads, the transmit thread and
+   the NetX threads all update them.  NX_LINK_GET_RX_COUNT, NX_LINK_GET_TX_COUNT,
+   NX_LINK_GET_ALLOC_ERRORS and NX_LINK_GET_ERROR_COUNT return them, truncated
+   to ULONG, through nx_ip_driver_direct_command() or
+   nx_ip_driver_interface_direct_command(), and nx_linux_statistics_dump()
+   prints every instance.  */
+#ifdef NX_LINUX_ENABLE_STATISTICS
+#define NX_LINUX_STATISTICS_ADD(instance_ptr, counter, value) \
+    __atomic_fetch_add(&(instance_ptr) -> nx_linux_instance_statistics.nx_linux_statistics_##counter, \
+                       (ULONG64)(value), __ATOMIC_RELAXED)
+
+typedef struct NX_LINUX_STATISTICS_STRUCT
+{
+    ULONG64         nx_linux_statistics_rx_frames;
+    ULONG64         nx_linux_statistics_rx_bytes;
+    ULONG64         nx_linux_statistics_rx_short_drops;
+    ULONG64         nx_linux_statistics_rx_truncated_drops;
+    ULONG64         nx_linux_statistics_rx_filter_drops;
+    ULONG64         nx_linux_statistics_rx_type_drops;
+    ULONG64         nx_linux_statistics_rx_checksum_drops;
+    ULONG64         nx_linux_statistics_rx_queue_full_drops;
+    ULONG64         nx_linux_statistics_allocation_errors;
+    ULONG64         nx_linux_statistics_rx_wakeups;
+    ULONG64         nx_linux_statistics_rx_syscalls;
+    ULONG64         nx_linux_statistics_tx_frames;
+    ULONG64         nx_linux_statistics_tx_bytes;
+    ULONG64         nx_linux_statistics_tx_errors;
+    ULONG64         nx_linux_statistics_tx_queue_full_drops;
+    ULONG64         nx_linux_statistics_tx_oversize_drops;
+    ULONG64         nx_linux_statistics_tx_syscalls;
+} NX_LINUX_STATISTICS;
+#else
+#define NX_LINUX_STATISTICS_ADD(instance_ptr, counter, value)
+#endif /* NX_LINUX_ENABLE_STATISTICS */
+
+/* Define NX_LINUX_ENABLE_CAPTURE to record the frames of every interface to
+   NX_LINUX_CAPTURE_FILE in pcapng format, with nanosecond timestamps.  Frames are
+   captured as NetX hands them to the driver and as the driver hands them to NetX,
+   so frames the driver drops are not recorded.  The first NX_LINUX_CAPTURE_SNAPLEN
+   bytes of each frame are copied into a ring of NX_LINUX_CAPTURE_RING_SIZE entries,
+   and a host thread writes them out, checking the ring every NX_LINUX_CAPTURE_WAIT
+   microseconds once it is empty.  Capturing never waits: a frame that finds the
+   ring full is counted in nx_linux_capture_drop_count and not recorded.
+   NX_LINUX_CAPTURE_RING_SIZE must be a power of 2.  */
+#ifdef NX_LINUX_ENABLE_CAPTURE
+#ifndef NX_LINUX_CAPTURE_FILE
+#define NX_LINUX_CAPTURE_FILE             "nx_linux_capture.pcapng"
+#endif
+
+#ifndef NX_LINUX_CAPTURE_SNAPLEN
+#define NX_LINUX_CAPTURE_SNAPLEN          128
+#endif
+
+#ifndef NX_LINUX_CAPTURE_RING_SIZE
+#define NX_LINUX_CAPTURE_RING_SIZE        1024
+#endif
+
+#ifndef NX_LINUX_CAPTURE_WAIT
+#define NX_LINUX_CAPTURE_WAIT             1000
+#endif
+
+#if (NX_LINUX_CAPTURE_RING_SIZE & (NX_LINUX_CAPTURE_RING_SIZE - 1)) != 0
+#error "NX_LINUX_CAPTURE_RING_SIZE must be a power of 2."
+#endif
+
+/* Define the direction of a captured frame, as pcapng epb_flags.  */
+#define NX_LINUX_CAPTURE_INBOUND          1
+#define NX_LINUX_CAPTURE_OUTBOUND         2
+
+/* Define a capture ring entry.  Producers claim entries by advancing the ring
+   head, and the sequence number tells who owns an entry: it equals the ring
+   position when the entry is free, and the position plus 1 once the frame has
+   been copied in and the writer thread may take it.  */
+typedef struct NX_LINUX_CAPTURE_ENTRY_STRUCT
+{
+    UINT            nx_linux_capture_entry_sequence;
+    UINT            nx_linux_capture_entry_interface;
+    UINT            nx_linux_capture_entry_flags;
+    UINT            nx_linux_capture_entry_length;
+    UINT            nx_linux_capture_entry_captured;
+    ULONG64         nx_linux_capture_entry_time;
+    UCHAR           nx_linux_capture_entry_data[NX_LINUX_CAPTURE_SNAPLEN];
+} NX_LINUX_CAPTURE_ENTRY;
+#endif /* NX_LINUX_ENABLE_CAPTURE */
+
+/* Define NX_LINUX_ENABLE_IMPAIRMENT to impair the frames of every interface like
+   a lossy, slow link, so TCP recovery can be load-tested without tc netem.  Each
+   direction selected in NX_LINUX_IMPAIRMENT_DIRECTIONS (1 for transmit, 2 for
+   receive) applies, in this order:
+
+     - loss: frames are dropped with probability NX_LINUX_IMPAIRMENT_LOSS, and in
+       bursts that start with probability NX_LINUX_IMPAIRMENT_BURST_START and end
+       with probability NX_LINUX_IMPAIRMENT_BURST_END per frame,
+     - duplication with probability NX_LINUX_IMPAIRMENT_DUPLICATE,
+     - rate limiting to NX_LINUX_IMPAIRMENT_RATE bits per second,
+     - a delay of NX_LINUX_IMPAIRMENT_DELAY microseconds, give or take up to
+       NX_LINUX_IMPAIRMENT_JITTER microseconds, which reorders frames when the
+       jitter is larger than the gap between them,
+     - reordering: frames are held back NX_LINUX_IMPAIRMENT_REORDER_DELAY more
+       microseconds with probability NX_LINUX_IMPAIRMENT_REORDER, so the frames
+       behind them overtake.
+
+   Probabilities are in parts per million.  Decisions come from a PRNG seeded with
+   NX_LINUX_IMPAIRMENT_SEED per interface and direction, so a run can be replayed.
+   Held frames wait on a timer wheel of NX_LINUX_IMPAIRMENT_WHEEL_SIZE slots of
+   NX_LINUX_IMPAIRMENT_TICK microseconds, at most NX_LINUX_IMPAIRMENT_LIMIT per
+   interface; beyond that they are dropped.  A host thread wakes the IP thread
+   when frames are due, and the IP thread sends or receives them.  Received frames
+   are impaired as NetX would get them, after coalescing, and the capture tap
+   records frames on the wire side of the impairment.  NX_LINUX_IMPAIRMENT_WHEEL_SIZE
+   must be a power of 2.  */
+#ifdef NX_LINUX_ENABLE_IMPAIRMENT
+#ifndef NX_LINUX_IMPAIRMENT_DIRECTIONS
+#define NX_LINUX_IMPAIRMENT_DIRECTIONS    3
+#endif
+
+#ifndef NX_LINUX_IMPAIRMENT_SEED
+#define NX_LINUX_IMPAIRMENT_SEED          1
+#endif
+
+#ifndef NX_LINUX_IMPAIRMENT_LOSS
+#define NX_LINUX_IMPAIRMENT_LOSS          0
+#endif
+
+#ifndef NX_LINUX_IMPAIRMENT_BURST_START
+#define NX_LINUX_IMPAIRMENT_BURST_START   0
+#endif
+
+#ifndef NX_LINUX_IMPAIRMENT_BURST_END
+#define NX_LINUX_IMPAIRMENT_BURST_END     250000
+#endif
+
+#ifndef NX_LINUX_IMPAIRMENT_DUPLICATE
+#define NX_LINUX_IMPAIRMENT_DUPLICATE     0
+#endif
+
+#ifndef NX_LINUX_IMPAIRMENT_RATE
+#define NX_LINUX_IMPAIRMENT_RATE          0
+#endif
+
+#ifndef NX_LINUX_IMPAIRMENT_DELAY
+#define NX_LINUX_IMPAIRMENT_DELAY         0
+#endif
+
+#ifndef NX_LINUX_IMPAIRMENT_JITTER
+#define NX_LINUX_IMPAIRMENT_JITTER        0
+#endif
+
+#ifndef NX_LINUX_IMPAIRMENT_REORDER
+#define NX_LINUX_IMPAIRMENT_REORDER       0
+#endif
+
+#ifndef NX_LINUX_IMPAIRMENT_REORDER_DELAY
+#define NX_LINUX_IMPAIRMENT_REORDER_DELAY 1000
+#endif
+
+#ifndef NX_LINUX_IMPAIRMENT_LIMIT
+#define NX_LINUX_IMPAIRMENT_LIMIT         1024
+#endif
+
+#ifndef NX_LINUX_IMPAIRMENT_TICK
+#define NX_LINUX_IMPAIRMENT_TICK          100
+#endif
+
+#ifndef NX_LINUX_IMPAIRMENT_WHEEL_SIZE
+#define NX_LINUX_IMPAIRMENT_WHEEL_SIZE    1024
+#endif
+
+#if (NX_LINUX_IMPAIRMENT_WHEEL_SIZE & (NX_LINUX_IMPAIRMENT_WHEEL_SIZE - 1)) != 0
+#error "NX_LINUX_IMPAIRMENT_WHEEL_SIZE must be a power of 2."
+#endif
+
+#if (NX_LINUX_IMPAIRMENT_JITTER > NX_LINUX_IMPAIRMENT_DELAY)
+#error "NX_LINUX_IMPAIRMENT_JITTER cannot be larger than NX_LINUX_IMPAIRMENT_DELAY."
+#endif
+
+/* Define the impaired directions.  */
+#define NX_LINUX_IMPAIRMENT_TRANSMIT      0
+#define NX_LINUX_IMPAIRMENT_RECEIVE       1
+
+/* Define a held frame.  The entries of a wheel slot are sorted by due time, and a
+   slot holds the frames due in later laps of the wheel behind those of this lap.  */
+typedef struct NX_LINUX_IMPAIRMENT_ENTRY_STRUCT
+{
+    struct NX_LINUX_IMPAIRMENT_ENTRY_STRUCT
+                   *nx_linux_impairment_entry_next;
+    NX_PACKET      *nx_linux_impairment_entry_packet;
+    ULONG64         nx_linux_impairment_entry_time;
+    UINT            nx_linux_impairment_entry_direction;
+} NX_LINUX_IMPAIRMENT_ENTRY;
+
+/* Define the state of one impaired direction.  */
+typedef struct NX_LINUX_IMPAIRMENT_STRUCT
+{
+    ULONG64         nx_linux_impairment_random;
+    UINT            nx_linux_impairment_burst;
+
+    /* Define when the rate-limited link finishes sending the frames before.  */
+    ULONG64         nx_linux_impairment_link_free;
+
+    ULONG           nx_linux_impairment_dropped;
+    ULONG           nx_linux_impairment_duplicated;
+    ULONG           nx_linux_impairment_delayed;
+    ULONG           nx_linux_impairment_overflows;
+} NX_LINUX_IMPAIRMENT;
+#endif /* NX_LINUX_ENABLE_IMPAIRMENT */
+
+/* Define the number of NetX interfaces the driver can run at the same time,
+   across every IP instance in the process.  */
+#ifndef NX_LINUX_INSTANCE_COUNT
+#define NX_LINUX_INSTANCE_COUNT           4
+#endif
+
+/* For the linux ethernet driver, physical addresses are allocated starting
+   at the preset value and then incremented before the next allocation.  */
+
+ULONG              nx_linux_address_msw =  0x0011;
+ULONG              nx_linux_address_lsw =  0x22334457;
+
+/* Define the receive queue.  Each queue owns an AF_PACKET socket and the host
+   thread that receives from it.  Queue 0 uses the socket of its instance.  */
+typedef struct NX_LINUX_RECEIVE_QUEUE_STRUCT
+{
+    struct NX_LINUX_INSTANCE_STRUCT
+                   *nx_linux_receive_queue_instance;
+    int             nx_linux_receive_queue_socket;
+    pthread_t       nx_linux_receive_queue_thread;
+#if NX_LINUX_RECEIVE_BATCH_SIZE > 1
+
+    /* Define the message headers and packets used by batched receive.  A slot
+       holds its packets until a frame is received into it, and has a packet
+       count of 0 when it is empty.  */
+    struct mmsghdr  nx_linux_receive_queue_messages[NX_LINUX_RECEIVE_BATCH_SIZE];
+    struct iovec    nx_linux_receive_queue_vectors[NX_LINUX_RECEIVE_BATCH_SIZE][NX_LINUX_RECEIVE_VECTOR_COUNT];
+    NX_PACKET      *nx_linux_receive_queue_packets[NX_LINUX_RECEIVE_BATCH_SIZE][NX_LINUX_RECEIVE_VECTOR_COUNT];
+    UINT            nx_linux_receive_queue_packet_count[NX_LINUX_RECEIVE_BATCH_SIZE];
+#ifdef NX_LINUX_ENABLE_CHECKSUM_OFFLOAD
+    NX_LINUX_AUXDATA_CONTROL nx_linux_receive_queue_control[NX_LINUX_RECEIVE_BATCH_SIZE];
+#endif /* NX_LINUX_ENABLE_CHECKSUM_OFFLOAD */
+#endif /* NX_LINUX_RECEIVE_BATCH_SIZE > 1 */
+#ifdef NX_LINUX_ENABLE_RX_RING
+
+    /* Define the mapped receive ring and the block the queue is waiting on.  */
+    UCHAR          *nx_linux_receive_queue_ring;
+    UINT            nx_linux_receive_queue_ring_block;
+#endif /* NX_LINUX_ENABLE_RX_RING */
+#ifdef NX_LINUX_ENABLE_DEFERRED_RECEIVE
+
+    /* Define the received packets waiting for the IP thread.  The receive thread
+       advances the head and the IP thread advances the tail.  */
+    NX_PACKET      *nx_linux_receive_queue_deferred_packets[NX_LINUX_DEFERRED_RING_SIZE];
+    UINT            nx_linux_receive_queue_head;
+    UINT            nx_linux_receive_queue_tail;
+#endif /* NX_LINUX_ENABLE_DEFERRED_RECEIVE */
+#ifdef NX_LINUX_ENABLE_GRO
+
+    /* Define the packet segments are merged into, and how many it holds.  */
+    NX_PACKET      *nx_linux_receive_queue_gro_packet;
+    UINT            nx_linux_receive_queue_gro_segments;
+#endif /* NX_LINUX_ENABLE_GRO */
+#ifdef NX_LINUX_ENABLE_XSK
+
+    /* Define the AF_XDP socket of the queue, or -1, and its rings.  Only queue 0
+       maps a transmit ring.  It counts the frames it has not kicked yet, and has
+       an event the sender raises when the first frame goes in flight, since the
+       receive thread only polls for completions while frames are in flight.  */
+    int             nx_linux_receive_queue_xsk_socket;
+    int             nx_linux_receive_queue_xsk_event;
+    NX_LINUX_XSK_RING nx_linux_receive_queue_xsk_rx;
+    NX_LINUX_XSK_RING nx_linux_receive_queue_xsk_fill;
+    NX_LINUX_XSK_RING nx_linux_receive_queue_xsk_tx;
+    NX_LINUX_XSK_RING nx_linux_receive_queue_xsk_completion;
+    UINT            nx_linux_receive_queue_xsk_tx_pending;
+#endif /* NX_LINUX_ENABLE_XSK */
+#ifdef NX_LINUX_ENABLE_IO_URING
+
+    /* Define the io_uring of the queue, and the buffer ring of its multishot receive
+       with the packets posted on it, indexed by buffer ID.  The IP thread sets the
+       armed flag when it submits the receive, and the receive thread clears it when
+       the kernel ends it.  Queue 0 counts the sends submitted and completed.  */
+    NX_LINUX_IO_URING nx_linux_receive_queue_io_uring;
+    struct io_uring_buf_ring
+                   *nx_linux_receive_queue_io_uring_buffers;
+    NX_PACKET      *nx_linux_receive_queue_io_uring_packets[NX_LINUX_IO_URING_BUFFER_COUNT];
+    UINT            nx_linux_receive_queue_io_uring_armed;
+    UINT            nx_linux_receive_queue_io_uring_sent;
+    UINT            nx_linux_receive_queue_io_uring_completed;
+#endif /* NX_LINUX_ENABLE_IO_URING */
+#ifdef NX_LINUX_ENABLE_BUSY_POLL
+
+    /* Define when the receive thread was last woken with work, in nanoseconds.  */
+    ULONG64         nx_linux_receive_queue_busy_poll_last;
+#endif /* NX_LINUX_ENABLE_BUSY_POLL */
+} NX_LINUX_RECEIVE_QUEUE;
+
+#if NX_LINUX_RECEIVE_BATCH_SIZE > 1
+/* Define the batch size distribution.  Entry N counts the wakeups that
+   received exactly N frames.  */
+ULONG              nx_linux_receive_batch_count[NX_LINUX_RECEIVE_BATCH_SIZE + 1];
+#endif /* NX_LINUX_RECEIVE_BATCH_SIZE > 1 */
+
+#ifdef NX_LINUX_ENABLE_GSO
+/* Define the identification of the IPv6 datagrams the driver fragments.  */
+ULONG              nx_linux_fragment_id;
+#endif /* NX_LINUX_ENABLE_GSO */
+
+#ifdef NX_LINUX_ENABLE_GRO
+/* Define the coalescing counters.  nx_linux_gro_merged_count counts the segments
+   chained behind another one, and nx_linux_gro_packet_count the packets handed to
+   NetX with more than one segment.  */
+ULONG              nx_linux_gro_merged_count;
+ULONG              nx_linux_gro_packet_count;
+#endif /* NX_LINUX_ENABLE_GRO */
+
+#ifdef NX_LINUX_ENABLE_BUSY_POLL
+/* Define the time, in nanoseconds, the receive threads have spent spinning for
+   work and sleeping in the kernel.  */
+ULONG64            nx_linux_receive_poll_time;
+ULONG64            nx_linux_receive_sleep_time;
+#endif /* NX_LINUX_ENABLE_BUSY_POLL */
+
+#ifdef NX_LINUX_ENABLE_CAPTURE
+/* Define the capture counters.  nx_linux_capture_count counts the frames written
+   to the capture file, and nx_linux_capture_drop_count the frames that found the
+   capture ring full.  */
+ULONG64            nx_linux_capture_count;
+ULONG64            nx_linux_capture_drop_count;
+
+static NX_LINUX_CAPTURE_ENTRY nx_linux_capture_ring[NX_LINUX_CAPTURE_RING_SIZE];
+static UINT                   nx_linux_capture_head;
+static pthread_once_t         nx_linux_capture_once = PTHREAD_ONCE_INIT;
+static pthread_t              nx_linux_capture_thread;
+#endif /* NX_LINUX_ENABLE_CAPTURE */
+
+#ifdef NX_LINUX_ENABLE_IMPAIRMENT
+/* Define the timer thread that wakes the IP threads when held frames are due,
+   and the event that wakes it when a frame is due before the ones it waits for.  */
+static pthread_once_t         nx_linux_impairment_once = PTHREAD_ONCE_INIT;
+static pthread_t              nx_linux_impairment_thread;
+static int                    nx_linux_impairment_event = -1;
+#endif /* NX_LINUX_ENABLE_IMPAIRMENT */
+
+/* Define the driver instance.  Each NetX interface driven by this driver gets
+   one, with its own Linux interface, sockets, receive threads and MAC address,
+   so several IP instances and multi-homed interfaces can share the process.  */
+typedef struct NX_LINUX_INSTANCE_STRUCT
+{
+    NX_INTERFACE   *nx_linux_instance_interface;
+    NX_IP          *nx_linux_instance_ip;
+    const CHAR     *nx_linux_instance_interface_name;
+    int             nx_linux_instance_interface_index;
+    int             nx_linux_instance_socket;
+    ULONG           nx_linux_instance_address_msw;
+    ULONG           nx_linux_instance_address_lsw;
+
+    NX_LINUX_RECEIVE_QUEUE nx_linux_instance_receive_queues[NX_LINUX_RECEIVE_QUEUE_COUNT];
+    UINT            nx_linux_instance_receive_queue_count;
+#if NX_LINUX_RECEIVE_QUEUE_COUNT > 1
+
+    /* Define the fanout group id the kernel assigned to the first queue.  */
+    int             nx_linux_instance_fanout_id;
+#endif /* NX_LINUX_RECEIVE_QUEUE_COUNT > 1 */
+
+    /* Define the multicast MAC table.  An entry holds the address as (msw << 32) | lsw,
+       or 0 when it is free, and the number of joins that use it.  Only the IP thread
+       changes the table; receive threads read the addresses.  */
+    ULONG64         nx_linux_instance_multicast_address[NX_LINUX_MULTICAST_TABLE_SIZE];
+    UINT            nx_linux_instance_multicast_count[NX_LINUX_MULTICAST_TABLE_SIZE];
+#ifdef NX_LINUX_ENABLE_DEFERRED_RECEIVE
+
+    /* Define the flag that tells whether the IP thread has been notified.  */
+    UINT            nx_linux_instance_deferred_receive_pending;
+#endif /* NX_LINUX_ENABLE_DEFERRED_RECEIVE */
+
+    /* Define the buffer to store data that will be used by linux socket. */
+    UCHAR           nx_linux_instance_transmit_buffer[NX_LINUX_TRANSMIT_BUFFER_SIZE];
+#ifdef NX_LINUX_ENABLE_TX_RING
+
+    /* Define the transmit ring.  It lives on its own socket, bound with protocol 0 so
+       the socket never queues received frames.  */
+    int             nx_linux_instance_tx_ring_socket;
+    UCHAR          *nx_linux_instance_tx_ring;
+    UINT            nx_linux_instance_tx_ring_index;
+    UINT            nx_linux_instance_tx_ring_pending;
+#endif /* NX_LINUX_ENABLE_TX_RING */
+#ifdef NX_LINUX_ENABLE_ASYNC_TRANSMIT
+
+    /* Define the transmit queue.  NetX threads produce with preemption disabled and
+       the transmit thread consumes, so head and tail each have a single writer.  */
+    pthread_t       nx_linux_instance_transmit_thread;
+    sem_t           nx_linux_instance_transmit_semaphore;
+    NX_PACKET      *nx_linux_instance_transmit_queue[NX_LINUX_TRANSMIT_QUEUE_SIZE];
+    UINT            nx_linux_instance_transmit_queue_head;
+    UINT            nx_linux_instance_transmit_queue_tail;
+#endif /* NX_LINUX_ENABLE_ASYNC_TRANSMIT */
+#ifdef NX_LINUX_ENABLE_CHECKSUM_OFFLOAD
+
+    /* Define the socket frames are sent on with a virtio-net header.  It is bound
+       with protocol 0 so the socket never queues received frames.  */
+    int             nx_linux_instance_vnet_socket;
+#endif /* NX_LINUX_ENABLE_CHECKSUM_OFFLOAD */
+#ifdef NX_LINUX_ENABLE_XSK
+
+    /* Define the UMEM.  It covers the whole pages around the packet pool.  The
+       chunk of a packet ends where the packet data ends, and the kernel writes
+       the frame frame_offset bytes into the chunk, 2 bytes into the packet data.  */
+    NX_PACKET_POOL *nx_linux_instance_xsk_pool;
+    UCHAR          *nx_linux_instance_xsk_umem;
+    ULONG           nx_linux_instance_xsk_umem_size;
+    ULONG           nx_linux_instance_xsk_packet_size;
+    ULONG           nx_linux_instance_xsk_chunk_size;
+    ULONG           nx_linux_instance_xsk_frame_offset;
+
+    /* Define the XSKMAP of the queue sockets and the link of the XDP program.  */
+    int             nx_linux_instance_xsk_map;
+    int             nx_linux_instance_xsk_link;
+#endif /* NX_LINUX_ENABLE_XSK */
+#ifdef NX_LINUX_ENABLE_STATISTICS
+
+    /* Define the interface counters.  */
+    NX_LINUX_STATISTICS nx_linux_instance_statistics;
+#endif /* NX_LINUX_ENABLE_STATISTICS */
+#ifdef NX_LINUX_ENABLE_IMPAIRMENT
+
+    /* Define the impairment state and the timer wheel of held frames.  NetX threads
+       and receive threads share them with interrupts disabled.  The wheel has been
+       processed up to tick nx_linux_instance_impairment_tick, and the timer thread
+       wakes the IP thread at nx_linux_instance_impairment_next.  */
+    NX_LINUX_IMPAIRMENT        nx_linux_instance_impairment[2];
+    NX_LINUX_IMPAIRMENT_ENTRY  nx_linux_instance_impairment_entries[NX_LINUX_IMPAIRMENT_LIMIT];
+    NX_LINUX_IMPAIRMENT_ENTRY *nx_linux_instance_impairment_free;
+    NX_LINUX_IMPAIRMENT_ENTRY *nx_linux_instance_impairment_wheel[NX_LINUX_IMPAIRMENT_WHEEL_SIZE];
+    UINT                       nx_linux_instance_impairment_count;
+    ULONG64                    nx_linux_instance_impairment_tick;
+    ULONG64                    nx_linux_instance_impairment_next;
+#endif /* NX_LINUX_ENABLE_IMPAIRMENT */
+} NX_LINUX_INSTANCE;
+
+/* Define the name of the Linux interface used by instances that are not
+   configured with nx_linux_interface_configure().  */
+static const CHAR       *nx_linux_interface_name = NX_LINUX_INTERFACE_NAME;
+
+static NX_LINUX_INSTANCE nx_linux_instances[NX_LINUX_INSTANCE_COUNT];
+static UINT              nx_linux_instance_count = 0;
+
+
+/* Define driver prototypes.  */
+
+VOID  nx_linux_set_interface_name(const CHAR *interface_name);
+UINT  nx_linux_interface_configure(NX_IP *ip_ptr, UINT interface_index, const CHAR *interface_name,
+                                   ULONG physical_msw, ULONG physical_lsw);
+VOID  nx_linux_statistics_dump(VOID);
+NX_LINUX_INSTANCE *_nx_linux_instance_get(NX_INTERFACE *interface_ptr);
+UINT  _nx_linux_initialize(NX_LINUX_INSTANCE *instance_ptr);
+UINT  _nx_linux_send_packet(NX_LINUX_INSTANCE *instance_ptr, NX_PACKET *packet_ptr);
+#ifdef NX_LINUX_ENABLE_TX_RING
+UINT  _nx_linux_tx_ring_create(NX_LINUX_INSTANCE *instance_ptr);
+UINT  _nx_linux_tx_ring_send(NX_LINUX_INSTANCE *instance_ptr, NX_PACKET *packet_ptr);
+VOID  _nx_linux_tx_ring_flush(NX_LINUX_INSTANCE *instance_ptr);
+#endif /* NX_LINUX_ENABLE_TX_RING */
+UINT  _nx_linux_receive_queue_create(NX_LINUX_INSTANCE *instance_ptr, NX_LINUX_RECEIVE_QUEUE *queue_ptr);
+void *_nx_linux_receive_thread_entry(void *arg);
+int   _nx_linux_receive_wait(NX_LINUX_RECEIVE_QUEUE *queue_ptr, struct pollfd *poll_fds, nfds_t fd_count, int timeout);
+#if defined(NX_LINUX_ENABLE_BUSY_POLL) || defined(NX_LINUX_ENABLE_IMPAIRMENT)
+ULONG64 _nx_linux_time_get(VOID);
+#endif /* NX_LINUX_ENABLE_BUSY_POLL || NX_LINUX_ENABLE_IMPAIRMENT */
+UINT  _nx_linux_receive_packets_allocate(NX_LINUX_INSTANCE *instance_ptr, NX_PACKET **packets, struct iovec *vectors);
+NX_PACKET *_nx_linux_receive_packets_build(NX_LINUX_INSTANCE *instance_ptr, NX_PACKET **packets, struct iovec *vectors,
+                                           UINT packet_count, int bytes_received, int flags);
+VOID  _nx_linux_receive_frame(NX_LINUX_RECEIVE_QUEUE *queue_ptr);
+#if NX_LINUX_RECEIVE_BATCH_SIZE > 1
+UINT  _nx_linux_receive_slots_fill(NX_LINUX_RECEIVE_QUEUE *queue_ptr, UINT slot_count);
+NX_PACKET *_nx_linux_receive_slot_build(NX_LINUX_RECEIVE_QUEUE *queue_ptr, UINT slot);
+VOID  _nx_linux_receive_batch(NX_LINUX_RECEIVE_QUEUE *queue_ptr);
+#endif /* NX_LINUX_RECEIVE_BATCH_SIZE > 1 */
+#ifdef NX_LINUX_ENABLE_RX_RING
+UINT  _nx_linux_rx_ring_create(NX_LINUX_RECEIVE_QUEUE *queue_ptr);
+VOID  _nx_linux_receive_ring_block(NX_LINUX_RECEIVE_QUEUE *queue_ptr, struct tpacket_block_desc *block_ptr);
+#endif /* NX_LINUX_ENABLE_RX_RING */
+#ifdef NX_LINUX_ENABLE_DEFERRED_RECEIVE
+VOID  _nx_linux_receive_deferred(NX_LINUX_RECEIVE_QUEUE *queue_ptr);
+VOID  _nx_linux_deferred_receive_process(NX_LINUX_INSTANCE *instance_ptr);
+#endif /* NX_LINUX_ENABLE_DEFERRED_RECEIVE */
+#ifdef NX_LINUX_ENABLE_CHECKSUM_OFFLOAD
+UINT  _nx_linux_vnet_socket_create(NX_LINUX_INSTANCE *instance_ptr);
+UINT  _nx_linux_vnet_header_build(NX_PACKET *packet_ptr, struct virtio_net_hdr *vnet_ptr);
+ULONG _nx_linux_checksum_add(UCHAR *data, ULONG length, ULONG sum);
+ULONG _nx_linux_checksum_packet(NX_PACKET *packet_ptr, ULONG offset, ULONG length, ULONG sum);
+UINT  _nx_linux_checksum_verify(NX_PACKET *packet_ptr);
+ULONG _nx_linux_receive_status_get(struct msghdr *message);
+VOID  _nx_linux_receive_status_set(NX_PACKET *packet_ptr, ULONG status);
+#endif /* NX_LINUX_ENABLE_CHECKSUM_OFFLOAD */
+#ifdef NX_LINUX_ENABLE_GSO
+VOID  _nx_linux_gso_mss_update(NX_PACKET *packet_ptr);
+UINT  _nx_linux_gso_fragment(NX_LINUX_INSTANCE *instance_ptr, NX_PACKET *packet_ptr);
+#endif /* NX_LINUX_ENABLE_GSO */
+#ifdef NX_LINUX_ENABLE_GRO
+UINT  _nx_linux_gro_header_get(NX_PACKET *packet_ptr, ULONG *header_length, ULONG *data_length);
+UINT  _nx_linux_gro_match(NX_PACKET *held_ptr, NX_PACKET *packet_ptr, ULONG header_length);
+VOID  _nx_linux_gro_receive(NX_LINUX_RECEIVE_QUEUE *queue_ptr, NX_PACKET *packet_ptr);
+VOID  _nx_linux_gro_flush(NX_LINUX_RECEIVE_QUEUE *queue_ptr);
+#endif /* NX_LINUX_ENABLE_GRO */
+UINT  _nx_linux_multicast_join(NX_LINUX_INSTANCE *instance_ptr, ULONG physical_msw, ULONG physical_lsw);
+UINT  _nx_linux_multicast_leave(NX_LINUX_INSTANCE *instance_ptr, ULONG physical_msw, ULONG physical_lsw);
+VOID  _nx_linux_multicast_membership(NX_LINUX_INSTANCE *instance_ptr, ULONG64 address, int option);
+UINT  _nx_linux_frame_check(NX_LINUX_INSTANCE *instance_ptr, UCHAR *frame_ptr, ULONG length);
+#ifdef NX_LINUX_ENABLE_MULTICAST_FILTER
+UINT  _nx_linux_destination_accept(NX_LINUX_INSTANCE *instance_ptr, UCHAR *frame_ptr);
+#endif /* NX_LINUX_ENABLE_MULTICAST_FILTER */
+#ifdef NX_LINUX_ENABLE_RECEIVE_FILTER
+UINT  _nx_linux_receive_filter_build(NX_LINUX_INSTANCE *instance_ptr, struct sock_filter *filter);
+VOID  _nx_linux_receive_filter_attach(NX_LINUX_INSTANCE *instance_ptr, int socket_fd);
+VOID  _nx_linux_receive_filter_update(NX_LINUX_INSTANCE *instance_ptr);
+#endif /* NX_LINUX_ENABLE_RECEIVE_FILTER */
+#ifdef NX_LINUX_ENABLE_XSK
+UINT  _nx_linux_xsk_create(NX_LINUX_INSTANCE *instance_ptr);
+UINT  _nx_linux_xsk_queue_create(NX_LINUX_RECEIVE_QUEUE *queue_ptr, UINT queue_index);
+VOID  _nx_linux_xsk_queue_close(NX_LINUX_RECEIVE_QUEUE *queue_ptr);
+UINT  _nx_linux_xsk_ring_map(int socket_fd, struct xdp_ring_offset *offset, off64_t page_offset, size_t entry_size,
+                             NX_LINUX_XSK_RING *ring_ptr);
+UINT  _nx_linux_xsk_program_attach(NX_LINUX_INSTANCE *instance_ptr);
+NX_PACKET *_nx_linux_xsk_packet_get(NX_LINUX_INSTANCE *instance_ptr, UCHAR *data);
+int   _nx_linux_xsk_process(NX_LINUX_RECEIVE_QUEUE *queue_ptr);
+VOID  _nx_linux_xsk_receive(NX_LINUX_RECEIVE_QUEUE *queue_ptr);
+VOID  _nx_linux_xsk_fill(NX_LINUX_RECEIVE_QUEUE *queue_ptr);
+VOID  _nx_linux_xsk_complete(NX_LINUX_RECEIVE_QUEUE *queue_ptr);
+UINT  _nx_linux_xsk_send(NX_LINUX_INSTANCE *instance_ptr, NX_PACKET *packet_ptr);
+VOID  _nx_linux_xsk_flush(NX_LINUX_INSTANCE *instance_ptr);
+#endif /* NX_LINUX_ENABLE_XSK */
+#ifdef NX_LINUX_ENABLE_IO_URING
+UINT  _nx_linux_io_uring_create(NX_LINUX_RECEIVE_QUEUE *queue_ptr);
+VOID  _nx_linux_io_uring_close(NX_LINUX_RECEIVE_QUEUE *queue_ptr);
+struct io_uring_sqe *_nx_linux_io_uring_sqe_get(NX_LINUX_IO_URING *ring_ptr);
+int   _nx_linux_io_uring_submit(NX_LINUX_IO_URING *ring_ptr, UINT wait_count);
+VOID  _nx_linux_io_uring_receive_arm(NX_LINUX_RECEIVE_QUEUE *queue_ptr);
+int   _nx_linux_io_uring_process(NX_LINUX_RECEIVE_QUEUE *queue_ptr);
+VOID  _nx_linux_io_uring_receive(NX_LINUX_RECEIVE_QUEUE *queue_ptr, struct io_uring_cqe *cqe_ptr);
+VOID  _nx_linux_io_uring_fill(NX_LINUX_RECEIVE_QUEUE *queue_ptr);
+UINT  _nx_linux_io_uring_send(NX_LINUX_INSTANCE *instance_ptr, NX_PACKET *packet_ptr);
+VOID  _nx_linux_io_uring_flush(NX_LINUX_INSTANCE *instance_ptr);
+#endif /* NX_LINUX_ENABLE_IO_URING */
+#ifdef NX_LINUX_ENABLE_CAPTURE
+VOID  _nx_linux_capture_start(VOID);
+VOID  _nx_linux_capture(NX_LINUX_INSTANCE *instance_ptr, NX_PACKET *packet_ptr, UINT flags);
+VOID  _nx_linux_capture_block_write(FILE *file, UINT type, UCHAR *body, UINT length);
+VOID  _nx_linux_capture_interface_write(FILE *file, NX_LINUX_INSTANCE *instance_ptr);
+void *_nx_linux_capture_thread_entry(void *arg);
+#endif /* NX_LINUX_ENABLE_CAPTURE */
+#ifdef NX_LINUX_ENABLE_IMPAIRMENT
+VOID  _nx_linux_impairment_initialize(NX_LINUX_INSTANCE *instance_ptr);
+VOID  _nx_linux_impairment_start(VOID);
+ULONG64 _nx_linux_impairment_random(NX_LINUX_IMPAIRMENT *impairment_ptr);
+UINT  _nx_linux_impairment_chance(NX_LINUX_IMPAIRMENT *impairment_ptr, ULONG probability);
+UINT  _nx_linux_impairment_apply(NX_LINUX_INSTANCE *instance_ptr, NX_PACKET *packet_ptr, UINT direction);
+VOID  _nx_linux_impairment_hold(NX_LINUX_INSTANCE *instance_ptr, NX_PACKET *packet_ptr, UINT direction, ULONG64 time);
+VOID  _nx_linux_impairment_release(NX_PACKET *packet_ptr, UINT direction);
+VOID  _nx_linux_impairment_process(NX_LINUX_INSTANCE *instance_ptr);
+void *_nx_linux_impairment_thread_entry(void *arg);
+#endif /* NX_LINUX_ENABLE_IMPAIRMENT */
+VOID  _nx_linux_packet_receive(NX_LINUX_INSTANCE *instance_ptr, NX_PACKET *packet_ptr);
+VOID  _nx_linux_packet_dispatch(NX_LINUX_INSTANCE *instance_ptr, NX_PACKET *packet_ptr);
+#ifdef NX_LINUX_ENABLE_ASYNC_TRANSMIT
+void *_nx_linux_transmit_thread_entry(void *arg);
+#endif /* NX_LINUX_ENABLE_ASYNC_TRANSMIT */
+VOID  _nx_linux_network_driver_output(NX_LINUX_INSTANCE *instance_ptr, NX_PACKET *packet_ptr);
+VOID  _nx_linux_network_driver(NX_IP_DRIVER *driver_req_ptr);
+
+/* Define interface capability.  */
+
+#ifdef NX_ENABLE_INTERFACE_CAPABILITY
+#define NX_INTERFACE_RX_CAPABILITY (NX_INTERFACE_CAPABILITY_IPV4_RX_CHECKSUM |   \
+                                    NX_INTERFACE_CAPABILITY_TCP_RX_CHECKSUM |    \
+                                    NX_INTERFACE_CAPABILITY_UDP_RX_CHECKSUM |    \
+                                    NX_INTERFACE_CAPABILITY_ICMPV4_RX_CHECKSUM | \
+                                    NX_INTERFACE_CAPABILITY_ICMPV6_RX_CHECKSUM)
+#ifdef NX_LINUX_ENABLE_CHECKSUM_OFFLOAD
+#define NX_INTERFACE_TX_CAPABILITY (NX_INTERFACE_CAPABILITY_TCP_TX_CHECKSUM | \
+                                    NX_INTERFACE_CAPABILITY_UDP_TX_CHECKSUM)
+#else
+#define NX_INTERFACE_TX_CAPABILITY 0
+#endif /* NX_LINUX_ENABLE_CHECKSUM_OFFLOAD */
+#define NX_INTERFACE_CAPABILITY    (NX_INTERFACE_RX_CAPABILITY | NX_INTERFACE_TX_CAPABILITY)
+#endif /* NX_ENABLE_INTERFACE_CAPABILITY */
+
+VOID nx_linux_set_interface_name(const CHAR *interface_name)
+{
+    nx_linux_interface_name = interface_name;
+}
+
+UINT nx_linux_interface_configure(NX_IP *ip_ptr, UINT interface_index, const CHAR *interface_name,
+                                  ULONG physical_msw, ULONG physical_lsw)
+{
+NX_LINUX_INSTANCE *instance_ptr;
+
+    if (interface_index >= NX_MAX_PHYSICAL_INTERFACES)
+    {
+        return(NX_INVALID_INTERFACE);
+    }
+
+    /* The instance is keyed by the interface, so it can be set up before the
+       IP thread initializes the link.  */
+    instance_ptr = _nx_linux_instance_get(&(ip_ptr -> nx_ip_interface[interface_index]));
+    if (instance_ptr == NX_NULL)
+    {
+        return(NX_NO_MORE_ENTRIES);
+    }
+
+    if (instance_ptr -> nx_linux_instance_socket >= 0)
+    {
+        return(NX_ALREADY_ENABLED);
+    }
+
+    instance_ptr -> nx_linux_instance_interface_name = interface_name;
+    instance_ptr -> nx_linux_instance_address_msw = physical_msw;
+    instance_ptr -> nx_linux_instance_address_lsw = physical_lsw;
+
+    return(NX_SUCCESS);
+}
+
+VOID nx_linux_statistics_dump(VOID)
+{
+#ifdef NX_LINUX_ENABLE_STATISTICS
+NX_LINUX_STATISTICS *statistics_ptr;
+#endif /* NX_LINUX_ENABLE_STATISTICS */
+#ifdef NX_LINUX_ENABLE_IMPAIRMENT
+NX_LINUX_IMPAIRMENT *impairment_ptr;
+UINT                 direction;
+#endif /* NX_LINUX_ENABLE_IMPAIRMENT */
+UINT                 i;
+
+    for (i = 0; i < nx_linux_instance_count; i++)
+    {
+        printf("%s:\n", nx_linux_instances[i].nx_linux_instance_interface_name);
+#ifdef NX_LINUX_ENABLE_STATISTICS
+        statistics_ptr = &nx_linux_instances[i].nx_linux_instance_statistics;
+        printf("  rx frames %llu bytes %llu wakeups %llu syscalls %llu\n",
+               (unsigned long long)statistics_ptr -> nx_linux_statistics_rx_frames,
+               (unsigned long long)statistics_ptr -> nx_linux_statistics_rx_bytes,
+               (unsigned long long)statistics_ptr -> nx_linux_statistics_rx_wakeups,
+               (unsigned long long)statistics_ptr -> nx_linux_statistics_rx_syscalls);
+        printf("  rx drops short %llu truncated %llu filter %llu type %llu checksum %llu queue full %llu\n",
+               (unsigned long long)statistics_ptr -> nx_linux_statistics_rx_short_drops,
+               (unsigned long long)statistics_ptr -> nx_linux_statistics_rx_truncated_drops,
+               (unsigned long long)statistics_ptr -> nx_linux_statistics_rx_filter_drops,
+               (unsigned long long)statistics_ptr -> nx_linux_statistics_rx_type_drops,
+               (unsigned long long)statistics_ptr -> nx_linux_statistics_rx_checksum_drops,
+               (unsigned long long)statistics_ptr -> nx_linux_statistics_rx_queue_full_drops);
+        printf("  tx frames %llu bytes %llu syscalls %llu errors %llu queue full %llu oversize %llu\n",
+               (unsigned long long)statistics_ptr -> nx_linux_statistics_tx_frames,
+               (unsigned long long)statistics_ptr -> nx_linux_statistics_tx_bytes,
+               (unsigned long long)statistics_ptr -> nx_linux_statistics_tx_syscalls,
+               (unsigned long long)statistics_ptr -> nx_linux_statistics_tx_errors,
+               (unsigned long long)statistics_ptr -> nx_linux_statistics_tx_queue_full_drops,
+               (unsigned long long)statistics_ptr -> nx_linux_statistics_tx_oversize_drops);
+        printf("  allocation errors %llu\n",
+               (unsigned long long)statistics_ptr -> nx_linux_statistics_allocation_errors);
+#endif /* NX_LINUX_ENABLE_STATISTICS */
+#ifdef NX_LINUX_ENABLE_IMPAIRMENT
+        for (direction = 0; direction < 2; direction++)
+        {
+            impairment_ptr = &nx_linux_instances[i].nx_linux_instance_impairment[direction];
+            printf("  %s impairment dropped %lu duplicated %lu delayed %lu overflows %lu\n",
+                   (direction == NX_LINUX_IMPAIRMENT_TRANSMIT) ? "tx" : "rx",
+                   (unsigned long)impairment_ptr -> nx_linux_impairment_dropped,
+                   (unsigned long)impairment_ptr -> nx_linux_impairment_duplicated,
+                   (unsigned long)impairment_ptr -> nx_linux_impairment_delayed,
+                   (unsigned long)impairment_ptr -> nx_linux_impairment_overflows);
+        }
+#endif /* NX_LINUX_ENABLE_IMPAIRMENT */
+    }
+
+#if NX_LINUX_RECEIVE_BATCH_SIZE > 1
+    /* The batch sizes are counted across every instance.  */
+    printf("receive batch sizes:");
+    for (i = 0; i <= NX_LINUX_RECEIVE_BATCH_SIZE; i++)
+    {
+        printf(" %lu", (unsigned long)nx_linux_receive_batch_count[i]);
+    }
+    printf("\n");
+#endif /* NX_LINUX_RECEIVE_BATCH_SIZE > 1 */
+#ifdef NX_LINUX_ENABLE_GRO
+    printf("gro merged %lu packets %lu\n",
+           (unsigned long)nx_linux_gro_merged_count, (unsigned long)nx_linux_gro_packet_count);
+#endif /* NX_LINUX_ENABLE_GRO */
+#ifdef NX_LINUX_ENABLE_BUSY_POLL
+    printf("receive poll time %llu ns sleep time %llu ns\n",
+           (unsigned long long)nx_linux_receive_poll_time, (unsigned long long)nx_linux_receive_sleep_time);
+#endif /* NX_LINUX_ENABLE_BUSY_POLL */
+#ifdef NX_LINUX_ENABLE_CAPTURE
+    printf("capture frames %llu drops %llu\n",
+           (unsigned long long)nx_linux_capture_count, (unsigned long long)nx_linux_capture_drop_count);
+#endif /* NX_LINUX_ENABLE_CAPTURE */
+}
+
+NX_LINUX_INSTANCE *_nx_linux_instance_get(NX_INTERFACE *interface_ptr)
+{
+NX_LINUX_INSTANCE *instance_ptr;
+UINT               i;
+
+    for (i = 0; i < nx_linux_instance_count; i++)
+    {
+        if (nx_linux_instances[i].nx_linux_instance_interface == interface_ptr)
+        {
+            return(&nx_linux_instances[i]);
+        }
+    }
+
+    if (nx_linux_instance_count == NX_LINUX_INSTANCE_COUNT)
+    {
+        return(NX_NULL);
+    }
+
+    /* Bind a new instance to the default Linux interface, with the next physical address.  */
+    instance_ptr = &nx_linux_instances[nx_linux_instance_count];
+    memset(instance_ptr, 0, sizeof(NX_LINUX_INSTANCE));
+    instance_ptr -> nx_linux_instance_interface = interface_ptr;
+    instance_ptr -> nx_linux_instance_interface_name = nx_linux_interface_name;
+    instance_ptr -> nx_linux_instance_address_msw = nx_linux_address_msw;
+    instance_ptr -> nx_linux_instance_address_lsw = nx_linux_address_lsw + nx_linux_instance_count;
+    instance_ptr -> nx_linux_instance_socket = -1;
+#ifdef NX_LINUX_ENABLE_TX_RING
+    instance_ptr -> nx_linux_instance_tx_ring_socket = -1;
+#endif /* NX_LINUX_ENABLE_TX_RING */
+#ifdef NX_LINUX_ENABLE_CHECKSUM_OFFLOAD
+    instance_ptr -> nx_linux_instance_vnet_socket = -1;
+#endif /* NX_LINUX_ENABLE_CHECKSUM_OFFLOAD */
+#ifdef NX_LINUX_ENABLE_XSK
+    instance_ptr -> nx_linux_instance_xsk_map = -1;
+    instance_ptr -> nx_linux_instance_xsk_link = -1;
+#endif /* NX_LINUX_ENABLE_XSK */
+#ifdef NX_LINUX_ENABLE_IMPAIRMENT
+    instance_ptr -> nx_linux_instance_impairment_next = ~(ULONG64)0;
+#endif /* NX_LINUX_ENABLE_IMPAIRMENT */
+    nx_linux_instance_count++;
+
+    return(instance_ptr);
+}
+
+#ifdef NX_LINUX_ENABLE_TX_RING
+UINT _nx_linux_tx_ring_create(NX_LINUX_INSTANCE *instance_ptr)
+{
+int                version = TPACKET_V2;
+int                discard = 1;
+#ifdef NX_LINUX_ENABLE_CHECKSUM_OFFLOAD
+int                enable = 1;
+#endif /* NX_LINUX_ENABLE_CHECKSUM_OFFLOAD */
+struct tpacket_req req;
+struct sockaddr_ll sa;
+VOID              *ring;
+
+    instance_ptr -> nx_linux_instance_tx_ring_socket = socket(AF_PACKET, SOCK_RAW, 0);
+    if (instance_ptr -> nx_linux_instance_tx_ring_socket < 0)
+    {
+        return(NX_NOT_CREATED);
+    }
+
+    /* Discard malformed frames instead of stalling the ring.  */
+    setsockopt(instance_ptr -> nx_linux_instance_tx_ring_socket, SOL_PACKET, PACKET_LOSS, &discard, sizeof(discard));
+
+    memset(&req, 0, sizeof(req));
+    req.tp_block_size = NX_LINUX_TX_RING_BLOCK_SIZE;
+    req.tp_block_nr = NX_LINUX_TX_RING_BLOCK_COUNT;
+    req.tp_frame_size = NX_LINUX_TX_RING_FRAME_SIZE;
+    req.tp_frame_nr = NX_LINUX_TX_RING_FRAME_COUNT;
+    if ((setsockopt(instance_ptr -> nx_linux_instance_tx_ring_socket, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) < 0) ||
+#ifdef NX_LINUX_ENABLE_CHECKSUM_OFFLOAD
+        (setsockopt(instance_ptr -> nx_linux_instance_tx_ring_socket, SOL_PACKET, PACKET_VNET_HDR, &enable, sizeof(enable)) < 0) ||
+#endif /* NX_LINUX_ENABLE_CHECKSUM_OFFLOAD */
+        (setsockopt(instance_ptr -> nx_linux_instance_tx_ring_socket, SOL_PACKET, PACKET_TX_RING, &req, sizeof(req)) < 0))
+    {
+        close(instance_ptr -> nx_linux_instance_tx_ring_socket);
+        instance_ptr -> nx_linux_instance_tx_ring_socket = -1;
+        return(NX_NOT_SUCCESSFUL);
+    }
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sll_family = AF_PACKET;
+    sa.sll_protocol = 0;
+    sa.sll_ifindex = instance_ptr -> nx_linux_instance_interface_index;
+    if (bind(instance_ptr -> nx_linux_instance_tx_ring_socket, (struct sockaddr *)&sa, sizeof(sa)) < 0)
+    {
+        close(instance_ptr -> nx_linux_instance_tx_ring_socket);
+        instance_ptr -> nx_linux_instance_tx_ring_socket = -1;
+        return(NX_NOT_BOUND);
+    }
+
+    ring = mmap(NX_NULL, (size_t)NX_LINUX_TX_RING_BLOCK_SIZE * NX_LINUX_TX_RING_BLOCK_COUNT,
+                PROT_READ | PROT_WRITE, MAP_SHARED, instance_ptr -> nx_linux_instance_tx_ring_socket, 0);
+    if (ring == MAP_FAILED)
+    {
+        close(instance_ptr -> nx_linux_instance_tx_ring_socket);
+        instance_ptr -> nx_linux_instance_tx_ring_socket = -1;
+        return(NX_NOT_SUCCESSFUL);
+    }
+
+    instance_ptr -> nx_linux_instance_tx_ring = (UCHAR *)ring;
+    instance_ptr -> nx_linux_instance_tx_ring_index = 0;
+    instance_ptr -> nx_linux_instance_tx_ring_pending = 0;
+
+    return(NX_SUCCESS);
+}
+
+VOID _nx_linux_tx_ring_flush(NX_LINUX_INSTANCE *instance_ptr)
+{
+
+    /* Kick the kernel to transmit every frame marked with TP_STATUS_SEND_REQUEST.  */
+    if (instance_ptr -> nx_linux_instance_tx_ring_pending)
+    {
+        send(instance_ptr -> nx_linux_instance_tx_ring_socket, NX_NULL, 0, MSG_DONTWAIT);
+        instance_ptr -> nx_linux_instance_tx_ring_pending = 0;
+        NX_LINUX_STATISTICS_ADD(instance_ptr, tx_syscalls, 1);
+    }
+}
+
+UINT _nx_linux_tx_ring_send(NX_LINUX_INSTANCE *instance_ptr, NX_PACKET *packet_ptr)
+{
+struct tpacket2_hdr *frame_ptr;
+struct pollfd        poll_fd;
+UCHAR               *data;
+ULONG                size = 0;
+
+    frame_ptr = (struct tpacket2_hdr *)(instance_ptr -> nx_linux_instance_tx_ring +
+                                        (size_t)instance_ptr -> nx_linux_instance_tx_ring_index * NX_LINUX_TX_RING_FRAME_SIZE);
+
+    if (frame_ptr -> tp_status != TP_STATUS_AVAILABLE)
+    {
+
+        /* The ring is full. Push out what is pending and wait for the kernel to free a slot.  */
+        _nx_linux_tx_ring_flush(instance_ptr);
+
+        poll_fd.fd = instance_ptr -> nx_linux_instance_tx_ring_socket;
+        poll_fd.events = POLLOUT;
+        poll_fd.revents = 0;
+        poll(&poll_fd, 1, NX_LINUX_TX_RING_WAIT);
+
+        if (frame_ptr -> tp_status != TP_STATUS_AVAILABLE)
+        {
+            NX_LINUX_STATISTICS_ADD(instance_ptr, tx_queue_full_drops, 1);
+            return NX_NOT_SUCCESSFUL;
+        }
+    }
+    __sync_synchronize();
+
+    /* Copy the frame into the slot, linearizing chained packets in place.  */
+    data = (UCHAR *)frame_ptr + NX_LINUX_TX_RING_DATA_OFFSET;
+#ifdef NX_LINUX_ENABLE_CHECKSUM_OFFLOAD
+    /* The virtio-net header goes in front of the frame.  */
+    if (_nx_linux_vnet_header_build(packet_ptr, (struct virtio_net_hdr *)data))
+    {
+        NX_LINUX_STATISTICS_ADD(instance_ptr, tx_errors, 1);
+        return NX_NOT_SUCCESSFUL;
+    }
+    data += sizeof(struct virtio_net_hdr);
+#endif /* NX_LINUX_ENABLE_CHECKSUM_OFFLOAD */
+#ifndef NX_DISABLE_PACKET_CHAIN
+    if (packet_ptr -> nx_packet_next)
+    {
+        if (nx_packet_data_retrieve(packet_ptr, data, &size))
+        {
+            NX_LINUX_STATISTICS_ADD(instance_ptr, tx_errors, 1);
+            return NX_NOT_SUCCESSFUL;
+        }
+    }
+    else
+#endif /* NX_DISABLE_PACKET_CHAIN */
+    {
+        size = packet_ptr -> nx_packet_length;
+        memcpy(data, packet_ptr -> nx_packet_prepend_ptr, size);
+    }
+    NX_LINUX_STATISTICS_ADD(instance_ptr, tx_frames, 1);
+    NX_LINUX_STATISTICS_ADD(instance_ptr, tx_bytes, size);
+
+    /* Hand the slot to the kernel.  */
+#ifdef NX_LINUX_ENABLE_CHECKSUM_OFFLOAD
+    size += sizeof(struct virtio_net_hdr);
+#endif /* NX_LINUX_ENABLE_CHECKSUM_OFFLOAD */
+    frame_ptr -> tp_len = size;
+    __sync_synchronize();
+    frame_ptr -> tp_status = TP_STATUS_SEND_REQUEST;
+
+    instance_ptr -> nx_linux_instance_tx_ring_index =
+        (instance_ptr -> nx_linux_instance_tx_ring_index + 1) % NX_LINUX_TX_RING_FRAME_COUNT;
+    instance_ptr -> nx_linux_instance_tx_ring_pending++;
+
+    if (instance_ptr -> nx_linux_instance_tx_ring_pending >= NX_LINUX_TX_RING_FLUSH_THRESHOLD)
+    {
+        _nx_linux_tx_ring_flush(instance_ptr);
+    }
+#ifndef NX_LINUX_ENABLE_ASYNC_TRANSMIT
+    else if (instance_ptr -> nx_linux_instance_tx_ring_pending == 1)
+    {
+
+        /* Ask the IP thread to flush the ring once it is done with the current burst.  */
+        _nx_ip_driver_deferred_processing(instance_ptr -> nx_linux_instance_ip);
+    }
+#endif /* NX_LINUX_ENABLE_ASYNC_TRANSMIT */
+
+    return NX_SUCCESS;
+}
+#endif /* NX_LINUX_ENABLE_TX_RING */
+
+#ifdef NX_LINUX_ENABLE_CHECKSUM_OFFLOAD
+UINT _nx_linux_vnet_socket_create(NX_LINUX_INSTANCE *instance_ptr)
+{
+int                enable = 1;
+struct sockaddr_ll sa;
+
+    instance_ptr -> nx_linux_instance_vnet_socket = socket(AF_PACKET, SOCK_RAW, 0);
+    if (instance_ptr -> nx_linux_instance_vnet_socket < 0)
+    {
+        return(NX_NOT_CREATED);
+    }
+
+    if (setsockopt(instance_ptr -> nx_linux_instance_vnet_socket, SOL_PACKET, PACKET_VNET_HDR, &enable, sizeof(enable)) < 0)
+    {
+        close(instance_ptr -> nx_linux_instance_vnet_socket);
+        instance_ptr -> nx_linux_instance_vnet_socket = -1;
+        return(NX_NOT_SUCCESSFUL);
+    }
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sll_family = AF_PACKET;
+    sa.sll_protocol = 0;
+    sa.sll_ifindex = instance_ptr -> nx_linux_instance_interface_index;
+    if (bind(instance_ptr -> nx_linux_instance_vnet_socket, (struct sockaddr *)&sa, sizeof(sa)) < 0)
+    {
+        close(instance_ptr -> nx_linux_instance_vnet_socket);
+        instance_ptr -> nx_linux_instance_vnet_socket = -1;
+        return(NX_NOT_BOUND);
+    }
+
+    return(NX_SUCCESS);
+}
+
+UINT _nx_linux_vnet_header_build(NX_PACKET *packet_ptr, struct virtio_net_hdr *vnet_ptr)
+{
+UCHAR *ip_ptr;
+UCHAR *checksum_ptr;
+ULONG  ip_header_length;
+ULONG  data_length;
+ULONG  sum;
+UINT   packet_type;
+UINT   protocol;
+UINT   segment = NX_FALSE;
+
+    memset(vnet_ptr, 0, sizeof(struct virtio_net_hdr));
+
+#ifdef NX_LINUX_ENABLE_GSO
+    /* Frames larger than the link are TCP segments for the kernel to split.  */
+    segment = (packet_ptr -> nx_packet_length > NX_LINK_MTU);
+#endif /* NX_LINUX_ENABLE_GSO */
+
+    /* Nothing to do unless NetX left a TCP or UDP checksum to the driver.  */
+    if (((packet_ptr -> nx_packet_interface_capability_flag & NX_INTERFACE_TX_CAPABILITY) == 0) && !segment)
+    {
+        return(NX_SUCCESS);
+    }
+
+    /* NetX builds the Ethernet, IP and transport headers in the first packet.  */
+    packet_type = ((UINT)packet_ptr -> nx_packet_prepend_ptr[12] << 8) | packet_ptr -> nx_packet_prepend_ptr[13];
+    ip_ptr = packet_ptr -> nx_packet_prepend_ptr + NX_ETHERNET_SIZE;
+    if (packet_type == NX_ETHERNET_IP)
+    {
+        ip_header_length = (ULONG)(ip_ptr[0] & 0x0F) * 4;
+        data_length = (((ULONG)ip_ptr[2] << 8) | ip_ptr[3]) - ip_header_length;
+        protocol = ip_ptr[9];
+        sum = _nx_linux_checksum_add(ip_ptr + 12, 8, 0);
+    }
+    else if (packet_type == NX_ETHERNET_IPV6)
+    {
+        ip_header_length = 40;
+        data_length = ((ULONG)ip_ptr[4] << 8) | ip_ptr[5];
+        protocol = ip_ptr[6];
+        sum = _nx_linux_checksum_add(ip_ptr + 8, 32, 0);
+    }
+    else
+    {
+        return(segment ? NX_NOT_SUCCESSFUL : NX_SUCCESS);
+    }
+
+    if (protocol == IPPROTO_TCP)
+    {
+        vnet_ptr -> csum_offset = 16;
+    }
+    else if ((protocol == IPPROTO_UDP) && !segment)
+    {
+        vnet_ptr -> csum_offset = 6;
+    }
+    else
+    {
+        return(segment ? NX_NOT_SUCCESSFUL : NX_SUCCESS);
+    }
+
+    /* Seed the checksum field with the pseudo header sum. The kernel adds the
+       transport header and payload and stores the complement.  */
+    sum += protocol + data_length;
+    sum = (sum & 0xFFFF) + (sum >> 16);
+    sum = (sum & 0xFFFF) + (sum >> 16);
+    checksum_ptr = ip_ptr + ip_header_length + vnet_ptr -> csum_offset;
+    checksum_ptr[0] = (UCHAR)(sum >> 8);
+    checksum_ptr[1] = (UCHAR)sum;
+
+    vnet_ptr -> flags = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+    vnet_ptr -> csum_start = (USHORT)(NX_ETHERNET_SIZE + ip_header_length);
+
+#ifdef NX_LINUX_ENABLE_GSO
+    if (segment)
+    {
+
+        /* Cut the payload into segments that fill a link frame.  */
+        vnet_ptr -> hdr_len = (USHORT)(NX_ETHERNET_SIZE + ip_header_length + (ULONG)(ip_ptr[ip_header_length + 12] >> 4) * 4);
+        vnet_ptr -> gso_size = (USHORT)(NX_LINK_MTU - vnet_ptr -> hdr_len);
+        vnet_ptr -> gso_type = (packet_type == NX_ETHERNET_IP) ? VIRTIO_NET_HDR_GSO_TCPV4 : VIRTIO_NET_HDR_GSO_TCPV6;
+    }
+#endif /* NX_LINUX_ENABLE_GSO */
+
+    return(NX_SUCCESS);
+}
+
+ULONG _nx_linux_checksum_add(UCHAR *data, ULONG length, ULONG sum)
+{
+
+    /* Add big endian 16-bit words. An odd trailing byte is the high byte of the last word.  */
+    while (length > 1)
+    {
+        sum += ((ULONG)data[0] << 8) | data[1];
+        data += 2;
+        length -= 2;
+    }
+    if (length)
+    {
+        sum += (ULONG)data[0] << 8;
+    }
+
+    /* Fold the carries so the sum cannot overflow on the next call.  */
+    sum = (sum & 0xFFFF) + (sum >> 16);
+    return((sum & 0xFFFF) + (sum >> 16));
+}
+
+ULONG _nx_linux_checksum_packet(NX_PACKET *packet_ptr, ULONG offset, ULONG length, ULONG sum)
+{
+NX_PACKET *current_ptr = packet_ptr;
+UCHAR     *data;
+ULONG      run;
+UINT       odd = NX_FALSE;
+
+    /* Sum length bytes starting at offset, across the packet chain.  */
+    while (current_ptr && length)
+    {
+        run = (ULONG)(current_ptr -> nx_packet_append_ptr - current_ptr -> nx_packet_prepend_ptr);
+        if (offset < run)
+        {
+            data = current_ptr -> nx_packet_prepend_ptr + offset;
+            run -= offset;
+            offset = 0;
+            if (run > length)
+            {
+                run = length;
+            }
+            length -= run;
+
+            if (odd)
+            {
+
+                /* The previous packet ended in the middle of a word.  */
+                sum += *data++;
+                run--;
+                odd = NX_FALSE;
+            }
+
+            sum = _nx_linux_checksum_add(data, run, sum);
+            odd = run & 1;
+        }
+        else
+        {
+            offset -= run;
+        }
+
+#ifndef NX_DISABLE_PACKET_CHAIN
+        current_ptr = current_ptr -> nx_packet_next;
+#else
+        current_ptr = NX_NULL;
+#endif /* NX_DISABLE_PACKET_CHAIN */
+    }
+
+    return((sum & 0xFFFF) + (sum >> 16));
+}
+
+UINT _nx_linux_checksum_verify(NX_PACKET *packet_ptr)
+{
+UCHAR  header[NX_ETHERNET_SIZE + 60 + 8];
+UCHAR *ip_ptr = header + NX_ETHERNET_SIZE;
+ULONG  header_length;
+ULONG  ip_header_length;
+ULONG  data_length;
+ULONG  sum = 0;
+UINT   packet_type;
+UINT   protocol;
+
+    /* Copy the headers out, as they may be spread over a packet chain.  */
+    if (nx_packet_data_extract_offset(packet_ptr, 0, header, sizeof(header), &header_length) ||
+        (header_length < NX_ETHERNET_SIZE))
+    {
+        return(NX_NOT_SUCCESSFUL);
+    }
+
+    packet_type = ((UINT)header[12] << 8) | header[13];
+    if (packet_type == NX_ETHERNET_IP)
+    {
+        ip_header_length = (ULONG)(ip_ptr[0] & 0x0F) * 4;
+        if (((ip_ptr[0] >> 4) != 4) || (ip_header_length < 20) ||
+            (header_length < NX_ETHERNET_SIZE + ip_header_length))
+        {
+            return(NX_NOT_SUCCESSFUL);
+        }
+
+        if (_nx_linux_checksum_add(ip_ptr, ip_header_length, 0) != 0xFFFF)
+        {
+            return(NX_NOT_SUCCESSFUL);
+        }
+
+        data_length = ((ULONG)ip_ptr[2] << 8) | ip_ptr[3];
+        if ((data_length < ip_header_length) ||
+            (NX_ETHERNET_SIZE + data_length > packet_ptr -> nx_packet_length))
+        {
+            return(NX_NOT_SUCCESSFUL);
+        }
+        data_length -= ip_header_length;
+
+        /* Fragments are only checked once reassembled, which NetX skips on this interface.  */
+        if ((ip_ptr[6] & 0x3F) || ip_ptr[7])
+        {
+            return(NX_SUCCESS);
+        }
+
+        protocol = ip_ptr[9];
+        if (protocol != IPPROTO_ICMP)
+        {
+            sum = _nx_linux_checksum_add(ip_ptr + 12, 8, 0);
+        }
+
+        /* A zero UDP checksum over IPv4 means there is none.  */
+        if ((protocol == IPPROTO_UDP) && (data_length >= 8) &&
+            (ip_ptr[ip_header_length + 6] == 0) && (ip_ptr[ip_header_length + 7] == 0))
+        {
+            return(NX_SUCCESS);
+        }
+    }
+    else if (packet_type == NX_ETHERNET_IPV6)
+    {
+        ip_header_length = 40;
+        if (((ip_ptr[0] >> 4) != 6) || (header_length < NX_ETHERNET_SIZE + ip_header_length))
+        {
+            return(NX_NOT_SUCCESSFUL);
+        }
+
+        data_length = ((ULONG)ip_ptr[4] << 8) | ip_ptr[5];
+        if (NX_ETHERNET_SIZE + ip_header_length + data_length > packet_ptr -> nx_packet_length)
+        {
+            return(NX_NOT_SUCCESSFUL);
+        }
+
+        /* Frames with extension headers are passed on unchecked.  */
+        protocol = ip_ptr[6];
+        sum = _nx_linux_checksum_add(ip_ptr + 8, 32, 0);
+    }
+    else
+    {
+
+        /* ARP, RARP and PPPoE carry no checksum NetX would skip.  */
+        return(NX_SUCCESS);
+    }
+
+    if ((protocol != IPPROTO_TCP) && (protocol != IPPROTO_UDP) &&
+        (protocol != IPPROTO_ICMP) && (protocol != IPPROTO_ICMPV6))
+    {
+        return(NX_SUCCESS);
+    }
+
+    if (protocol != IPPROTO_ICMP)
+    {
+        sum += protocol + data_length;
+    }
+    sum = _nx_linux_checksum_packet(packet_ptr, NX_ETHERNET_SIZE + ip_header_length, data_length, sum);
+    sum = (sum & 0xFFFF) + (sum >> 16);
+
+    return((sum == 0xFFFF) ? NX_SUCCESS : NX_NOT_SUCCESSFUL);
+}
+
+ULONG _nx_linux_receive_status_get(struct msghdr *message)
+{
+struct cmsghdr         *cmsg;
+struct tpacket_auxdata  auxdata;
+
+    for (cmsg = CMSG_FIRSTHDR(message); cmsg; cmsg = CMSG_NXTHDR(message, cmsg))
+    {
+        if ((cmsg -> cmsg_level == SOL_PACKET) && (cmsg -> cmsg_type == PACKET_AUXDATA))
+        {
+            memcpy(&auxdata, CMSG_DATA(cmsg), sizeof(auxdata));
+            return(auxdata.tp_status);
+        }
+    }
+
+    return(0);
+}
+
+VOID _nx_linux_receive_status_set(NX_PACKET *packet_ptr, ULONG status)
+{
+
+    /* Mark the packet when the kernel has validated, or locally generated, its checksums.  */
+    if (status & (TP_STATUS_CSUM_VALID | TP_STATUS_CSUMNOTREADY))
+    {
+        packet_ptr -> nx_packet_interface_capability_flag = NX_INTERFACE_RX_CAPABILITY;
+    }
+    else
+    {
+        packet_ptr -> nx_packet_interface_capability_flag = 0;
+    }
+}
+#endif /* NX_LINUX_ENABLE_CHECKSUM_OFFLOAD */
+
+#ifdef NX_LINUX_ENABLE_GSO
+VOID _nx_linux_gso_mss_update(NX_PACKET *packet_ptr)
+{
+UCHAR *ip_ptr = packet_ptr -> nx_packet_prepend_ptr + NX_ETHERNET_SIZE;
+UCHAR *tcp_ptr;
+UCHAR *option_ptr;
+UCHAR *option_end;
+ULONG  ip_header_length;
+ULONG  mss;
+ULONG  sum;
+UINT   packet_type;
+UINT   protocol;
+
+    packet_type = ((UINT)packet_ptr -> nx_packet_prepend_ptr[12] << 8) | packet_ptr -> nx_packet_prepend_ptr[13];
+    if (packet_type == NX_ETHERNET_IP)
+    {
+        ip_header_length = (ULONG)(ip_ptr[0] & 0x0F) * 4;
+        protocol = ip_ptr[9];
+    }
+    else
+    {
+        ip_header_length = 40;
+        protocol = ip_ptr[6];
+    }
+
+    /* Only look at SYN segments whose headers are in the first packet.  */
+    tcp_ptr = ip_ptr + ip_header_length;
+    if ((protocol != IPPROTO_TCP) || (tcp_ptr + 20 > packet_ptr -> nx_packet_append_ptr) ||
+        ((tcp_ptr[13] & 0x02) == 0))
+    {
+        return;
+    }
+
+    option_end = tcp_ptr + (ULONG)(tcp_ptr[12] >> 4) * 4;
+    if (option_end > packet_ptr -> nx_packet_append_ptr)
+    {
+        return;
+    }
+
+    for (option_ptr = tcp_ptr + 20; (option_ptr + 1 < option_end) && (option_ptr[0] != 0);)
+    {
+        if (option_ptr[0] == 1)
+        {
+
+            /* No operation.  */
+            option_ptr++;
+            continue;
+        }
+        if ((option_ptr[1] < 2) || (option_ptr + option_ptr[1] > option_end))
+        {
+            return;
+        }
+
+        if ((option_ptr[0] == 2) && (option_ptr[1] == 4))
+        {
+            mss = ((ULONG)option_ptr[2] << 8) | option_ptr[3];
+
+            /* A peer that takes full link-size segments takes what the kernel cuts.  */
+            if (mss < NX_LINK_MTU - NX_ETHERNET_SIZE - ip_header_length - 20)
+            {
+                return;
+            }
+
+            /* Update the TCP checksum incrementally (RFC 1624).  */
+            sum = (~(((ULONG)tcp_ptr[16] << 8) | tcp_ptr[17]) & 0xFFFF) + (~mss & 0xFFFF);
+            if (mss > (NX_LINUX_GSO_MTU - ip_header_length - 20) / NX_LINUX_GSO_MSS_MULTIPLE)
+            {
+                mss = NX_LINUX_GSO_MTU - ip_header_length - 20;
+            }
+            else
+            {
+                mss *= NX_LINUX_GSO_MSS_MULTIPLE;
+            }
+            sum += mss;
+            sum = (sum & 0xFFFF) + (sum >> 16);
+            sum = (sum & 0xFFFF) + (sum >> 16);
+            sum = ~sum & 0xFFFF;
+
+            option_ptr[2] = (UCHAR)(mss >> 8);
+            option_ptr[3] = (UCHAR)mss;
+            tcp_ptr[16] = (UCHAR)(sum >> 8);
+            tcp_ptr[17] = (UCHAR)sum;
+            return;
+        }
+
+        option_ptr += option_ptr[1];
+    }
+}
+
+UINT _nx_linux_gso_fragment(NX_LINUX_INSTANCE *instance_ptr, NX_PACKET *packet_ptr)
+{
+UCHAR     *ip_ptr = packet_ptr -> nx_packet_prepend_ptr + NX_ETHERNET_SIZE;
+UCHAR     *fragment_ip_ptr;
+UCHAR     *checksum_ptr;
+NX_PACKET *fragment_ptr;
+ULONG      ip_header_length;
+ULONG      header_length;
+ULONG      data_length;
+ULONG      fragment_length;
+ULONG      offset;
+ULONG      bytes;
+ULONG      sum;
+ULONG      id = 0;
+UINT       packet_type;
+UINT       protocol;
+UINT       flags;
+
+    packet_type = ((UINT)packet_ptr -> nx_packet_prepend_ptr[12] << 8) | packet_ptr -> nx_packet_prepend_ptr[13];
+    if (packet_type == NX_ETHERNET_IP)
+    {
+        ip_header_length = (ULONG)(ip_ptr[0] & 0x0F) * 4;
+        data_length = (((ULONG)ip_ptr[2] << 8) | ip_ptr[3]) - ip_header_length;
+        protocol = ip_ptr[9];
+        header_length = NX_ETHERNET_SIZE + ip_header_length;
+    }
+    else if (packet_type == NX_ETHERNET_IPV6)
+    {
+        ip_header_length = 40;
+        data_length = ((ULONG)ip_ptr[4] << 8) | ip_ptr[5];
+        protocol = ip_ptr[6];
+
+        /* Every fragment carries a fragment header after the IPv6 header.  */
+        header_length = NX_ETHERNET_SIZE + ip_header_length + 8;
+    }
+    else
+    {
+        return(NX_FALSE);
+    }
+
+    /* TCP segments are cut by the kernel.  */
+    if (protocol == IPPROTO_TCP)
+    {
+        return(NX_FALSE);
+    }
+
+    /* Fragments cannot be sent when IPv4 forbids them, or past IPv6 extension headers,
+       which the driver does not parse.  */
+    if (((packet_type == NX_ETHERNET_IP) && (ip_ptr[6] & 0x40)) ||
+        ((packet_type == NX_ETHERNET_IPV6) && (protocol != IPPROTO_UDP) && (protocol != IPPROTO_ICMPV6)) ||
+        ((ULONG)(packet_ptr -> nx_packet_append_ptr - packet_ptr -> nx_packet_prepend_ptr) < NX_ETHERNET_SIZE + ip_header_length + 8))
+    {
+        NX_LINUX_STATISTICS_ADD(instance_ptr, tx_oversize_drops, 1);
+        packet_ptr -> nx_packet_prepend_ptr += NX_ETHERNET_SIZE;
+        packet_ptr -> nx_packet_length -= NX_ETHERNET_SIZE;
+        nx_packet_transmit_release(packet_ptr);
+        return(NX_TRUE);
+    }
+
+    /* Complete the UDP checksum NetX left to the driver, as it covers every fragment.  */
+    if (packet_ptr -> nx_packet_interface_capability_flag & NX_INTERFACE_CAPABILITY_UDP_TX_CHECKSUM)
+    {
+        checksum_ptr = ip_ptr + ip_header_length + 6;
+        checksum_ptr[0] = 0;
+        checksum_ptr[1] = 0;
+        if (packet_type == NX_ETHERNET_IP)
+        {
+            sum = _nx_linux_checksum_add(ip_ptr + 12, 8, 0);
+        }
+        else
+        {
+            sum = _nx_linux_checksum_add(ip_ptr + 8, 32, 0);
+        }
+        sum += protocol + data_length;
+        sum = _nx_linux_checksum_packet(packet_ptr, NX_ETHERNET_SIZE + ip_header_length, data_length, sum);
+        sum = (sum & 0xFFFF) + (sum >> 16);
+        sum = (sum & 0xFFFF) + (sum >> 16);
+        sum = ~sum & 0xFFFF;
+        if (sum == 0)
+        {
+            sum = 0xFFFF;
+        }
+        checksum_ptr[0] = (UCHAR)(sum >> 8);
+        checksum_ptr[1] = (UCHAR)sum;
+        packet_ptr -> nx_packet_interface_capability_flag &= ~(ULONG)NX_INTERFACE_CAPABILITY_UDP_TX_CHECKSUM;
+    }
+
+    if (packet_type == NX_ETHERNET_IPV6)
+    {
+        id = __atomic_add_fetch(&nx_linux_fragment_id, 1, __ATOMIC_RELAXED);
+    }
+
+    /* Send the payload in pieces of a multiple of 8 bytes that fill a link frame.  */
+    for (offset = 0; offset < data_length; offset += fragment_length)
+    {
+        fragment_length = data_length - offset;
+        if (header_length + fragment_length > NX_LINK_MTU)
+        {
+            fragment_length = (NX_LINK_MTU - header_length) & ~7UL;
+        }
+
+        if (nx_packet_allocate(packet_ptr -> nx_packet_pool_owner, &fragment_ptr, 0, NX_NO_WAIT))
+        {
+            NX_LINUX_STATISTICS_ADD(instance_ptr, allocation_errors, 1);
+            break;
+        }
+        if ((ULONG)(fragment_ptr -> nx_packet_data_end - fragment_ptr -> nx_packet_prepend_ptr) < header_length + fragment_length)
+        {
+            NX_LINUX_STATISTICS_ADD(instance_ptr, tx_oversize_drops, 1);
+            nx_packet_release(fragment_ptr);
+            break;
+        }
+
+        /* Copy the Ethernet and IP headers, then the piece of the payload.  */
+        memcpy(fragment_ptr -> nx_packet_prepend_ptr, packet_ptr -> nx_packet_prepend_ptr, NX_ETHERNET_SIZE + ip_header_length);
+        if (nx_packet_data_extract_offset(packet_ptr, NX_ETHERNET_SIZE + ip_header_length + offset,
+                                          fragment_ptr -> nx_packet_prepend_ptr + header_length, fragment_length, &bytes) ||
+            (bytes != fragment_length))
+        {
+            NX_LINUX_STATISTICS_ADD(instance_ptr, tx_errors, 1);
+            nx_packet_release(fragment_ptr);
+            break;
+        }
+
+        fragment_ip_ptr = fragment_ptr -> nx_packet_prepend_ptr + NX_ETHERNET_SIZE;
+        flags = (offset + fragment_length < data_length) ? 1 : 0;
+        if (packet_type == NX_ETHERNET_IP)
+        {
+
+            /* Keep the identification, and add to the offset and more fragments flag NetX set.  */
+            flags = ((((UINT)ip_ptr[6] << 8) | ip_ptr[7]) + (UINT)(offset >> 3)) | (flags << 13);
+            fragment_ip_ptr[2] = (UCHAR)((ip_header_length + fragment_length) >> 8);
+            fragment_ip_ptr[3] = (UCHAR)(ip_header_length + fragment_length);
+            fragment_ip_ptr[6] = (UCHAR)(flags >> 8);
+            fragment_ip_ptr[7] = (UCHAR)flags;
+            fragment_ip_ptr[10] = 0;
+            fragment_ip_ptr[11] = 0;
+            sum = _nx_linux_checksum_add(fragment_ip_ptr, ip_header_length, 0);
+            sum = (sum & 0xFFFF) + (sum >> 16);
+            sum = (sum & 0xFFFF) + (sum >> 16);
+            sum = ~sum & 0xFFFF;
+            fragment_ip_ptr[10] = (UCHAR)(sum >> 8);
+            fragment_ip_ptr[11] = (UCHAR)sum;
+        }
+        else
+        {
+            fragment_ip_ptr[4] = (UCHAR)((8 + fragment_length) >> 8);
+            fragment_ip_ptr[5] = (UCHAR)(8 + fragment_length);
+            fragment_ip_ptr[6] = 44;
+            fragment_ip_ptr[40] = (UCHAR)protocol;
+            fragment_ip_ptr[41] = 0;
+            fragment_ip_ptr[42] = (UCHAR)(offset >> 8);
+            fragment_ip_ptr[43] = (UCHAR)((offset & 0xF8) | flags);
+            fragment_ip_ptr[44] = (UCHAR)(id >> 24);
+            fragment_ip_ptr[45] = (UCHAR)(id >> 16);
+            fragment_ip_ptr[46] = (UCHAR)(id >> 8);
+            fragment_ip_ptr[47] = (UCHAR)id;
+        }
+
+        fragment_ptr -> nx_packet_append_ptr = fragment_ptr -> nx_packet_prepend_ptr + header_length + fragment_length;
+        fragment_ptr -> nx_packet_length = header_length + fragment_length;
+        fragment_ptr -> nx_packet_ip_version = packet_ptr -> nx_packet_ip_version;
+        fragment_ptr -> nx_packet_interface_capability_flag = 0;
+
+#ifdef NX_LINUX_ENABLE_IMPAIRMENT
+        /* Drop or hold back each fragment as configured.  */
+        if (_nx_linux_impairment_apply(instance_ptr, fragment_ptr, NX_LINUX_IMPAIRMENT_TRANSMIT))
+        {
+            continue;
+        }
+#endif /* NX_LINUX_ENABLE_IMPAIRMENT */
+        _nx_linux_network_driver_output(instance_ptr, fragment_ptr);
+    }
+
+    /* The fragments are copies, so the datagram is done.  */
+    packet_ptr -> nx_packet_prepend_ptr += NX_ETHERNET_SIZE;
+    packet_ptr -> nx_packet_length -= NX_ETHERNET_SIZE;
+    nx_packet_transmit_release(packet_ptr);
+    return(NX_TRUE);
+}
+#endif /* NX_LINUX_ENABLE_GSO */
+
+UINT _nx_linux_send_packet(NX_LINUX_INSTANCE *instance_ptr, NX_PACKET *packet_ptr)
+{
+ULONG              size = 0;
+UCHAR             *data;
+struct sockaddr_ll to_address;
+#ifdef NX_LINUX_ENABLE_CHECKSUM_OFFLOAD
+struct virtio_net_hdr vnet_hdr;
+struct iovec       vectors[2];
+struct msghdr      message;
+#endif /* NX_LINUX_ENABLE_CHECKSUM_OFFLOAD */
+
+    /* Make sure the data length is less than MTU. */
+    if (packet_ptr -> nx_packet_length > NX_LINUX_TRANSMIT_BUFFER_SIZE)
+    {
+        NX_LINUX_STATISTICS_ADD(instance_ptr, tx_errors, 1);
+        return NX_NOT_SUCCESSFUL;
+    }
+
+#ifdef NX_LINUX_ENABLE_TX_RING
+    if (instance_ptr -> nx_linux_instance_tx_ring)
+    {
+#ifdef NX_LINUX_ENABLE_GSO
+        if (packet_ptr -> nx_packet_length <= NX_LINK_MTU)
+        {
+            return(_nx_linux_tx_ring_send(instance_ptr, packet_ptr));
+        }
+
+        /* Large segments do not fit a ring slot. Send the queued frames first to keep them in order.  */
+        _nx_linux_tx_ring_flush(instance_ptr);
+#else
+        return(_nx_linux_tx_ring_send(instance_ptr, packet_ptr));
+#endif /* NX_LINUX_ENABLE_GSO */
+    }
+#endif /* NX_LINUX_ENABLE_TX_RING */
+
+    /* Set data pointer to be transmitted.  */
+#ifndef NX_DISABLE_PACKET_CHAIN
+    if (packet_ptr -> nx_packet_next)
+    {
+        if (nx_packet_data_retrieve(packet_ptr, instance_ptr -> nx_linux_instance_transmit_buffer, &size))
+        {
+            NX_LINUX_STATISTICS_ADD(instance_ptr, tx_errors, 1);
+            return NX_NOT_SUCCESSFUL;
+        }
+        data = instance_ptr -> nx_linux_instance_transmit_buffer;
+    }
+    else
+#endif /* NX_DISABLE_PACKET_CHAIN */
+    {
+        data = packet_ptr -> nx_packet_prepend_ptr;
+        size = packet_ptr -> nx_packet_length;
+    }
+
+    /* Set destination address.  */
+    to_address.sll_family = AF_PACKET;
+    to_address.sll_protocol = htons(ETH_P_ALL);
+    to_address.sll_ifindex = instance_ptr -> nx_linux_instance_interface_index;
+
+#ifdef NX_LINUX_ENABLE_CHECKSUM_OFFLOAD
+    if (instance_ptr -> nx_linux_instance_vnet_socket >= 0)
+    {
+
+        /* Send the virtio-net header in front of the frame.  */
+        if (_nx_linux_vnet_header_build(packet_ptr, &vnet_hdr))
+        {
+            NX_LINUX_STATISTICS_ADD(instance_ptr, tx_errors, 1);
+            return NX_NOT_SUCCESSFUL;
+        }
+        vectors[0].iov_base = &vnet_hdr;
+        vectors[0].iov_len = sizeof(vnet_hdr);
+        vectors[1].iov_base = data;
+        vectors[1].iov_len = size;
+
+        memset(&message, 0, sizeof(message));
+        message.msg_name = &to_address;
+        message.msg_namelen = sizeof(to_address);
+        message.msg_iov = vectors;
+        message.msg_iovlen = 2;
+        NX_LINUX_STATISTICS_ADD(instance_ptr, tx_syscalls, 1);
+        if (sendmsg(instance_ptr -> nx_linux_instance_vnet_socket, &message, 0) != (ssize_t)(sizeof(vnet_hdr) + size))
+        {
+            NX_LINUX_STATISTICS_ADD(instance_ptr, tx_errors, 1);
+            return NX_NOT_SUCCESSFUL;
+        }
+
+        NX_LINUX_STATISTICS_ADD(instance_ptr, tx_frames, 1);
+        NX_LINUX_STATISTICS_ADD(instance_ptr, tx_bytes, size);
+        return NX_SUCCESS;
+    }
+#endif /* NX_LINUX_ENABLE_CHECKSUM_OFFLOAD */
+
+    NX_LINUX_STATISTICS_ADD(instance_ptr, tx_syscalls, 1);
+    if (sendto(instance_ptr -> nx_linux_instance_socket, (CHAR *)data, size, 0,
+               (struct sockaddr *)&to_address, sizeof(to_address)) != size)
+    {
+        NX_LINUX_STATISTICS_ADD(instance_ptr, tx_errors, 1);
+        return NX_NOT_SUCCESSFUL;
+    }
+
+    NX_LINUX_STATISTICS_ADD(instance_ptr, tx_frames, 1);
+    NX_LINUX_STATISTICS_ADD(instance_ptr, tx_bytes, size);
+    return NX_SUCCESS;
+}
+
+VOID _nx_linux_multicast_membership(NX_LINUX_INSTANCE *instance_ptr, ULONG64 address, int option)
+{
+struct packet_mreq mreq;
+
+    memset(&mreq, 0, sizeof(mreq));
+    mreq.mr_ifindex = instance_ptr -> nx_linux_instance_interface_index;
+    mreq.mr_type = PACKET_MR_MULTICAST;
+    mreq.mr_alen = NX_ETHERNET_MAC_SIZE;
+    mreq.mr_address[0] = (UCHAR)(address >> 40);
+    mreq.mr_address[1] = (UCHAR)(address >> 32);
+    mreq.mr_address[2] = (UCHAR)(address >> 24);
+    mreq.mr_address[3] = (UCHAR)(address >> 16);
+    mreq.mr_address[4] = (UCHAR)(address >> 8);
+    mreq.mr_address[5] = (UCHAR)address;
+
+    /* The membership is tied to the driver socket and programs the filter of the interface.  */
+    setsockopt(instance_ptr -> nx_linux_instance_socket, SOL_PACKET, option, &mreq, sizeof(mreq));
+}
+
+UINT _nx_linux_multicast_join(NX_LINUX_INSTANCE *instance_ptr, ULONG physical_msw, ULONG physical_lsw)
+{
+ULONG64 address = ((ULONG64)(physical_msw & 0xFFFF) << 32) | (physical_lsw & 0xFFFFFFFF);
+UINT    i;
+UINT    free_index = NX_LINUX_MULTICAST_TABLE_SIZE;
+
+    for (i = 0; i < NX_LINUX_MULTICAST_TABLE_SIZE; i++)
+    {
+        if (instance_ptr -> nx_linux_instance_multicast_address[i] == address)
+        {
+
+            /* Already joined, for another group that maps to the same MAC address.  */
+            instance_ptr -> nx_linux_instance_multicast_count[i]++;
+            return(NX_SUCCESS);
+        }
+
+        if ((instance_ptr -> nx_linux_instance_multicast_address[i] == 0) && (free_index == NX_LINUX_MULTICAST_TABLE_SIZE))
+        {
+            free_index = i;
+        }
+    }
+
+    if (free_index == NX_LINUX_MULTICAST_TABLE_SIZE)
+    {
+        return(NX_NO_MORE_ENTRIES);
+    }
+
+    instance_ptr -> nx_linux_instance_multicast_count[free_index] = 1;
+    __atomic_store_n(&instance_ptr -> nx_linux_instance_multicast_address[free_index], address, __ATOMIC_RELEASE);
+    _nx_linux_multicast_membership(instance_ptr, address, PACKET_ADD_MEMBERSHIP);
+#ifdef NX_LINUX_ENABLE_RECEIVE_FILTER
+    _nx_linux_receive_filter_update(instance_ptr);
+#endif /* NX_LINUX_ENABLE_RECEIVE_FILTER */
+
+    return(NX_SUCCESS);
+}
+
+UINT _nx_linux_multicast_leave(NX_LINUX_INSTANCE *instance_ptr, ULONG physical_msw, ULONG physical_lsw)
+{
+ULONG64 address = ((ULONG64)(physical_msw & 0xFFFF) << 32) | (physical_lsw & 0xFFFFFFFF);
+UINT    i;
+
+    for (i = 0; i < NX_LINUX_MULTICAST_TABLE_SIZE; i++)
+    {
+        if (instance_ptr -> nx_linux_instance_multicast_address[i] != address)
+        {
+            continue;
+        }
+
+        /* Remove the address once the last group using it is left.  */
+        if (--instance_ptr -> nx_linux_instance_multicast_count[i] == 0)
+        {
+            __atomic_store_n(&instance_ptr -> nx_linux_instance_multicast_address[i], 0, __ATOMIC_RELEASE);
+            _nx_linux_multicast_membership(instance_ptr, address, PACKET_DROP_MEMBERSHIP);
+#ifdef NX_LINUX_ENABLE_RECEIVE_FILTER
+            _nx_linux_receive_filter_update(instance_ptr);
+#endif /* NX_LINUX_ENABLE_RECEIVE_FILTER */
+        }
+        return(NX_SUCCESS);
+    }
+
+    return(NX_ENTRY_NOT_FOUND);
+}
+
+#ifdef NX_LINUX_ENABLE_RECEIVE_FILTER
+UINT _nx_linux_receive_filter_build(NX_LINUX_INSTANCE *instance_ptr, struct sock_filter *filter)
+{
+ULONG64 address[NX_LINUX_MULTICAST_TABLE_SIZE + 2];
+UINT    address_count = 0;
+UINT    count = 0;
+UINT    i;
+
+    /* Accept our unicast address, broadcast and every joined multicast address.  */
+    address[address_count++] = ((ULONG64)(instance_ptr -> nx_linux_instance_address_msw & 0xFFFF) << 32) |
+                               (instance_ptr -> nx_linux_instance_address_lsw & 0xFFFFFFFF);
+    address[address_count++] = 0xFFFFFFFFFFFFULL;
+    for (i = 0; i < NX_LINUX_MULTICAST_TABLE_SIZE; i++)
+    {
+        if (instance_ptr -> nx_linux_instance_multicast_address[i])
+        {
+            address[address_count++] = instance_ptr -> nx_linux_instance_multicast_address[i];
+        }
+    }
+
+    /* Drop the frames sent by this host, which the kernel loops back to packet sockets.  */
+    filter[count++] = (struct sock_filter)BPF_STMT(BPF_LD | BPF_W | BPF_ABS, (__u32)(SKF_AD_OFF + SKF_AD_PKTTYPE));
+    filter[count++] = (struct sock_filter)BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, PACKET_OUTGOING, 5 * address_count, 0);
+
+    /* Compare the destination address, two bytes then four bytes, and accept the whole frame on a match.  */
+    for (i = 0; i < address_count; i++)
+    {
+        filter[count++] = (struct sock_filter)BPF_STMT(BPF_LD | BPF_H | BPF_ABS, 0);
+        filter[count++] = (struct sock_filter)BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, (__u32)(address[i] >> 32), 0, 3);
+        filter[count++] = (struct sock_filter)BPF_STMT(BPF_LD | BPF_W | BPF_ABS, 2);
+        filter[count++] = (struct sock_filter)BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, (__u32)address[i], 0, 1);
+        filter[count++] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K, 0xFFFFFFFF);
+    }
+    filter[count++] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K, 0);
+
+    return(count);
+}
+
+VOID _nx_linux_receive_filter_attach(NX_LINUX_INSTANCE *instance_ptr, int socket_fd)
+{
+struct sock_filter filter[NX_LINUX_RECEIVE_FILTER_SIZE];
+struct sock_fprog  program;
+
+    program.len = (unsigned short)_nx_linux_receive_filter_build(instance_ptr, filter);
+    program.filter = filter;
+
+    /* The new program replaces the old one atomically. On failure the socket keeps
+       its previous filter, or receives every frame.  */
+    setsockopt(socket_fd, SOL_SOCKET, SO_ATTACH_FILTER, &program, sizeof(program));
+}
+
+VOID _nx_linux_receive_filter_update(NX_LINUX_INSTANCE *instance_ptr)
+{
+UINT i;
+
+    for (i = 0; i < instance_ptr -> nx_linux_instance_receive_queue_count; i++)
+    {
+        _nx_linux_receive_filter_attach(instance_ptr, instance_ptr -> nx_linux_instance_receive_queues[i].nx_linux_receive_queue_socket);
+    }
+}
+#endif /* NX_LINUX_ENABLE_RECEIVE_FILTER */
+
+UINT _nx_linux_frame_check(NX_LINUX_INSTANCE *instance_ptr, UCHAR *frame_ptr, ULONG length)
+{
+
+    NX_LINUX_STATISTICS_ADD(instance_ptr, rx_frames, 1);
+    NX_LINUX_STATISTICS_ADD(instance_ptr, rx_bytes, length);
+
+    /* Drop frames too short to hold an Ethernet header.  */
+    if (length < NX_ETHERNET_SIZE)
+    {
+        NX_LINUX_STATISTICS_ADD(instance_ptr, rx_short_drops, 1);
+        return(NX_FALSE);
+    }
+
+#ifdef NX_LINUX_ENABLE_MULTICAST_FILTER
+    /* Drop multicast frames for groups the interface has not joined.  */
+    if (!_nx_linux_destination_accept(instance_ptr, frame_ptr))
+    {
+        NX_LINUX_STATISTICS_ADD(instance_ptr, rx_filter_drops, 1);
+        return(NX_FALSE);
+    }
+#endif /* NX_LINUX_ENABLE_MULTICAST_FILTER */
+
+    return(NX_TRUE);
+}
+
+#ifdef NX_LINUX_ENABLE_MULTICAST_FILTER
+UINT _nx_linux_destination_accept(NX_LINUX_INSTANCE *instance_ptr, UCHAR *frame_ptr)
+{
+ULONG64 address;
+UINT    i;
+
+    /* Unicast frames are not filtered here.  */
+    if ((frame_ptr[0] & 0x01) == 0)
+    {
+        return(NX_TRUE);
+    }
+
+    address = ((ULONG64)frame_ptr[0] << 40) | ((ULONG64)frame_ptr[1] << 32) | ((ULONG64)frame_ptr[2] << 24) |
+              ((ULONG64)frame_ptr[3] << 16) | ((ULONG64)frame_ptr[4] << 8) | (ULONG64)frame_ptr[5];
+    if (address == 0xFFFFFFFFFFFFULL)
+    {
+        return(NX_TRUE);
+    }
+
+    for (i = 0; i < NX_LINUX_MULTICAST_TABLE_SIZE; i++)
+    {
+        if (__atomic_load_n(&instance_ptr -> nx_linux_instance_multicast_address[i], __ATOMIC_ACQUIRE) == address)
+        {
+            return(NX_TRUE);
+        }
+    }
+
+    return(NX_FALSE);
+}
+#endif /* NX_LINUX_ENABLE_MULTICAST_FILTER */
+
+#ifdef NX_LINUX_ENABLE_CAPTURE
+VOID _nx_linux_capture_start(VOID)
+{
+UINT i;
+
+    /* Every entry starts free for the first lap of the ring.  */
+    for (i = 0; i < NX_LINUX_CAPTURE_RING_SIZE; i++)
+    {
+        nx_linux_capture_ring[i].nx_linux_capture_entry_sequence = i;
+    }
+
+    /* The writer thread runs at normal priority, behind the receive threads.  */
+    pthread_create(&nx_linux_capture_thread, NULL, _nx_linux_capture_thread_entry, NX_NULL);
+}
+
+VOID _nx_linux_capture(NX_LINUX_INSTANCE *instance_ptr, NX_PACKET *packet_ptr, UINT flags)
+{
+NX_LINUX_CAPTURE_ENTRY *entry_ptr;
+NX_PACKET              *current_ptr = packet_ptr;
+struct timespec         now;
+UINT                    head;
+UINT                    captured = 0;
+UINT                    length;
+int                     difference;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    /* Claim the next entry, unless the writer thread has not taken it yet.  */
+    head = __atomic_load_n(&nx_linux_capture_head, __ATOMIC_RELAXED);
+    for (;;)
+    {
+        entry_ptr = &nx_linux_capture_ring[head & (NX_LINUX_CAPTURE_RING_SIZE - 1)];
+        difference = (int)(__atomic_load_n(&entry_ptr -> nx_linux_capture_entry_sequence, __ATOMIC_ACQUIRE) - head);
+        if (difference < 0)
+        {
+
+            /* The ring is full. Drop the capture, not the frame.  */
+            __atomic_fetch_add(&nx_linux_capture_drop_count, 1, __ATOMIC_RELAXED);
+            return;
+        }
+
+        if (difference == 0)
+        {
+            if (__atomic_compare_exchange_n(&nx_linux_capture_head, &head, head + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else
+        {
+
+            /* Another thread claimed the entry first.  */
+            head = __atomic_load_n(&nx_linux_capture_head, __ATOMIC_RELAXED);
+        }
+    }
+
+    /* Copy the start of the frame, across chained packets.  */
+    while (current_ptr && (captured < NX_LINUX_CAPTURE_SNAPLEN))
+    {
+        length = (UINT)(current_ptr -> nx_packet_append_ptr - current_ptr -> nx_packet_prepend_ptr);
+        if (length > NX_LINUX_CAPTURE_SNAPLEN - captured)
+        {
+            length = NX_LINUX_CAPTURE_SNAPLEN - captured;
+        }
+        memcpy(entry_ptr -> nx_linux_capture_entry_data + captured, current_ptr -> nx_packet_prepend_ptr, length);
+        captured += length;
+#ifndef NX_DISABLE_PACKET_CHAIN
+        current_ptr = current_ptr -> nx_packet_next;
+#else
+        current_ptr = NX_NULL;
+#endif /* NX_DISABLE_PACKET_CHAIN */
+    }
+
+    entry_ptr -> nx_linux_capture_entry_interface = (UINT)(instance_ptr - nx_linux_instances);
+    entry_ptr -> nx_linux_capture_entry_flags = flags;
+    entry_ptr -> nx_linux_capture_entry_length = packet_ptr -> nx_packet_length;
+    entry_ptr -> nx_linux_capture_entry_captured = captured;
+    entry_ptr -> nx_linux_capture_entry_time = (ULONG64)now.tv_sec * 1000000000 + (ULONG64)now.tv_nsec;
+
+    /* Hand the entry to the writer thread.  */
+    __atomic_store_n(&entry_ptr -> nx_linux_capture_entry_sequence, head + 1, __ATOMIC_RELEASE);
+}
+
+VOID _nx_linux_capture_block_write(FILE *file, UINT type, UCHAR *body, UINT length)
+{
+static const UCHAR padding[4] = {0};
+UINT               total_length = 12 + ((length + 3) & ~3U);
+
+    /* A block is its type and total length, the body padded to 32 bits, and the
+       total length again.  */
+    fwrite(&type, sizeof(type), 1, file);
+    fwrite(&total_length, sizeof(total_length), 1, file);
+    fwrite(body, 1, length, file);
+    fwrite(padding, 1, total_length - 12 - length, file);
+    fwrite(&total_length, sizeof(total_length), 1, file);
+}
+
+VOID _nx_linux_capture_interface_write(FILE *file, NX_LINUX_INSTANCE *instance_ptr)
+{
+UCHAR  body[16 + IF_NAMESIZE + 12];
+USHORT value16;
+UINT   value32;
+UINT   name_length;
+UINT   length;
+
+    /* Ethernet frames, cut at the capture length.  */
+    value16 = 1;
+    memcpy(body, &value16, 2);
+    value16 = 0;
+    memcpy(body + 2, &value16, 2);
+    value32 = NX_LINUX_CAPTURE_SNAPLEN;
+    memcpy(body + 4, &value32, 4);
+    length = 8;
+
+    /* Name the interface after the Linux interface.  */
+    name_length = (UINT)strnlen(instance_ptr -> nx_linux_instance_interface_name, IF_NAMESIZE);
+    value16 = 2;
+    memcpy(body + length, &value16, 2);
+    value16 = (USHORT)name_length;
+    memcpy(body + length + 2, &value16, 2);
+    memset(body + length + 4, 0, (name_length + 3) & ~3U);
+    memcpy(body + length + 4, instance_ptr -> nx_linux_instance_interface_name, name_length);
+    length += 4 + ((name_length + 3) & ~3U);
+
+    /* Timestamps are in nanoseconds.  */
+    value16 = 9;
+    memcpy(body + length, &value16, 2);
+    value16 = 1;
+    memcpy(body + length + 2, &value16, 2);
+    value32 = 0;
+    memcpy(body + length + 4, &value32, 4);
+    body[length + 4] = 9;
+    length += 8;
+
+    /* End the options.  */
+    value32 = 0;
+    memcpy(body + length, &value32, 4);
+    length += 4;
+
+    _nx_linux_capture_block_write(file, 0x00000001, body, length);
+}
+
+void *_nx_linux_capture_thread_entry(void *arg)
+{
+NX_LINUX_CAPTURE_ENTRY *entry_ptr;
+FILE                   *file;
+UCHAR                   body[20 + ((NX_LINUX_CAPTURE_SNAPLEN + 3) & ~3U) + 12];
+UINT                    interface_id[NX_LINUX_INSTANCE_COUNT];
+UINT                    interface_count = 0;
+UINT                    tail = 0;
+UINT                    value32;
+USHORT                  value16;
+UINT                    length;
+struct timespec         wait;
+
+    NX_PARAMETER_NOT_USED(arg);
+
+    /* Without a file the ring fills up, and every capture is counted as dropped.  */
+    file = fopen(NX_LINUX_CAPTURE_FILE, "wb");
+    if (file == NX_NULL)
+    {
+        return((void *)0);
+    }
+
+    /* Start the section.  Blocks are written in host byte order, which the
+       byte-order magic tells readers.  */
+    value32 = 0x1A2B3C4D;
+    memcpy(body, &value32, 4);
+    value16 = 1;
+    memcpy(body + 4, &value16, 2);
+    value16 = 0;
+    memcpy(body + 6, &value16, 2);
+    memset(body + 8, 0xFF, 8);
+    _nx_linux_capture_block_write(file, 0x0A0D0D0A, body, 16);
+
+    memset(interface_id, 0xFF, sizeof(interface_id));
+    wait.tv_sec = NX_LINUX_CAPTURE_WAIT / 1000000;
+    wait.tv_nsec = (NX_LINUX_CAPTURE_WAIT % 1000000) * 1000;
+
+    for (;;)
+    {
+        entry_ptr = &nx_linux_capture_ring[tail & (NX_LINUX_CAPTURE_RING_SIZE - 1)];
+        if (__atomic_load_n(&entry_ptr -> nx_linux_capture_entry_sequence, __ATOMIC_ACQUIRE) != tail + 1)
+        {
+
+            /* The ring is empty. Push the frames written so far to the file and wait.  */
+            fflush(file);
+            nanosleep(&wait, NX_NULL);
+            continue;
+        }
+
+        /* Describe the interface before its first frame.  */
+        if (interface_id[entry_ptr -> nx_linux_capture_entry_interface] == 0xFFFFFFFF)
+        {
+            interface_id[entry_ptr -> nx_linux_capture_entry_interface] = interface_count++;
+            _nx_linux_capture_interface_write(file, &nx_linux_instances[entry_ptr -> nx_linux_capture_entry_interface]);
+        }
+
+        /* Write the frame in an enhanced packet block, with its direction.  */
+        memcpy(body, &interface_id[entry_ptr -> nx_linux_capture_entry_interface], 4);
+        value32 = (UINT)(entry_ptr -> nx_linux_capture_entry_time >> 32);
+        memcpy(body + 4, &value32, 4);
+        value32 = (UINT)entry_ptr -> nx_linux_capture_entry_time;
+        memcpy(body + 8, &value32, 4);
+        memcpy(body + 12, &entry_ptr -> nx_linux_capture_entry_captured, 4);
+        memcpy(body + 16, &entry_ptr -> nx_linux_capture_entry_length, 4);
+        length = entry_ptr -> nx_linux_capture_entry_captured;
+        memcpy(body + 20, entry_ptr -> nx_linux_capture_entry_data, length);
+        memset(body + 20 + length, 0, ((length + 3) & ~3U) - length);
+        length = 20 + ((length + 3) & ~3U);
+        value16 = 2;
+        memcpy(body + length, &value16, 2);
+        value16 = 4;
+        memcpy(body + length + 2, &value16, 2);
+        memcpy(body + length + 4, &entry_ptr -> nx_linux_capture_entry_flags, 4);
+        value32 = 0;
+        memcpy(body + length + 8, &value32, 4);
+        length += 12;
+        _nx_linux_capture_block_write(file, 0x00000006, body, length);
+
+        /* Free the entry for the next lap of the ring.  */
+        __atomic_store_n(&entry_ptr -> nx_linux_capture_entry_sequence, tail + NX_LINUX_CAPTURE_RING_SIZE, __ATOMIC_RELEASE);
+        tail++;
+        __atomic_fetch_add(&nx_linux_capture_count, 1, __ATOMIC_RELAXED);
+    }
+}
+#endif /* NX_LINUX_ENABLE_CAPTURE */
+
+#ifdef NX_LINUX_ENABLE_IMPAIRMENT
+VOID _nx_linux_impairment_initialize(NX_LINUX_INSTANCE *instance_ptr)
+{
+ULONG64 seed;
+UINT    i;
+
+    /* Seed each direction apart with splitmix64, so the frames of one direction
+       do not move the decisions of the other.  */
+    for (i = 0; i < 2; i++)
+    {
+        seed = (ULONG64)NX_LINUX_IMPAIRMENT_SEED +
+               ((ULONG64)(instance_ptr - nx_linux_instances) * 2 + i + 1) * 0x9E3779B97F4A7C15ULL;
+        seed = (seed ^ (seed >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        seed = (seed ^ (seed >> 27)) * 0x94D049BB133111EBULL;
+        seed ^= seed >> 31;
+        instance_ptr -> nx_linux_instance_impairment[i].nx_linux_impairment_random = seed ? seed : 1;
+    }
+
+    /* Put every entry on the free list.  */
+    for (i = 0; i < NX_LINUX_IMPAIRMENT_LIMIT - 1; i++)
+    {
+        instance_ptr -> nx_linux_instance_impairment_entries[i].nx_linux_impairment_entry_next =
+            &instance_ptr -> nx_linux_instance_impairment_entries[i + 1];
+    }
+    instance_ptr -> nx_linux_instance_impairment_entries[NX_LINUX_IMPAIRMENT_LIMIT - 1].nx_linux_impairment_entry_next = NX_NULL;
+    instance_ptr -> nx_linux_instance_impairment_free = instance_ptr -> nx_linux_instance_impairment_entries;
+
+    instance_ptr -> nx_linux_instance_impairment_tick = _nx_linux_time_get() / (NX_LINUX_IMPAIRMENT_TICK * 1000);
+}
+
+VOID _nx_linux_impairment_start(VOID)
+{
+struct sched_param sp;
+
+    nx_linux_impairment_event = eventfd(0, EFD_NONBLOCK);
+
+    /* The timer thread raises interrupts like the receive threads, at their priority.  */
+#ifdef TX_LINUX_PRIORITY_ISR
+    sp.sched_priority = TX_LINUX_PRIORITY_ISR;
+#else
+    sp.sched_priority = 2;
+#endif
+    pthread_create(&nx_linux_impairment_thread, NULL, _nx_linux_impairment_thread_entry, NX_NULL);
+    pthread_setschedparam(nx_linux_impairment_thread, SCHED_FIFO, &sp);
+}
+
+ULONG64 _nx_linux_impairment_random(NX_LINUX_IMPAIRMENT *impairment_ptr)
+{
+ULONG64 random = impairment_ptr -> nx_linux_impairment_random;
+
+    /* xorshift64*.  */
+    random ^= random >> 12;
+    random ^= random << 25;
+    random ^= random >> 27;
+    impairment_ptr -> nx_linux_impairment_random = random;
+
+    return(random * 0x2545F4914F6CDD1DULL);
+}
+
+UINT _nx_linux_impairment_chance(NX_LINUX_IMPAIRMENT *impairment_ptr, ULONG probability)
+{
+
+    /* Do not draw for a disabled impairment, so enabling another one keeps the
+       decisions of those already set.  */
+    if (probability == 0)
+    {
+        return(NX_FALSE);
+    }
+
+    return(((_nx_linux_impairment_random(impairment_ptr) >> 11) % 1000000) < probability);
+}
+
+UINT _nx_linux_impairment_apply(NX_LINUX_INSTANCE *instance_ptr, NX_PACKET *packet_ptr, UINT direction)
+{
+TX_INTERRUPT_SAVE_AREA
+NX_LINUX_IMPAIRMENT *impairment_ptr = &instance_ptr -> nx_linux_instance_impairment[direction];
+NX_PACKET           *copy_ptr = NX_NULL;
+ULONG64              now;
+ULONG64              time;
+UINT                 drop;
+UINT                 duplicate = NX_FALSE;
+UINT                 hold;
+
+    if ((NX_LINUX_IMPAIRMENT_DIRECTIONS & (1 << direction)) == 0)
+    {
+        return(NX_FALSE);
+    }
+
+    now = _nx_linux_time_get();
+    time = now;
+
+    TX_DISABLE
+
+    /* Lose the frame at random, or in a burst.  */
+#if NX_LINUX_IMPAIRMENT_BURST_START > 0
+    if (impairment_ptr -> nx_linux_impairment_burst)
+    {
+        if (_nx_linux_impairment_chance(impairment_ptr, NX_LINUX_IMPAIRMENT_BURST_END))
+        {
+            impairment_ptr -> nx_linux_impairment_burst = NX_FALSE;
+        }
+    }
+    else if (_nx_linux_impairment_chance(impairment_ptr, NX_LINUX_IMPAIRMENT_BURST_START))
+    {
+        impairment_ptr -> nx_linux_impairment_burst = NX_TRUE;
+    }
+#endif /* NX_LINUX_IMPAIRMENT_BURST_START > 0 */
+    drop = impairment_ptr -> nx_linux_impairment_burst ||
+           _nx_linux_impairment_chance(impairment_ptr, NX_LINUX_IMPAIRMENT_LOSS);
+    if (drop)
+    {
+        impairment_ptr -> nx_linux_impairment_dropped++;
+    }
+    else
+    {
+        duplicate = _nx_linux_impairment_chance(impairment_ptr, NX_LINUX_IMPAIRMENT_DUPLICATE);
+
+#if NX_LINUX_IMPAIRMENT_RATE > 0
+        /* The frame leaves once the link has sent the frames before it.  */
+        if (impairment_ptr -> nx_linux_impairment_link_free > time)
+        {
+            time = impairment_ptr -> nx_linux_impairment_link_free;
+        }
+        time += (ULONG64)packet_ptr -> nx_packet_length * 8 * 1000000000 / NX_LINUX_IMPAIRMENT_RATE;
+        impairment_ptr -> nx_linux_impairment_link_free = time;
+#endif /* NX_LINUX_IMPAIRMENT_RATE > 0 */
+
+#if NX_LINUX_IMPAIRMENT_DELAY > 0
+        time += (ULONG64)NX_LINUX_IMPAIRMENT_DELAY * 1000;
+#if NX_LINUX_IMPAIRMENT_JITTER > 0
+        time = time - (ULONG64)NX_LINUX_IMPAIRMENT_JITTER * 1000 +
+               _nx_linux_impairment_random(impairment_ptr) % ((ULONG64)NX_LINUX_IMPAIRMENT_JITTER * 2000 + 1);
+#endif /* NX_LINUX_IMPAIRMENT_JITTER > 0 */
+#endif /* NX_LINUX_IMPAIRMENT_DELAY > 0 */
+
+        if (_nx_linux_impairment_chance(impairment_ptr, NX_LINUX_IMPAIRMENT_REORDER))
+        {
+            time += (ULONG64)NX_LINUX_IMPAIRMENT_REORDER_DELAY * 1000;
+        }
+    }
+
+    TX_RESTORE
+
+    if (drop)
+    {
+        _nx_linux_impairment_release(packet_ptr, direction);
+        return(NX_TRUE);
+    }
+
+    /* Copy the frame before it is held, as a held frame may be sent at any time.  */
+    if (duplicate)
+    {
+        if (nx_packet_copy(packet_ptr, &copy_ptr, instance_ptr -> nx_linux_instance_ip -> nx_ip_default_packet_pool,
+                           NX_NO_WAIT) == NX_SUCCESS)
+        {
+#ifdef NX_ENABLE_INTERFACE_CAPABILITY
+            copy_ptr -> nx_packet_interface_capability_flag = packet_ptr -> nx_packet_interface_capability_flag;
+#endif /* NX_ENABLE_INTERFACE_CAPABILITY */
+        }
+        else
+        {
+            copy_ptr = NX_NULL;
+        }
+    }
+
+    /* Hold the frame until it is due, and its copy right behind it.  */
+    hold = (time > now);
+
+    TX_DISABLE
+
+    if (hold)
+    {
+        if (instance_ptr -> nx_linux_instance_impairment_free)
+        {
+            _nx_linux_impairment_hold(instance_ptr, packet_ptr, direction, time);
+            impairment_ptr -> nx_linux_impairment_delayed++;
+            drop = NX_FALSE;
+        }
+        else
+        {
+            impairment_ptr -> nx_linux_impairment_overflows++;
+            drop = NX_TRUE;
+        }
+    }
+
+    if (copy_ptr && instance_ptr -> nx_linux_instance_impairment_free)
+    {
+        _nx_linux_impairment_hold(instance_ptr, copy_ptr, direction, time);
+        impairment_ptr -> nx_linux_impairment_duplicated++;
+        copy_ptr = NX_NULL;
+    }
+
+    TX_RESTORE
+
+    if (copy_ptr)
+    {
+        nx_packet_release(copy_ptr);
+    }
+
+    if (drop)
+    {
+        _nx_linux_impairment_release(packet_ptr, direction);
+    }
+
+    return(hold);
+}
+
+VOID _nx_linux_impairment_hold(NX_LINUX_INSTANCE *instance_ptr, NX_PACKET *packet_ptr, UINT direction, ULONG64 time)
+{
+NX_LINUX_IMPAIRMENT_ENTRY  *entry_ptr = instance_ptr -> nx_linux_instance_impairment_free;
+NX_LINUX_IMPAIRMENT_ENTRY **slot_ptr;
+ULONG64                     tick;
+
+    instance_ptr -> nx_linux_instance_impairment_free = entry_ptr -> nx_linux_impairment_entry_next;
+    entry_ptr -> nx_linux_impairment_entry_packet = packet_ptr;
+    entry_ptr -> nx_linux_impairment_entry_time = time;
+    entry_ptr -> nx_linux_impairment_entry_direction = direction;
+
+    /* A frame due in a tick the wheel has passed goes in the current slot.  */
+    tick = time / (NX_LINUX_IMPAIRMENT_TICK * 1000);
+    if (tick < instance_ptr -> nx_linux_instance_impairment_tick)
+    {
+        tick = instance_ptr -> nx_linux_instance_impairment_tick;
+    }
+
+    /* Insert it behind the frames due no later, so frames due together keep their order.  */
+    slot_ptr = &instance_ptr -> nx_linux_instance_impairment_wheel[tick & (NX_LINUX_IMPAIRMENT_WHEEL_SIZE - 1)];
+    while (*slot_ptr && ((*slot_ptr) -> nx_linux_impairment_entry_time <= time))
+    {
+        slot_ptr = &(*slot_ptr) -> nx_linux_impairment_entry_next;
+    }
+    entry_ptr -> nx_linux_impairment_entry_next = *slot_ptr;
+    *slot_ptr = entry_ptr;
+    instance_ptr -> nx_linux_instance_impairment_count++;
+
+    /* Wake the timer thread if it waits for a later frame.  The timer thread changes the
+       time too, so read it whole.  */
+    if (time < __atomic_load_n(&instance_ptr -> nx_linux_instance_impairment_next, __ATOMIC_ACQUIRE))
+    {
+        __atomic_store_n(&instance_ptr -> nx_linux_instance_impairment_next, time, __ATOMIC_RELEASE);
+        eventfd_write(nx_linux_impairment_event, 1);
+    }
+}
+
+VOID _nx_linux_impairment_release(NX_PACKET *packet_ptr, UINT direction)
+{
+
+    if (direction == NX_LINUX_IMPAIRMENT_RECEIVE)
+    {
+        nx_packet_release(packet_ptr);
+        return;
+    }
+
+    /* A lost frame has been sent as far as NetX is concerned.  */
+    packet_ptr -> nx_packet_prepend_ptr =  packet_ptr -> nx_packet_prepend_ptr + NX_ETHERNET_SIZE;
+    packet_ptr -> nx_packet_length =  packet_ptr -> nx_packet_length - NX_ETHERNET_SIZE;
+    nx_packet_transmit_release(packet_ptr);
+}
+
+VOID _nx_linux_impairment_process(NX_LINUX_INSTANCE *instance_ptr)
+{
+TX_INTERRUPT_SAVE_AREA
+NX_LINUX_IMPAIRMENT_ENTRY  *due_ptr = NX_NULL;
+NX_LINUX_IMPAIRMENT_ENTRY **due_tail_ptr = &due_ptr;
+NX_LINUX_IMPAIRMENT_ENTRY **slot_ptr;
+NX_LINUX_IMPAIRMENT_ENTRY  *entry_ptr;
+ULONG64                     now;
+ULONG64                     now_tick;
+ULONG64                     tick;
+ULONG64                     next = ~(ULONG64)0;
+UINT                        i;
+
+    now = _nx_linux_time_get();
+    now_tick = now / (NX_LINUX_IMPAIRMENT_TICK * 1000);
+
+    TX_DISABLE
+
+    /* Take the frames due from the slots passed since the last call, in order.  A
+       lap of the wheel visits every slot.  */
+    tick = instance_ptr -> nx_linux_instance_impairment_tick;
+    if ((now_tick - tick) >= NX_LINUX_IMPAIRMENT_WHEEL_SIZE)
+    {
+        tick = now_tick - NX_LINUX_IMPAIRMENT_WHEEL_SIZE + 1;
+    }
+    for (; instance_ptr -> nx_linux_instance_impairment_count && (tick <= now_tick); tick++)
+    {
+        slot_ptr = &instance_ptr -> nx_linux_instance_impairment_wheel[tick & (NX_LINUX_IMPAIRMENT_WHEEL_SIZE - 1)];
+        while (*slot_ptr && ((*slot_ptr) -> nx_linux_impairment_entry_time <= now))
+        {
+            entry_ptr = *slot_ptr;
+            *slot_ptr = entry_ptr -> nx_linux_impairment_entry_next;
+            entry_ptr -> nx_linux_impairment_entry_next = NX_NULL;
+            *due_tail_ptr = entry_ptr;
+            due_tail_ptr = &entry_ptr -> nx_linux_impairment_entry_next;
+            instance_ptr -> nx_linux_instance_impairment_count--;
+        }
+    }
+    instance_ptr -> nx_linux_instance_impairment_tick = now_tick;
+
+    /* Find the next frame due.  The first slot from now holding a frame of this lap
+       has it; frames of later laps are only candidates.  */
+    for (i = 0; instance_ptr -> nx_linux_instance_impairment_count && (i < NX_LINUX_IMPAIRMENT_WHEEL_SIZE); i++)
+    {
+        entry_ptr = instance_ptr -> nx_linux_instance_impairment_wheel[(now_tick + i) & (NX_LINUX_IMPAIRMENT_WHEEL_SIZE - 1)];
+        if (entry_ptr && (entry_ptr -> nx_linux_impairment_entry_time < next))
+        {
+            next = entry_ptr -> nx_linux_impairment_entry_time;
+            if ((next / (NX_LINUX_IMPAIRMENT_TICK * 1000)) <= now_tick + i)
+            {
+                break;
+            }
+        }
+    }
+    __atomic_store_n(&instance_ptr -> nx_linux_instance_impairment_next, next, __ATOMIC_RELEASE);
+
+    TX_RESTORE
+
+    /* The timer thread waits without a timeout once it has handed the due frames over, so
+       wake it to wait for the frames still held.  */
+    if (next != ~(ULONG64)0)
+    {
+        eventfd_write(nx_linux_impairment_event, 1);
+    }
+
+    if (due_ptr == NX_NULL)
+    {
+        return;
+    }
+
+    /* Send or receive the frames due.  */
+    for (entry_ptr = due_ptr; entry_ptr; entry_ptr = entry_ptr -> nx_linux_impairment_entry_next)
+    {
+        if (entry_ptr -> nx_linux_impairment_entry_direction == NX_LINUX_IMPAIRMENT_TRANSMIT)
+        {
+            _nx_linux_network_driver_output(instance_ptr, entry_ptr -> nx_linux_impairment_entry_packet);
+        }
+        else
+        {
+            _nx_linux_packet_dispatch(instance_ptr, entry_ptr -> nx_linux_impairment_entry_packet);
+        }
+    }
+
+    /* Return the entries to the free list.  */
+    TX_DISABLE
+    *due_tail_ptr = instance_ptr -> nx_linux_instance_impairment_free;
+    instance_ptr -> nx_linux_instance_impairment_free = due_ptr;
+    TX_RESTORE
+}
+
+void *_nx_linux_impairment_thread_entry(void *arg)
+{
+NX_LINUX_INSTANCE *instance_ptr;
+struct pollfd      poll_fd;
+struct timespec    timeout;
+eventfd_t          event;
+ULONG64            now;
+ULONG64            next;
+ULONG64            wait;
+UINT               i;
+
+    NX_PARAMETER_NOT_USED(arg);
+
+    poll_fd.fd = nx_linux_impairment_event;
+    poll_fd.events = POLLIN;
+
+    for (;;)
+    {
+        now = _nx_linux_time_get();
+        wait = ~(ULONG64)0;
+
+        for (i = 0; i < __atomic_load_n(&nx_linux_instance_count, __ATOMIC_ACQUIRE); i++)
+        {
+            instance_ptr = &nx_linux_instances[i];
+            next = __atomic_load_n(&instance_ptr -> nx_linux_instance_impairment_next, __ATOMIC_ACQUIRE);
+            if (next > now)
+            {
+                if ((next - now) < wait)
+                {
+                    wait = next - now;
+                }
+                continue;
+            }
+
+            /* Frames are due. Wake the IP thread, which sets the next time once it has
+               taken them.  Look again at once if a frame was held meanwhile.  */
+            if (__atomic_compare_exchange_n(&instance_ptr -> nx_linux_instance_impairment_next, &next, ~(ULONG64)0, 0,
+                                            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            {
+                _tx_thread_context_save();
+                _nx_ip_driver_deferred_processing(instance_ptr -> nx_linux_instance_ip);
+                _tx_thread_context_restore();
+            }
+            else
+            {
+                wait = 0;
+            }
+        }
+
+        /* Sleep until the next frame is due, or a frame is held that is due earlier.  */
+        poll_fd.revents = 0;
+        if (wait == ~(ULONG64)0)
+        {
+            ppoll(&poll_fd, 1, NX_NULL, NX_NULL);
+        }
+        else
+        {
+            timeout.tv_sec = (time_t)(wait / 1000000000);
+            timeout.tv_nsec = (long)(wait % 1000000000);
+            ppoll(&poll_fd, 1, &timeout, NX_NULL);
+        }
+        if (poll_fd.revents & POLLIN)
+        {
+            eventfd_read(nx_linux_impairment_event, &event);
+        }
+    }
+}
+#endif /* NX_LINUX_ENABLE_IMPAIRMENT */
+
+VOID _nx_linux_packet_receive(NX_LINUX_INSTANCE *instance_ptr, NX_PACKET *packet_ptr)
+{
+
+#ifdef NX_LINUX_ENABLE_CAPTURE
+    _nx_linux_capture(instance_ptr, packet_ptr, NX_LINUX_CAPTURE_INBOUND);
+#endif /* NX_LINUX_ENABLE_CAPTURE */
+
+#ifdef NX_LINUX_ENABLE_CHECKSUM_OFFLOAD
+    /* NetX skips the receive checksums of this interface, so check the frames
+       the kernel did not validate.  */
+    if (((packet_ptr -> nx_packet_interface_capability_flag & NX_INTERFACE_RX_CAPABILITY) == 0) &&
+        _nx_linux_checksum_verify(packet_ptr))
+    {
+        NX_LINUX_STATISTICS_ADD(instance_ptr, rx_checksum_drops, 1);
+        nx_packet_release(packet_ptr);
+        return;
+    }
+    packet_ptr -> nx_packet_interface_capability_flag = 0;
+#endif /* NX_LINUX_ENABLE_CHECKSUM_OFFLOAD */
+
+#ifdef NX_LINUX_ENABLE_IMPAIRMENT
+    /* Drop or hold back the frame as configured.  */
+    if (_nx_linux_impairment_apply(instance_ptr, packet_ptr, NX_LINUX_IMPAIRMENT_RECEIVE))
+    {
+        return;
+    }
+#endif /* NX_LINUX_ENABLE_IMPAIRMENT */
+
+    _nx_linux_packet_dispatch(instance_ptr, packet_ptr);
+}
+
+VOID _nx_linux_packet_dispatch(NX_LINUX_INSTANCE *instance_ptr, NX_PACKET *packet_ptr)
+{
+UINT packet_type;
+
+    /* Pickup the packet header to determine where the packet needs to be sent.  */
+    packet_type =  (((UINT)(*(packet_ptr -> nx_packet_prepend_ptr + 12))) << 8) |
+                    ((UINT)(*(packet_ptr -> nx_packet_prepend_ptr + 13)));
+
+    /* Route the incoming packet according to its ethernet type.  */
+    if ((packet_type == NX_ETHERNET_IP) || (packet_type == NX_ETHERNET_IPV6))
+    {
+
+        /* Note:  The length reported by some Ethernet hardware includes bytes after the packet
+           as well as the Ethernet header.  In some cases, the actual packet length after the
+           Ethernet header should be derived from the length in the IP header (lower 16 bits of
+           the first 32-bit word).  */
+
+#ifdef NX_LINUX_ENABLE_GSO
+        if (instance_ptr -> nx_linux_instance_vnet_socket >= 0)
+        {
+
+            /* Let NetX build segments the kernel splits on transmit.  */
+            _nx_linux_gso_mss_update(packet_ptr);
+        }
+#endif /* NX_LINUX_ENABLE_GSO */
+
+        /* Clean off the Ethernet header.  */
+        packet_ptr -> nx_packet_prepend_ptr =  packet_ptr -> nx_packet_prepend_ptr + NX_ETHERNET_SIZE;
+
+        /* Adjust the packet length.  */
+        packet_ptr -> nx_packet_length =  packet_ptr -> nx_packet_length - NX_ETHERNET_SIZE;
+
+        _nx_ip_packet_deferred_receive(instance_ptr -> nx_linux_instance_ip, packet_ptr);
+    }
+    else if (packet_type == NX_ETHERNET_ARP)
+    {
+
+        /* Clean off the Ethernet header.  */
+        packet_ptr -> nx_packet_prepend_ptr =  packet_ptr -> nx_packet_prepend_ptr + NX_ETHERNET_SIZE;
+
+        /* Adjust the packet length.  */
+        packet_ptr -> nx_packet_length =  packet_ptr -> nx_packet_length - NX_ETHERNET_SIZE;
+
+        _nx_arp_packet_deferred_receive(instance_ptr -> nx_linux_instance_ip, packet_ptr);
+    }
+    else if (packet_type == NX_ETHERNET_RARP)
+    {
+
+        /* Clean off the Ethernet header.  */
+        packet_ptr -> nx_packet_prepend_ptr =  packet_ptr -> nx_packet_prepend_ptr + NX_ETHERNET_SIZE;
+
+        /* Adjust the packet length.  */
+        packet_ptr -> nx_packet_length =  packet_ptr -> nx_packet_length - NX_ETHERNET_SIZE;
+
+        _nx_rarp_packet_deferred_receive(instance_ptr -> nx_linux_instance_ip, packet_ptr);
+    }
+#ifdef NX_ENABLE_PPPOE
+    else if ((packet_type == NX_ETHERNET_PPPOE_DISCOVERY) ||
+             (packet_type == NX_ETHERNET_PPPOE_SESSION))
+    {
+
+        /* Clean off the Ethernet header.  */
+        packet_ptr -> nx_packet_prepend_ptr =  packet_ptr -> nx_packet_prepend_ptr + NX_ETHERNET_SIZE;
+
+        /* Adjust the packet length.  */
+        packet_ptr -> nx_packet_length =  packet_ptr -> nx_packet_length - NX_ETHERNET_SIZE;
+
+        /* Route to the PPPoE receive function.  */
+        _nx_pppoe_packet_deferred_receive(packet_ptr);
+    }
+#endif
+    else
+    {
+
+        /* Invalid ethernet header... release the packet.  */
+        NX_LINUX_STATISTICS_ADD(instance_ptr, rx_type_drops, 1);
+        nx_packet_release(packet_ptr);
+    }
+}
+
+#ifdef NX_LINUX_ENABLE_GRO
+UINT _nx_linux_gro_header_get(NX_PACKET *packet_ptr, ULONG *header_length, ULONG *data_length)
+{
+UCHAR *ip_ptr = packet_ptr -> nx_packet_prepend_ptr + NX_ETHERNET_SIZE;
+UCHAR *tcp_ptr;
+ULONG  ip_header_length;
+ULONG  frame_length;
+UINT   packet_type;
+
+    if (packet_ptr -> nx_packet_append_ptr - packet_ptr -> nx_packet_prepend_ptr < NX_ETHERNET_SIZE + 20)
+    {
+        return(NX_NOT_SUCCESSFUL);
+    }
+
+    /* Only plain IPv4 datagrams and IPv6 packets without extension headers carry TCP here.  */
+    packet_type = ((UINT)packet_ptr -> nx_packet_prepend_ptr[12] << 8) | packet_ptr -> nx_packet_prepend_ptr[13];
+    if ((packet_type == NX_ETHERNET_IP) && (ip_ptr[0] == 0x45) && (ip_ptr[9] == IPPROTO_TCP) &&
+        ((ip_ptr[6] & 0x3F) == 0) && (ip_ptr[7] == 0))
+    {
+        ip_header_length = 20;
+        frame_length = NX_ETHERNET_SIZE + (((ULONG)ip_ptr[2] << 8) | ip_ptr[3]);
+    }
+    else if ((packet_type == NX_ETHERNET_IPV6) && ((ip_ptr[0] >> 4) == 6) && (ip_ptr[6] == IPPROTO_TCP))
+    {
+        ip_header_length = 40;
+        frame_length = NX_ETHERNET_SIZE + 40 + (((ULONG)ip_ptr[4] << 8) | ip_ptr[5]);
+    }
+    else
+    {
+        return(NX_NOT_SUCCESSFUL);
+    }
+
+    /* Only merge segments that carry nothing but an acknowledgment, data and possibly a push.  */
+    tcp_ptr = ip_ptr + ip_header_length;
+    if ((tcp_ptr + 20 > packet_ptr -> nx_packet_append_ptr) || ((tcp_ptr[13] & 0xF7) != 0x10))
+    {
+        return(NX_NOT_SUCCESSFUL);
+    }
+
+    *header_length = NX_ETHERNET_SIZE + ip_header_length + (ULONG)(tcp_ptr[12] >> 4) * 4;
+    if ((*header_length >= frame_length) || (frame_length > packet_ptr -> nx_packet_length) ||
+        (packet_ptr -> nx_packet_prepend_ptr + *header_length > packet_ptr -> nx_packet_append_ptr))
+    {
+        return(NX_NOT_SUCCESSFUL);
+    }
+
+    /* Drop the Ethernet padding, which only short frames have.  */
+    if (frame_length < packet_ptr -> nx_packet_length)
+    {
+        if (packet_ptr -> nx_packet_next)
+        {
+            return(NX_NOT_SUCCESSFUL);
+        }
+        packet_ptr -> nx_packet_append_ptr = packet_ptr -> nx_packet_prepend_ptr + frame_length;
+        packet_ptr -> nx_packet_length = frame_length;
+    }
+
+    *data_length = frame_length - *header_length;
+    return(NX_SUCCESS);
+}
+
+UINT _nx_linux_gro_match(NX_PACKET *held_ptr, NX_PACKET *packet_ptr, ULONG header_length)
+{
+UCHAR *held_ip_ptr = held_ptr -> nx_packet_prepend_ptr + NX_ETHERNET_SIZE;
+UCHAR *ip_ptr = packet_ptr -> nx_packet_prepend_ptr + NX_ETHERNET_SIZE;
+UCHAR *held_tcp_ptr;
+UCHAR *tcp_ptr;
+ULONG  ip_header_length;
+ULONG  sequence;
+
+    /* The held packet has the same header layout if the headers are as long.  */
+    if ((held_ptr -> nx_packet_prepend_ptr[12] != packet_ptr -> nx_packet_prepend_ptr[12]) ||
+        (held_ptr -> nx_packet_prepend_ptr[13] != packet_ptr -> nx_packet_prepend_ptr[13]))
+    {
+        return(NX_NOT_SUCCESSFUL);
+    }
+
+    if (packet_ptr -> nx_packet_prepend_ptr[12] == (NX_ETHERNET_IP >> 8))
+    {
+        ip_header_length = 20;
+
+        /* Compare the type of service, TTL and addresses.  */
+        if ((held_ip_ptr[1] != ip_ptr[1]) || (held_ip_ptr[8] != ip_ptr[8]) ||
+            memcmp(held_ip_ptr + 12, ip_ptr + 12, 8))
+        {
+            return(NX_NOT_SUCCESSFUL);
+        }
+    }
+    else
+    {
+        ip_header_length = 40;
+
+        /* Compare the traffic class, flow label, hop limit and addresses.  */
+        if (memcmp(held_ip_ptr, ip_ptr, 4) || (held_ip_ptr[7] != ip_ptr[7]) ||
+            memcmp(held_ip_ptr + 8, ip_ptr + 8, 32))
+        {
+            return(NX_NOT_SUCCESSFUL);
+        }
+    }
+
+    held_tcp_ptr = held_ip_ptr + ip_header_length;
+    tcp_ptr = ip_ptr + ip_header_length;
+    if (held_tcp_ptr[12] != tcp_ptr[12])
+    {
+        return(NX_NOT_SUCCESSFUL);
+    }
+
+    /* The segment must follow the held data directly.  */
+    sequence = (((ULONG)held_tcp_ptr[4] << 24) | ((ULONG)held_tcp_ptr[5] << 16) |
+                ((ULONG)held_tcp_ptr[6] << 8) | held_tcp_ptr[7]) +
+               (held_ptr -> nx_packet_length - header_length);
+    if ((tcp_ptr[4] != (UCHAR)(sequence >> 24)) || (tcp_ptr[5] != (UCHAR)(sequence >> 16)) ||
+        (tcp_ptr[6] != (UCHAR)(sequence >> 8)) || (tcp_ptr[7] != (UCHAR)sequence))
+    {
+        return(NX_NOT_SUCCESSFUL);
+    }
+
+    /* Ports, acknowledgment, window and options must be the same. A push may
+       only end the merged packet.  */
+    if (memcmp(held_tcp_ptr, tcp_ptr, 4) || memcmp(held_tcp_ptr + 8, tcp_ptr + 8, 5) ||
+        (held_tcp_ptr[13] != (tcp_ptr[13] & 0xF7)) || memcmp(held_tcp_ptr + 14, tcp_ptr + 14, 2) ||
+        memcmp(held_tcp_ptr + 20, tcp_ptr + 20, header_length - NX_ETHERNET_SIZE - ip_header_length - 20))
+    {
+        return(NX_NOT_SUCCESSFUL);
+    }
+
+    return(NX_SUCCESS);
+}
+
+VOID _nx_linux_gro_receive(NX_LINUX_RECEIVE_QUEUE *queue_ptr, NX_PACKET *packet_ptr)
+{
+NX_LINUX_INSTANCE *instance_ptr = queue_ptr -> nx_linux_receive_queue_instance;
+NX_PACKET         *held_ptr = queue_ptr -> nx_linux_receive_queue_gro_packet;
+NX_PACKET         *last_ptr;
+UCHAR             *ip_ptr;
+UCHAR             *tcp_ptr;
+ULONG              ip_header_length;
+ULONG              header_length;
+ULONG              data_length;
+ULONG              sum;
+UINT               push;
+
+    /* Check the segment now, as a merged packet keeps the checksum of its first
+       segment only.  */
+    if ((packet_ptr -> nx_packet_interface_capability_flag & NX_INTERFACE_RX_CAPABILITY) == 0)
+    {
+        if (_nx_linux_checksum_verify(packet_ptr))
+        {
+            NX_LINUX_STATISTICS_ADD(queue_ptr -> nx_linux_receive_queue_instance, rx_checksum_drops, 1);
+            nx_packet_release(packet_ptr);
+            return;
+        }
+        packet_ptr -> nx_packet_interface_capability_flag = NX_INTERFACE_RX_CAPABILITY;
+    }
+
+    if (_nx_linux_gro_header_get(packet_ptr, &header_length, &data_length))
+    {
+
+        /* Not a data segment. Deliver it behind the held packet to keep the order.  */
+        _nx_linux_gro_flush(queue_ptr);
+        _nx_linux_packet_receive(instance_ptr, packet_ptr);
+        return;
+    }
+
+    if ((held_ptr == NX_NULL) || (held_ptr -> nx_packet_length + data_length > 0xFFFF) ||
+        _nx_linux_gro_match(held_ptr, packet_ptr, header_length))
+    {
+
+        /* Start a new packet with this segment.  */
+        _nx_linux_gro_flush(queue_ptr);
+        queue_ptr -> nx_linux_receive_queue_gro_packet = packet_ptr;
+        queue_ptr -> nx_linux_receive_queue_gro_segments = 1;
+        return;
+    }
+
+    ip_header_length = (packet_ptr -> nx_packet_prepend_ptr[12] == (NX_ETHERNET_IP >> 8)) ? 20 : 40;
+    push = packet_ptr -> nx_packet_prepend_ptr[NX_ETHERNET_SIZE + ip_header_length + 13] & 0x08;
+
+    /* Chain the payload of the segment behind the held data.  */
+    packet_ptr -> nx_packet_prepend_ptr += header_length;
+    last_ptr = held_ptr -> nx_packet_last ? held_ptr -> nx_packet_last : held_ptr;
+    last_ptr -> nx_packet_next = packet_ptr;
+    held_ptr -> nx_packet_last = packet_ptr -> nx_packet_last ? packet_ptr -> nx_packet_last : packet_ptr;
+    packet_ptr -> nx_packet_last = NX_NULL;
+    held_ptr -> nx_packet_length += data_length;
+
+    /* Update the IP length, and the header checksum of IPv4.  */
+    ip_ptr = held_ptr -> nx_packet_prepend_ptr + NX_ETHERNET_SIZE;
+    if (ip_header_length == 20)
+    {
+        ip_ptr[2] = (UCHAR)((held_ptr -> nx_packet_length - NX_ETHERNET_SIZE) >> 8);
+        ip_ptr[3] = (UCHAR)(held_ptr -> nx_packet_length - NX_ETHERNET_SIZE);
+        ip_ptr[10] = 0;
+        ip_ptr[11] = 0;
+        sum = ~_nx_linux_checksum_add(ip_ptr, 20, 0);
+        ip_ptr[10] = (UCHAR)(sum >> 8);
+        ip_ptr[11] = (UCHAR)sum;
+    }
+    else
+    {
+        ip_ptr[4] = (UCHAR)((held_ptr -> nx_packet_length - NX_ETHERNET_SIZE - 40) >> 8);
+        ip_ptr[5] = (UCHAR)(held_ptr -> nx_packet_length - NX_ETHERNET_SIZE - 40);
+    }
+
+    queue_ptr -> nx_linux_receive_queue_gro_segments++;
+    nx_linux_gro_merged_count++;
+
+    /* A push ends the merged packet.  */
+    if (push)
+    {
+        tcp_ptr = ip_ptr + ip_header_length;
+        tcp_ptr[13] |= 0x08;
+        _nx_linux_gro_flush(queue_ptr);
+    }
+}
+
+VOID _nx_linux_gro_flush(NX_LINUX_RECEIVE_QUEUE *queue_ptr)
+{
+NX_LINUX_INSTANCE *instance_ptr = queue_ptr -> nx_linux_receive_queue_instance;
+NX_PACKET         *packet_ptr = queue_ptr -> nx_linux_receive_queue_gro_packet;
+
+    if (packet_ptr == NX_NULL)
+    {
+        return;
+    }
+
+    queue_ptr -> nx_linux_receive_queue_gro_packet = NX_NULL;
+    if (queue_ptr -> nx_linux_receive_queue_gro_segments > 1)
+    {
+        nx_linux_gro_packet_count++;
+    }
+
+    _nx_linux_packet_receive(instance_ptr, packet_ptr);
+}
+#endif /* NX_LINUX_ENABLE_GRO */
+
+UINT _nx_linux_receive_packets_allocate(NX_LINUX_INSTANCE *instance_ptr, NX_PACKET **packets, struct iovec *vectors)
+{
+NX_PACKET_POOL *pool_ptr = instance_ptr -> nx_linux_instance_ip -> nx_ip_default_packet_pool;
+ULONG           packets_needed;
+ULONG           remaining = NX_LINK_MTU;
+ULONG           length;
+UCHAR          *data;
+UINT            packet_count;
+
+    /* Check the pool before allocating, so a frame that cannot be held is
+       dropped without taking any packet.  The first packet loses 2 bytes to
+       keep the IP header 4-byte aligned.  */
+    packets_needed = (NX_LINK_MTU + 2 + pool_ptr -> nx_packet_pool_payload_size - 1) / pool_ptr -> nx_packet_pool_payload_size;
+    if (packets_needed > NX_LINUX_RECEIVE_VECTOR_COUNT)
+    {
+        packets_needed = NX_LINUX_RECEIVE_VECTOR_COUNT;
+    }
+    if (pool_ptr -> nx_packet_pool_available < packets_needed)
+    {
+        return(0);
+    }
+
+    /* Allocate the packets and point one receive vector at each payload.  */
+    for (packet_count = 0; (remaining > 0) && (packet_count < NX_LINUX_RECEIVE_VECTOR_COUNT); packet_count++)
+    {
+        if (nx_packet_allocate(pool_ptr, &packets[packet_count], NX_RECEIVE_PACKET, NX_NO_WAIT))
+        {
+            while (packet_count)
+            {
+                nx_packet_release(packets[--packet_count]);
+            }
+            return(0);
+        }
+
+        data = packets[packet_count] -> nx_packet_prepend_ptr;
+        if (packet_count == 0)
+        {
+
+            /* Make sure IP header is 4-byte aligned. */
+            data += 2;
+        }
+
+        length = (ULONG)(packets[packet_count] -> nx_packet_data_end - data);
+        if (length > remaining)
+        {
+            length = remaining;
+        }
+
+        vectors[packet_count].iov_base = data;
+        vectors[packet_count].iov_len = length;
+        remaining -= length;
+    }
+
+    return(packet_count);
+}
+
+NX_PACKET *_nx_linux_receive_packets_build(NX_LINUX_INSTANCE *instance_ptr, NX_PACKET **packets, struct iovec *vectors,
+                                           UINT packet_count, int bytes_received, int flags)
+{
+NX_PACKET *packet_ptr = packets[0];
+ULONG      remaining;
+ULONG      length;
+UINT       i;
+
+    if ((bytes_received <= 0) || (flags & MSG_TRUNC) ||
+        !_nx_linux_frame_check(instance_ptr, (UCHAR *)vectors[0].iov_base, (ULONG)bytes_received))
+    {
+
+        /* Nothing was received, the frame did not fit, it is not an Ethernet header,
+           or it is not for us.  */
+#ifdef NX_LINUX_ENABLE_STATISTICS
+        if ((bytes_received > 0) && (flags & MSG_TRUNC))
+        {
+            NX_LINUX_STATISTICS_ADD(instance_ptr, rx_frames, 1);
+            NX_LINUX_STATISTICS_ADD(instance_ptr, rx_truncated_drops, 1);
+        }
+#endif /* NX_LINUX_ENABLE_STATISTICS */
+        for (i = 0; i < packet_count; i++)
+        {
+            nx_packet_release(packets[i]);
+        }
+        return(NX_NULL);
+    }
+
+    /* Trim each packet to the data it received and chain the ones in use.  */
+    remaining = (ULONG)bytes_received;
+    for (i = 0; i < packet_count; i++)
+    {
+        if (remaining == 0)
+        {
+            nx_packet_release(packets[i]);
+            continue;
+        }
+
+        length = vectors[i].iov_len;
+        if (length > remaining)
+        {
+            length = remaining;
+        }
+
+        packets[i] -> nx_packet_prepend_ptr = (UCHAR *)vectors[i].iov_base;
+        packets[i] -> nx_packet_append_ptr = packets[i] -> nx_packet_prepend_ptr + length;
+        remaining -= length;
+
+#ifndef NX_DISABLE_PACKET_CHAIN
+        if (i > 0)
+        {
+            packets[i - 1] -> nx_packet_next = packets[i];
+            packet_ptr -> nx_packet_last = packets[i];
+        }
+#endif /* NX_DISABLE_PACKET_CHAIN */
+    }
+
+    packet_ptr -> nx_packet_length = (ULONG)bytes_received;
+
+    return(packet_ptr);
+}
+
+VOID _nx_linux_receive_frame(NX_LINUX_RECEIVE_QUEUE *queue_ptr)
+{
+NX_LINUX_INSTANCE       *instance_ptr = queue_ptr -> nx_linux_receive_queue_instance;
+NX_PACKET               *packets[NX_LINUX_RECEIVE_VECTOR_COUNT];
+struct iovec             vectors[NX_LINUX_RECEIVE_VECTOR_COUNT];
+struct msghdr            message;
+NX_PACKET               *packet_ptr;
+UINT                     packet_count;
+int                      bytes_received;
+#ifdef NX_LINUX_ENABLE_CHECKSUM_OFFLOAD
+NX_LINUX_AUXDATA_CONTROL control;
+#endif /* NX_LINUX_ENABLE_CHECKSUM_OFFLOAD */
+
+    packet_count = _nx_linux_receive_packets_allocate(instance_ptr, packets, vectors);
+
+    if (packet_count == 0)
+    {
+
+        /* No packet available. Drop the frame without copying it.  */
+        if (recv(queue_ptr -> nx_linux_receive_queue_socket, NX_NULL, 0, MSG_TRUNC | MSG_DONTWAIT) >= 0)
+        {
+            NX_LINUX_STATISTICS_ADD(instance_ptr, rx_frames, 1);
+            NX_LINUX_STATISTICS_ADD(instance_ptr, allocation_errors, 1);
+        }
+        NX_LINUX_STATISTICS_ADD(instance_ptr, rx_syscalls, 1);
+        return;
+    }
+
+    /* Receive the frame straight into the packet payloads.  */
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = vectors;
+    message.msg_iovlen = packet_count;
+#ifdef NX_LINUX_ENABLE_CHECKSUM_OFFLOAD
+    message.msg_control = &control;
+    message.msg_controllen = sizeof(control);
+#endif /* NX_LINUX_ENABLE_CHECKSUM_OFFLOAD */
+    bytes_received = recvmsg(queue_ptr -> nx_linux_receive_queue_socket, &message, MSG_DONTWAIT);
+    NX_LINUX_STATISTICS_ADD(instance_ptr, rx_syscalls, 1);
+
+    packet_ptr = _nx_linux_receive_packets_build(instance_ptr, packets, vectors, packet_count, bytes_received, message.msg_flags);
+    if (packet_ptr)
+    {
+#ifdef NX_LINUX_ENABLE_CHECKSUM_OFFLOAD
+        _nx_linux_receive_status_set(packet_ptr, _nx_linux_receive_status_get(&message));
+#endif /* NX_LINUX_ENABLE_CHECKSUM_OFFLOAD */
+        _nx_linux_packet_receive(instance_ptr, packet_ptr);
+    }
+}
+
+#if NX_LINUX_RECEIVE_BATCH_SIZE > 1
+UINT _nx_linux_receive_slots_fill(NX_LINUX_RECEIVE_QUEUE *queue_ptr, UINT slot_count)
+{
+NX_LINUX_INSTANCE *instance_ptr = queue_ptr -> nx_linux_receive_queue_instance;
+struct mmsghdr    *messages = queue_ptr -> nx_linux_receive_queue_messages;
+UINT               i;
+
+    for (i = 0; i < slot_count; i++)
+    {
+
+        /* Slots keep their packets across calls, so only the ones the last
+           recvmmsg() consumed are allocated again.  */
+        if (queue_ptr -> nx_linux_receive_queue_packet_count[i] == 0)
+        {
+            queue_ptr -> nx_linux_receive_queue_packet_count[i] =
+                _nx_linux_receive_packets_allocate(instance_ptr, queue_ptr -> nx_linux_receive_queue_packets[i],
+                                                   queue_ptr -> nx_linux_receive_queue_vectors[i]);
+            if (queue_ptr -> nx_linux_receive_queue_packet_count[i] == 0)
+            {
+                NX_LINUX_STATISTICS_ADD(instance_ptr, allocation_errors, 1);
+                break;
+            }
+        }
+
+        /* Reset the message header, since the kernel updates it on receive.  */
+        memset(&messages[i], 0, sizeof(struct mmsghdr));
+        messages[i].msg_hdr.msg_iov = queue_ptr -> nx_linux_receive_queue_vectors[i];
+        messages[i].msg_hdr.msg_iovlen = queue_ptr -> nx_linux_receive_queue_packet_count[i];
+#ifdef NX_LINUX_ENABLE_CHECKSUM_OFFLOAD
+        messages[i].msg_hdr.msg_control = &queue_ptr -> nx_linux_receive_queue_control[i];
+        messages[i].msg_hdr.msg_controllen = sizeof(NX_LINUX_AUXDATA_CONTROL);
+#endif /* NX_LINUX_ENABLE_CHECKSUM_OFFLOAD */
+    }
+
+    return(i);
+}
+
+NX_PACKET *_nx_linux_receive_slot_build(NX_LINUX_RECEIVE_QUEUE *queue_ptr, UINT slot)
+{
+NX_PACKET *packet_ptr;
+
+    /* The packets of the slot now belong to the frame, or are released with it.  */
+    packet_ptr = _nx_linux_receive_packets_build(queue_ptr -> nx_linux_receive_queue_instance,
+                                                 queue_ptr -> nx_linux_receive_queue_packets[slot],
+                                                 queue_ptr -> nx_linux_receive_queue_vectors[slot],
+                                                 queue_ptr -> nx_linux_receive_queue_packet_count[slot],
+                                                 (int)queue_ptr -> nx_linux_receive_queue_messages[slot].msg_len,
+                                                 queue_ptr -> nx_linux_receive_queue_messages[slot].msg_hdr.msg_flags);
+    queue_ptr -> nx_linux_receive_queue_packet_count[slot] = 0;
+#ifdef NX_LINUX_ENABLE_CHECKSUM_OFFLOAD
+    if (packet_ptr)
+    {
+        _nx_linux_receive_status_set(packet_ptr, _nx_linux_receive_status_get(&queue_ptr -> nx_linux_receive_queue_messages[slot].msg_hdr));
+    }
+#endif /* NX_LINUX_ENABLE_CHECKSUM_OFFLOAD */
+
+    return(packet_ptr);
+}
+
+VOID _nx_linux_receive_batch(NX_LINUX_RECEIVE_QUEUE *queue_ptr)
+{
+NX_LINUX_INSTANCE *instance_ptr = queue_ptr -> nx_linux_receive_queue_instance;
+NX_PACKET         *packet_ptr;
+UINT               frame_count;
+UINT               i;
+int                frames_received;
+
+#ifdef NX_LINUX_ENABLE_GRO
+    NX_PARAMETER_NOT_USED(instance_ptr);
+#endif /* NX_LINUX_ENABLE_GRO */
+
+    /* Make sure the batch slots hold packets the receive vectors point into.  */
+    frame_count = _nx_linux_receive_slots_fill(queue_ptr, NX_LINUX_RECEIVE_BATCH_SIZE);
+
+    if (frame_count == 0)
+    {
+
+        /* No packet available. Drop one frame without copying it.  The failed
+           allocation has been counted above.  */
+        if (recv(queue_ptr -> nx_linux_receive_queue_socket, NX_NULL, 0, MSG_TRUNC | MSG_DONTWAIT) >= 0)
+        {
+            NX_LINUX_STATISTICS_ADD(instance_ptr, rx_frames, 1);
+        }
+        NX_LINUX_STATISTICS_ADD(instance_ptr, rx_syscalls, 1);
+        nx_linux_receive_batch_count[0]++;
+        return;
+    }
+
+    /* Drain as many frames as are queued on the socket, up to the number of slots.  */
+    frames_received = recvmmsg(queue_ptr -> nx_linux_receive_queue_socket, queue_ptr -> nx_linux_receive_queue_messages,
+                               frame_count, MSG_DONTWAIT, NX_NULL);
+    NX_LINUX_STATISTICS_ADD(instance_ptr, rx_syscalls, 1);
+    if (frames_received < 0)
+    {
+        frames_received = 0;
+    }
+    nx_linux_receive_batch_count[frames_received]++;
+
+    /* Slots past the frames received keep their packets for the next call.  */
+    for (i = 0; i < (UINT)frames_received; i++)
+    {
+        packet_ptr = _nx_linux_receive_slot_build(queue_ptr, i);
+        if (packet_ptr)
+        {
+#ifdef NX_LINUX_ENABLE_GRO
+            _nx_linux_gro_receive(queue_ptr, packet_ptr);
+#else
+            _nx_linux_packet_receive(instance_ptr, packet_ptr);
+#endif /* NX_LINUX_ENABLE_GRO */
+        }
+    }
+
+#ifdef NX_LINUX_ENABLE_GRO
+    /* Hand the last merged packet of the batch to NetX.  */
+    _nx_linux_gro_flush(queue_ptr);
+#endif /* NX_LINUX_ENABLE_GRO */
+}
+#endif /* NX_LINUX_RECEIVE_BATCH_SIZE > 1 */
+
+#ifdef NX_LINUX_ENABLE_RX_RING
+UINT _nx_linux_rx_ring_create(NX_LINUX_RECEIVE_QUEUE *queue_ptr)
+{
+int                version = TPACKET_V3;
+struct tpacket_req3 req;
+VOID              *ring;
+
+    if (setsockopt(queue_ptr -> nx_linux_receive_queue_socket, SOL_PACKET, PACKET_VERSION, &version, sizeof(version)) < 0)
+    {
+        return(NX_NOT_SUCCESSFUL);
+    }
+
+    memset(&req, 0, sizeof(req));
+    req.tp_block_size = NX_LINUX_RX_RING_BLOCK_SIZE;
+    req.tp_block_nr = NX_LINUX_RX_RING_BLOCK_COUNT;
+    req.tp_frame_size = NX_LINUX_RX_RING_FRAME_SIZE;
+    req.tp_frame_nr = (NX_LINUX_RX_RING_BLOCK_SIZE / NX_LINUX_RX_RING_FRAME_SIZE) * NX_LINUX_RX_RING_BLOCK_COUNT;
+    req.tp_retire_blk_tov = NX_LINUX_RX_RING_RETIRE_TIMEOUT;
+    if (setsockopt(queue_ptr -> nx_linux_receive_queue_socket, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) < 0)
+    {
+        return(NX_NOT_SUCCESSFUL);
+    }
+
+    ring = mmap(NX_NULL, (size_t)NX_LINUX_RX_RING_BLOCK_SIZE * NX_LINUX_RX_RING_BLOCK_COUNT,
+                PROT_READ | PROT_WRITE, MAP_SHARED, queue_ptr -> nx_linux_receive_queue_socket, 0);
+    if (ring == MAP_FAILED)
+    {
+
+        /* Release the ring so the socket can be used with recvfrom().  */
+        memset(&req, 0, sizeof(req));
+        setsockopt(queue_ptr -> nx_linux_receive_queue_socket, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req));
+        return(NX_NOT_SUCCESSFUL);
+    }
+
+    queue_ptr -> nx_linux_receive_queue_ring = (UCHAR *)ring;
+    queue_ptr -> nx_linux_receive_queue_ring_block = 0;
+
+    return(NX_SUCCESS);
+}
+
+VOID _nx_linux_receive_ring_block(NX_LINUX_RECEIVE_QUEUE *queue_ptr, struct tpacket_block_desc *block_ptr)
+{
+NX_LINUX_INSTANCE   *instance_ptr = queue_ptr -> nx_linux_receive_queue_instance;
+NX_PACKET_POOL      *pool_ptr = instance_ptr -> nx_linux_instance_ip -> nx_ip_default_packet_pool;
+struct tpacket3_hdr *frame_ptr;
+NX_PACKET           *packet_ptr;
+UINT                 frame_count;
+UINT                 i;
+
+    frame_count = block_ptr -> hdr.bh1.num_pkts;
+    frame_ptr = (struct tpacket3_hdr *)((UCHAR *)block_ptr + block_ptr -> hdr.bh1.offset_to_first_pkt);
+
+    for (i = 0; i < frame_count; i++)
+    {
+
+        /* Drop frames that are too short to carry an Ethernet header, that are not
+           for us, or for which no packet is available.  */
+        if (_nx_linux_frame_check(instance_ptr, (UCHAR *)frame_ptr + frame_ptr -> tp_mac, frame_ptr -> tp_snaplen))
+        {
+            if (nx_packet_allocate(pool_ptr, &packet_ptr, NX_RECEIVE_PACKET, NX_NO_WAIT))
+            {
+                NX_LINUX_STATISTICS_ADD(instance_ptr, allocation_errors, 1);
+            }
+            else
+            {
+
+                /* Make sure IP header is 4-byte aligned. */
+                packet_ptr -> nx_packet_prepend_ptr += 2;
+                packet_ptr -> nx_packet_append_ptr += 2;
+
+                /* Copy the frame from the ring into the packet, chaining if the payload is small.  */
+                if (nx_packet_data_append(packet_ptr, (UCHAR *)frame_ptr + frame_ptr -> tp_mac,
+                                          frame_ptr -> tp_snaplen, pool_ptr, NX_NO_WAIT))
+                {
+                    NX_LINUX_STATISTICS_ADD(instance_ptr, allocation_errors, 1);
+                    nx_packet_release(packet_ptr);
+                }
+                else
+                {
+#ifdef NX_LINUX_ENABLE_CHECKSUM_OFFLOAD
+                    _nx_linux_receive_status_set(packet_ptr, frame_ptr -> tp_status);
+#endif /* NX_LINUX_ENABLE_CHECKSUM_OFFLOAD */
+#ifdef NX_LINUX_ENABLE_GRO
+                    _nx_linux_gro_receive(queue_ptr, packet_ptr);
+#else
+                    _nx_linux_packet_receive(instance_ptr, packet_ptr);
+#endif /* NX_LINUX_ENABLE_GRO */
+                }
+            }
+        }
+
+        frame_ptr = (struct tpacket3_hdr *)((UCHAR *)frame_ptr + frame_ptr -> tp_next_offset);
+    }
+
+#ifdef NX_LINUX_ENABLE_GRO
+    /* Hand the last merged packet of the block to NetX.  */
+    _nx_linux_gro_flush(queue_ptr);
+#endif /* NX_LINUX_ENABLE_GRO */
+
+    /* Return the block to the kernel.  */
+    __sync_synchronize();
+    block_ptr -> hdr.bh1.block_status = TP_STATUS_KERNEL;
+
+    queue_ptr -> nx_linux_receive_queue_ring_block = (queue_ptr -> nx_linux_receive_queue_ring_block + 1) %
+                                                     NX_LINUX_RX_RING_BLOCK_COUNT;
+}
+#endif /* NX_LINUX_ENABLE_RX_RING */
+
+#ifdef NX_LINUX_ENABLE_XSK
+UINT _nx_linux_xsk_create(NX_LINUX_INSTANCE *instance_ptr)
+{
+NX_PACKET_POOL *pool_ptr = instance_ptr -> nx_linux_instance_ip -> nx_ip_default_packet_pool;
+NX_PACKET      *first_ptr;
+ALIGN_TYPE      page_size = (ALIGN_TYPE)sysconf(_SC_PAGESIZE);
+ALIGN_TYPE      start;
+ALIGN_TYPE      end;
+ULONG           frame_size;
+ULONG           chunk_size;
+UINT            queue_index;
+UINT            queue_ready = 0;
+UINT            status;
+
+    /* A frame is written 2 bytes into the packet data, so the IP header is 4-byte
+       aligned, and must fit in the rest of the packet.  */
+    frame_size = pool_ptr -> nx_packet_pool_payload_size - 2;
+    chunk_size = frame_size + XDP_PACKET_HEADROOM;
+    if (chunk_size < NX_LINUX_XSK_MIN_CHUNK_SIZE)
+    {
+        chunk_size = NX_LINUX_XSK_MIN_CHUNK_SIZE;
+    }
+    if ((frame_size < NX_LINK_MTU) || (chunk_size > page_size))
+    {
+        return(NX_NOT_SUCCESSFUL);
+    }
+
+    /* Packets are laid out back to back from the start of the pool.  The chunk of
+       the first packet may start before the pool.  */
+    first_ptr = (NX_PACKET *)pool_ptr -> nx_packet_pool_start;
+    start = (ALIGN_TYPE)first_ptr -> nx_packet_data_end - chunk_size;
+    if (start > (ALIGN_TYPE)first_ptr)
+    {
+        start = (ALIGN_TYPE)first_ptr;
+    }
+    start &= ~(page_size - 1);
+    end = ((ALIGN_TYPE)pool_ptr -> nx_packet_pool_start + pool_ptr -> nx_packet_pool_size + page_size - 1) &
+          ~(page_size - 1);
+
+    instance_ptr -> nx_linux_instance_xsk_pool = pool_ptr;
+    instance_ptr -> nx_linux_instance_xsk_umem = (UCHAR *)start;
+    instance_ptr -> nx_linux_instance_xsk_umem_size = (ULONG)(end - start);
+    instance_ptr -> nx_linux_instance_xsk_packet_size = (ULONG)(first_ptr -> nx_packet_data_end - (UCHAR *)first_ptr);
+    instance_ptr -> nx_linux_instance_xsk_chunk_size = chunk_size;
+    instance_ptr -> nx_linux_instance_xsk_frame_offset = chunk_size - frame_size;
+
+    for (queue_index = 0; queue_index < instance_ptr -> nx_linux_instance_receive_queue_count; queue_index++)
+    {
+        if (_nx_linux_xsk_queue_create(&instance_ptr -> nx_linux_instance_receive_queues[queue_index], queue_index) == NX_SUCCESS)
+        {
+            queue_ready++;
+        }
+    }
+
+    if (queue_ready == 0)
+    {
+        return(NX_NOT_CREATED);
+    }
+
+    status = _nx_linux_xsk_program_attach(instance_ptr);
+    if (status)
+    {
+
+        /* No frame reaches the sockets without the program. Keep every queue on AF_PACKET.  */
+        for (queue_index = 0; queue_index < instance_ptr -> nx_linux_instance_receive_queue_count; queue_index++)
+        {
+            _nx_linux_xsk_queue_close(&instance_ptr -> nx_linux_instance_receive_queues[queue_index]);
+        }
+
+        if (instance_ptr -> nx_linux_instance_xsk_map >= 0)
+        {
+            close(instance_ptr -> nx_linux_instance_xsk_map);
+            instance_ptr -> nx_linux_instance_xsk_map = -1;
+        }
+    }
+
+    return(status);
+}
+
+UINT _nx_linux_xsk_queue_create(NX_LINUX_RECEIVE_QUEUE *queue_ptr, UINT queue_index)
+{
+NX_LINUX_INSTANCE      *instance_ptr = queue_ptr -> nx_linux_receive_queue_instance;
+struct xdp_umem_reg     umem;
+struct xdp_mmap_offsets offsets;
+struct sockaddr_xdp     sa;
+socklen_t               length = sizeof(offsets);
+int                     ring_size = NX_LINUX_XSK_RING_SIZE;
+int                     socket_fd;
+
+    socket_fd = socket(AF_XDP, SOCK_RAW, 0);
+    if (socket_fd < 0)
+    {
+        return(NX_NOT_CREATED);
+    }
+    queue_ptr -> nx_linux_receive_queue_xsk_socket = socket_fd;
+
+    if (queue_index == 0)
+    {
+        queue_ptr -> nx_linux_receive_queue_xsk_event = eventfd(0, EFD_NONBLOCK);
+        if (queue_ptr -> nx_linux_receive_queue_xsk_event < 0)
+        {
+            _nx_linux_xsk_queue_close(queue_ptr);
+            return(NX_NOT_CREATED);
+        }
+    }
+
+    /* Register the packet pool as the UMEM.  Chunks are placed at the packets, so
+       they are not aligned to the chunk size.  */
+    memset(&umem, 0, sizeof(umem));
+    umem.addr = (ALIGN_TYPE)instance_ptr -> nx_linux_instance_xsk_umem;
+    umem.len = instance_ptr -> nx_linux_instance_xsk_umem_size;
+    umem.chunk_size = instance_ptr -> nx_linux_instance_xsk_chunk_size;
+    umem.headroom = instance_ptr -> nx_linux_instance_xsk_frame_offset - XDP_PACKET_HEADROOM;
+    umem.flags = XDP_UMEM_UNALIGNED_CHUNK_FLAG;
+    if ((setsockopt(socket_fd, SOL_XDP, XDP_UMEM_REG, &umem, sizeof(umem)) < 0) ||
+        (setsockopt(socket_fd, SOL_XDP, XDP_UMEM_FILL_RING, &ring_size, sizeof(ring_size)) < 0) ||
+        (setsockopt(socket_fd, SOL_XDP, XDP_UMEM_COMPLETION_RING, &ring_size, sizeof(ring_size)) < 0) ||
+        (setsockopt(socket_fd, SOL_XDP, XDP_RX_RING, &ring_size, sizeof(ring_size)) < 0) ||
+        ((queue_index == 0) && (setsockopt(socket_fd, SOL_XDP, XDP_TX_RING, &ring_size, sizeof(ring_size)) < 0)) ||
+        (getsockopt(socket_fd, SOL_XDP, XDP_MMAP_OFFSETS, &offsets, &length) < 0))
+    {
+        _nx_linux_xsk_queue_close(queue_ptr);
+        return(NX_NOT_SUCCESSFUL);
+    }
+
+    if (_nx_linux_xsk_ring_map(socket_fd, &offsets.rx, XDP_PGOFF_RX_RING, sizeof(struct xdp_desc),
+                               &queue_ptr -> nx_linux_receive_queue_xsk_rx) ||
+        _nx_linux_xsk_ring_map(socket_fd, &offsets.fr, XDP_UMEM_PGOFF_FILL_RING, sizeof(ULONG64),
+                               &queue_ptr -> nx_linux_receive_queue_xsk_fill) ||
+        _nx_linux_xsk_ring_map(socket_fd, &offsets.cr, XDP_UMEM_PGOFF_COMPLETION_RING, sizeof(ULONG64),
+                               &queue_ptr -> nx_linux_receive_queue_xsk_completion) ||
+        ((queue_index == 0) &&
+         _nx_linux_xsk_ring_map(socket_fd, &offsets.tx, XDP_PGOFF_TX_RING, sizeof(struct xdp_desc),
+                                &queue_ptr -> nx_linux_receive_queue_xsk_tx)))
+    {
+        _nx_linux_xsk_queue_close(queue_ptr);
+        return(NX_NOT_SUCCESSFUL);
+    }
+
+    /* Bind to the interface queue of the same number.  Generic XDP copies frames.  */
+    memset(&sa, 0, sizeof(sa));
+    sa.sxdp_family = AF_XDP;
+    sa.sxdp_ifindex = instance_ptr -> nx_linux_instance_interface_index;
+    sa.sxdp_queue_id = queue_index;
+    sa.sxdp_flags = XDP_COPY;
+    if (bind(socket_fd, (struct sockaddr *)&sa, sizeof(sa)) < 0)
+    {
+        _nx_linux_xsk_queue_close(queue_ptr);
+        return(NX_NOT_BOUND);
+    }
+
+    queue_ptr -> nx_linux_receive_queue_xsk_tx_pending = 0;
+
+    return(NX_SUCCESS);
+}
+
+VOID _nx_linux_xsk_queue_close(NX_LINUX_RECEIVE_QUEUE *queue_ptr)
+{
+NX_LINUX_XSK_RING *rings[4];
+UINT               i;
+
+    /* Only called before packets are posted on the fill ring, so there are none to release.  */
+    rings[0] = &queue_ptr -> nx_linux_receive_queue_xsk_rx;
+    rings[1] = &queue_ptr -> nx_linux_receive_queue_xsk_fill;
+    rings[2] = &queue_ptr -> nx_linux_receive_queue_xsk_tx;
+    rings[3] = &queue_ptr -> nx_linux_receive_queue_xsk_completion;
+    for (i = 0; i < 4; i++)
+    {
+        if (rings[i] -> nx_linux_xsk_ring_map)
+        {
+            munmap(rings[i] -> nx_linux_xsk_ring_map, rings[i] -> nx_linux_xsk_ring_map_size);
+        }
+        memset(rings[i], 0, sizeof(NX_LINUX_XSK_RING));
+    }
+
+    if (queue_ptr -> nx_linux_receive_queue_xsk_socket >= 0)
+    {
+        close(queue_ptr -> nx_linux_receive_queue_xsk_socket);
+        queue_ptr -> nx_linux_receive_queue_xsk_socket = -1;
+    }
+
+    if (queue_ptr -> nx_linux_receive_queue_xsk_event >= 0)
+    {
+        close(queue_ptr -> nx_linux_receive_queue_xsk_event);
+        queue_ptr -> nx_linux_receive_queue_xsk_event = -1;
+    }
+}
+
+UINT _nx_linux_xsk_ring_map(int socket_fd, struct xdp_ring_offset *offset, off64_t page_offset, size_t entry_size,
+                            NX_LINUX_XSK_RING *ring_ptr)
+{
+size_t size = offset -> desc + NX_LINUX_XSK_RING_SIZE * entry_size;
+VOID  *map;
+
+    /* The ring offsets do not fit the 32-bit off_t of the simulator build.  */
+    map = mmap64(NX_NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, socket_fd, page_offset);
+    if (map == MAP_FAILED)
+    {
+        return(NX_NOT_SUCCESSFUL);
+    }
+
+    ring_ptr -> nx_linux_xsk_ring_map = (UCHAR *)map;
+    ring_ptr -> nx_linux_xsk_ring_map_size = size;
+    ring_ptr -> nx_linux_xsk_ring_producer = (UINT *)((UCHAR *)map + offset -> producer);
+    ring_ptr -> nx_linux_xsk_ring_consumer = (UINT *)((UCHAR *)map + offset -> consumer);
+    ring_ptr -> nx_linux_xsk_ring_entries = (UCHAR *)map + offset -> desc;
+
+    return(NX_SUCCESS);
+}
+
+UINT _nx_linux_xsk_program_attach(NX_LINUX_INSTANCE *instance_ptr)
+{
+NX_LINUX_RECEIVE_QUEUE *queue_ptr;
+union bpf_attr          attr;
+struct bpf_insn         program[6];
+int                     program_fd;
+int                     key;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.map_type = BPF_MAP_TYPE_XSKMAP;
+    attr.key_size = sizeof(int);
+    attr.value_size = sizeof(int);
+    attr.max_entries = NX_LINUX_RECEIVE_QUEUE_COUNT;
+    instance_ptr -> nx_linux_instance_xsk_map = (int)syscall(SYS_bpf, BPF_MAP_CREATE, &attr, sizeof(attr));
+    if (instance_ptr -> nx_linux_instance_xsk_map < 0)
+    {
+        return(NX_NOT_CREATED);
+    }
+
+    /* Enter the socket of each queue under the queue number.  */
+    for (key = 0; key < (int)instance_ptr -> nx_linux_instance_receive_queue_count; key++)
+    {
+        queue_ptr = &instance_ptr -> nx_linux_instance_receive_queues[key];
+        if (queue_ptr -> nx_linux_receive_queue_xsk_socket < 0)
+        {
+            continue;
+        }
+
+        memset(&attr, 0, sizeof(attr));
+        attr.map_fd = (UINT)instance_ptr -> nx_linux_instance_xsk_map;
+        attr.key = (ALIGN_TYPE)&key;
+        attr.value = (ALIGN_TYPE)&queue_ptr -> nx_linux_receive_queue_xsk_socket;
+        attr.flags = BPF_ANY;
+        if (syscall(SYS_bpf, BPF_MAP_UPDATE_ELEM, &attr, sizeof(attr)) < 0)
+        {
+            return(NX_NOT_SUCCESSFUL);
+        }
+    }
+
+    /* Build the program: return bpf_redirect_map(map, ctx -> rx_queue_index, XDP_PASS).
+       Frames of a queue without a socket pass to the kernel, and so to AF_PACKET.  */
+    memset(program, 0, sizeof(program));
+    program[0].code = BPF_LDX | BPF_MEM | BPF_W;
+    program[0].dst_reg = BPF_REG_2;
+    program[0].src_reg = BPF_REG_1;
+    program[0].off = offsetof(struct xdp_md, rx_queue_index);
+    program[1].code = BPF_LD | BPF_DW | BPF_IMM;
+    program[1].dst_reg = BPF_REG_1;
+    program[1].src_reg = BPF_PSEUDO_MAP_FD;
+    program[1].imm = instance_ptr -> nx_linux_instance_xsk_map;
+    program[3].code = BPF_ALU64 | BPF_MOV | BPF_K;
+    program[3].dst_reg = BPF_REG_3;
+    program[3].imm = XDP_PASS;
+    program[4].code = BPF_JMP | BPF_CALL;
+    program[4].imm = BPF_FUNC_redirect_map;
+    program[5].code = BPF_JMP | BPF_EXIT;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.prog_type = BPF_PROG_TYPE_XDP;
+    attr.insns = (ALIGN_TYPE)program;
+    attr.insn_cnt = sizeof(program) / sizeof(program[0]);
+    attr.license = (ALIGN_TYPE)"Dual MIT/GPL";
+    program_fd = (int)syscall(SYS_bpf, BPF_PROG_LOAD, &attr, sizeof(attr));
+    if (program_fd < 0)
+    {
+        return(NX_NOT_SUCCESSFUL);
+    }
+
+    /* Attach the program in generic mode.  The link detaches it when the process exits.  */
+    memset(&attr, 0, sizeof(attr));
+    attr.link_create.prog_fd = (UINT)program_fd;
+    attr.link_create.target_ifindex = (UINT)instance_ptr -> nx_linux_instance_interface_index;
+    attr.link_create.attach_type = BPF_XDP;
+    attr.link_create.flags = XDP_FLAGS_SKB_MODE;
+    instance_ptr -> nx_linux_instance_xsk_link = (int)syscall(SYS_bpf, BPF_LINK_CREATE, &attr, sizeof(attr));
+    close(program_fd);
+    if (instance_ptr -> nx_linux_instance_xsk_link < 0)
+    {
+        return(NX_NOT_SUCCESSFUL);
+    }
+
+    return(NX_SUCCESS);
+}
+
+NX_PACKET *_nx_linux_xsk_packet_get(NX_LINUX_INSTANCE *instance_ptr, UCHAR *data)
+{
+UCHAR *pool_start = (UCHAR *)instance_ptr -> nx_linux_instance_xsk_pool -> nx_packet_pool_start;
+ULONG  packet_size = instance_ptr -> nx_linux_instance_xsk_packet_size;
+
+    /* Find the packet the data lies in.  */
+    return((NX_PACKET *)(pool_start + ((ULONG)(data - pool_start) / packet_size) * packet_size));
+}
+
+int _nx_linux_xsk_process(NX_LINUX_RECEIVE_QUEUE *queue_ptr)
+{
+NX_LINUX_XSK_RING *tx_ptr = &queue_ptr -> nx_linux_receive_queue_xsk_tx;
+
+    _nx_linux_xsk_complete(queue_ptr);
+    _nx_linux_xsk_receive(queue_ptr);
+    _nx_linux_xsk_fill(queue_ptr);
+
+    /* Poll again after 1 ms while the kernel holds sent frames or the fill ring is
+       short of packets, so they are released or posted without waiting for a frame.
+       The completion consumer is stored before the transmit producer is loaded, and
+       the sender does the reverse, so at least one of us sees the other.  */
+    if ((tx_ptr -> nx_linux_xsk_ring_producer &&
+         (__atomic_load_n(tx_ptr -> nx_linux_xsk_ring_producer, __ATOMIC_SEQ_CST) !=
+          *queue_ptr -> nx_linux_receive_queue_xsk_completion.nx_linux_xsk_ring_consumer)) ||
+        ((*queue_ptr -> nx_linux_receive_queue_xsk_fill.nx_linux_xsk_ring_producer -
+          *queue_ptr -> nx_linux_receive_queue_xsk_rx.nx_linux_xsk_ring_consumer) < NX_LINUX_XSK_FILL_COUNT))
+    {
+        return(1);
+    }
+
+    return(-1);
+}
+
+VOID _nx_linux_xsk_receive(NX_LINUX_RECEIVE_QUEUE *queue_ptr)
+{
+NX_LINUX_INSTANCE *instance_ptr = queue_ptr -> nx_linux_receive_queue_instance;
+NX_LINUX_XSK_RING *ring_ptr = &queue_ptr -> nx_linux_receive_queue_xsk_rx;
+struct xdp_desc   *desc_ptr;
+NX_PACKET         *packet_ptr;
+UCHAR             *frame_ptr;
+UINT               consumer;
+UINT               producer;
+
+    consumer = *ring_ptr -> nx_linux_xsk_ring_consumer;
+    producer = __atomic_load_n(ring_ptr -> nx_linux_xsk_ring_producer, __ATOMIC_ACQUIRE);
+
+    for (; consumer != producer; consumer++)
+    {
+
+        /* The frame sits in a packet posted on the fill ring.  */
+        desc_ptr = (struct xdp_desc *)ring_ptr -> nx_linux_xsk_ring_entries + (consumer & (NX_LINUX_XSK_RING_SIZE - 1));
+        frame_ptr = instance_ptr -> nx_linux_instance_xsk_umem + (desc_ptr -> addr & XSK_UNALIGNED_BUF_ADDR_MASK) +
+                    (desc_ptr -> addr >> XSK_UNALIGNED_BUF_OFFSET_SHIFT);
+        packet_ptr = _nx_linux_xsk_packet_get(instance_ptr, frame_ptr);
+
+        /* Drop frames that are too short to carry an Ethernet header, or that are not for us.  */
+        if (!_nx_linux_frame_check(instance_ptr, frame_ptr, desc_ptr -> len))
+        {
+            nx_packet_release(packet_ptr);
+            continue;
+        }
+
+        packet_ptr -> nx_packet_prepend_ptr = frame_ptr;
+        packet_ptr -> nx_packet_append_ptr = frame_ptr + desc_ptr -> len;
+        packet_ptr -> nx_packet_length = desc_ptr -> len;
+
+#ifdef NX_LINUX_ENABLE_CHECKSUM_OFFLOAD
+        _nx_linux_receive_status_set(packet_ptr, 0);
+#endif /* NX_LINUX_ENABLE_CHECKSUM_OFFLOAD */
+#ifdef NX_LINUX_ENABLE_GRO
+        _nx_linux_gro_receive(queue_ptr, packet_ptr);
+#else
+        _nx_linux_packet_receive(instance_ptr, packet_ptr);
+#endif /* NX_LINUX_ENABLE_GRO */
+    }
+
+#ifdef NX_LINUX_ENABLE_GRO
+    /* Hand the last merged packet of the wakeup to NetX.  */
+    _nx_linux_gro_flush(queue_ptr);
+#endif /* NX_LINUX_ENABLE_GRO */
+
+    /* Give the descriptors back to the kernel.  */
+    __atomic_store_n(ring_ptr -> nx_linux_xsk_ring_consumer, consumer, __ATOMIC_RELEASE);
+}
+
+VOID _nx_linux_xsk_fill(NX_LINUX_RECEIVE_QUEUE *queue_ptr)
+{
+NX_LINUX_INSTANCE *instance_ptr = queue_ptr -> nx_linux_receive_queue_instance;
+NX_LINUX_XSK_RING *ring_ptr = &queue_ptr -> nx_linux_receive_queue_xsk_fill;
+NX_PACKET         *packet_ptr;
+UINT               producer;
+
+    /* A posted packet comes back on the receive ring, so the packets the kernel holds
+       are the ones posted after the last received frame.  */
+    producer = *ring_ptr -> nx_linux_xsk_ring_producer;
+    while ((producer - *queue_ptr -> nx_linux_receive_queue_xsk_rx.nx_linux_xsk_ring_consumer) < NX_LINUX_XSK_FILL_COUNT)
+    {
+        if (nx_packet_allocate(instance_ptr -> nx_linux_instance_xsk_pool, &packet_ptr, NX_RECEIVE_PACKET, NX_NO_WAIT))
+        {
+            NX_LINUX_STATISTICS_ADD(instance_ptr, allocation_errors, 1);
+            break;
+        }
+
+        /* Post the chunk that puts the frame 2 bytes into the packet data.  */
+        ((ULONG64 *)ring_ptr -> nx_linux_xsk_ring_entries)[producer & (NX_LINUX_XSK_RING_SIZE - 1)] =
+            (ULONG64)(packet_ptr -> nx_packet_data_start + 2 - instance_ptr -> nx_linux_instance_xsk_frame_offset -
+                      instance_ptr -> nx_linux_instance_xsk_umem);
+        producer++;
+    }
+
+    __atomic_store_n(ring_ptr -> nx_linux_xsk_ring_producer, producer, __ATOMIC_RELEASE);
+}
+
+VOID _nx_linux_xsk_complete(NX_LINUX_RECEIVE_QUEUE *queue_ptr)
+{
+NX_LINUX_INSTANCE *instance_ptr = queue_ptr -> nx_linux_receive_queue_instance;
+NX_LINUX_XSK_RING *ring_ptr = &queue_ptr -> nx_linux_receive_queue_xsk_completion;
+NX_PACKET         *packet_ptr;
+UINT               consumer;
+UINT               producer;
+
+    consumer = *ring_ptr -> nx_linux_xsk_ring_consumer;
+    producer = __atomic_load_n(ring_ptr -> nx_linux_xsk_ring_producer, __ATOMIC_ACQUIRE);
+
+    for (; consumer != producer; consumer++)
+    {
+        packet_ptr = _nx_linux_xsk_packet_get(instance_ptr, instance_ptr -> nx_linux_instance_xsk_umem +
+                                              ((ULONG64 *)ring_ptr -> nx_linux_xsk_ring_entries)[consumer & (NX_LINUX_XSK_RING_SIZE - 1)]);
+
+        /* Remove the Ethernet header.  */
+        packet_ptr -> nx_packet_prepend_ptr =  packet_ptr -> nx_packet_prepend_ptr + NX_ETHERNET_SIZE;
+
+        /* Adjust the packet length.  */
+        packet_ptr -> nx_packet_length =  packet_ptr -> nx_packet_length - NX_ETHERNET_SIZE;
+
+        /* Now that the Ethernet frame has been removed, release the packet.  */
+        nx_packet_transmit_release(packet_ptr);
+    }
+
+    __atomic_store_n(ring_ptr -> nx_linux_xsk_ring_consumer, consumer, __ATOMIC_SEQ_CST);
+}
+
+UINT _nx_linux_xsk_send(NX_LINUX_INSTANCE *instance_ptr, NX_PACKET *packet_ptr)
+{
+NX_LINUX_RECEIVE_QUEUE *queue_ptr = &instance_ptr -> nx_linux_instance_receive_queues[0];
+NX_LINUX_XSK_RING      *ring_ptr = &queue_ptr -> nx_linux_receive_queue_xsk_tx;
+struct xdp_desc        *desc_ptr;
+UINT                    producer;
+
+    /* Only a frame held in one packet of the UMEM, with its checksums complete, can be
+       sent in place.  */
+    if ((queue_ptr -> nx_linux_receive_queue_xsk_socket < 0) ||
+#ifndef NX_DISABLE_PACKET_CHAIN
+        packet_ptr -> nx_packet_next ||
+#endif /* NX_DISABLE_PACKET_CHAIN */
+#ifdef NX_LINUX_ENABLE_CHECKSUM_OFFLOAD
+        (packet_ptr -> nx_packet_interface_capability_flag & NX_INTERFACE_TX_CAPABILITY) ||
+#endif /* NX_LINUX_ENABLE_CHECKSUM_OFFLOAD */
+        (packet_ptr -> nx_packet_pool_owner != instance_ptr -> nx_linux_instance_xsk_pool))
+    {
+        return(NX_NOT_SUCCESSFUL);
+    }
+
+    /* Every frame in flight needs a slot on the completion ring.  */
+    producer = *ring_ptr -> nx_linux_xsk_ring_producer;
+    if ((producer - __atomic_load_n(queue_ptr -> nx_linux_receive_queue_xsk_completion.nx_linux_xsk_ring_consumer,
+                                    __ATOMIC_ACQUIRE)) >= NX_LINUX_XSK_RING_SIZE)
+    {
+        _nx_linux_xsk_flush(instance_ptr);
+        return(NX_NOT_SUCCESSFUL);
+    }
+
+    desc_ptr = (struct xdp_desc *)ring_ptr -> nx_linux_xsk_ring_entries + (producer & (NX_LINUX_XSK_RING_SIZE - 1));
+    desc_ptr -> addr = (ULONG64)(packet_ptr -> nx_packet_prepend_ptr - instance_ptr -> nx_linux_instance_xsk_umem);
+    desc_ptr -> len = packet_ptr -> nx_packet_length;
+    desc_ptr -> options = 0;
+    __atomic_store_n(ring_ptr -> nx_linux_xsk_ring_producer, producer + 1, __ATOMIC_SEQ_CST);
+    NX_LINUX_STATISTICS_ADD(instance_ptr, tx_frames, 1);
+    NX_LINUX_STATISTICS_ADD(instance_ptr, tx_bytes, packet_ptr -> nx_packet_length);
+
+    /* Wake the receive thread if every earlier frame has completed, as it may be
+       waiting without a timeout.  */
+    if (__atomic_load_n(queue_ptr -> nx_linux_receive_queue_xsk_completion.nx_linux_xsk_ring_consumer,
+                        __ATOMIC_SEQ_CST) == producer)
+    {
+        eventfd_write(queue_ptr -> nx_linux_receive_queue_xsk_event, 1);
+    }
+
+    queue_ptr -> nx_linux_receive_queue_xsk_tx_pending++;
+    if (queue_ptr -> nx_linux_receive_queue_xsk_tx_pending >= NX_LINUX_XSK_FLUSH_THRESHOLD)
+    {
+        _nx_linux_xsk_flush(instance_ptr);
+    }
+    else if (queue_ptr -> nx_linux_receive_queue_xsk_tx_pending == 1)
+    {
+
+        /* Ask the IP thread to kick the kernel once it is done with the current burst.  */
+        _nx_ip_driver_deferred_processing(instance_ptr -> nx_linux_instance_ip);
+    }
+
+    return(NX_SUCCESS);
+}
+
+VOID _nx_linux_xsk_flush(NX_LINUX_INSTANCE *instance_ptr)
+{
+NX_LINUX_RECEIVE_QUEUE *queue_ptr = &instance_ptr -> nx_linux_instance_receive_queues[0];
+
+    /* Kick the kernel to transmit the frames on the transmit ring.  */
+    if (queue_ptr -> nx_linux_receive_queue_xsk_tx_pending)
+    {
+        sendto(queue_ptr -> nx_linux_receive_queue_xsk_socket, NX_NULL, 0, MSG_DONTWAIT, NX_NULL, 0);
+        queue_ptr -> nx_linux_receive_queue_xsk_tx_pending = 0;
+        NX_LINUX_STATISTICS_ADD(instance_ptr, tx_syscalls, 1);
+    }
+}
+#endif /* NX_LINUX_ENABLE_XSK */
+
+#ifdef NX_LINUX_ENABLE_IO_URING
+UINT _nx_linux_io_uring_create(NX_LINUX_RECEIVE_QUEUE *queue_ptr)
+{
+NX_LINUX_INSTANCE      *instance_ptr = queue_ptr -> nx_linux_receive_queue_instance;
+NX_LINUX_IO_URING      *ring_ptr = &queue_ptr -> nx_linux_receive_queue_io_uring;
+struct io_uring_params  params;
+struct io_uring_buf_reg buffer_reg;
+struct io_uring_cqe    *cqe_ptr;
+VOID                   *map;
+int                     ring_fd;
+
+    /* A frame is written 2 bytes into the packet data, so the IP header is 4-byte
+       aligned, and must fit in the rest of the packet.  */
+    if ((instance_ptr -> nx_linux_instance_ip -> nx_ip_default_packet_pool -> nx_packet_pool_payload_size - 2) < NX_LINK_MTU)
+    {
+        return(NX_NOT_SUCCESSFUL);
+    }
+
+    memset(&params, 0, sizeof(params));
+    ring_fd = (int)syscall(__NR_io_uring_setup, NX_LINUX_IO_URING_ENTRIES, &params);
+    if (ring_fd < 0)
+    {
+        return(NX_NOT_CREATED);
+    }
+    ring_ptr -> nx_linux_io_uring_fd = ring_fd;
+
+    /* Map the submission and completion queues, which share one mapping on recent
+       kernels, and the submission queue entries.  */
+    ring_ptr -> nx_linux_io_uring_sq_map_size = params.sq_off.array + params.sq_entries * sizeof(UINT);
+    ring_ptr -> nx_linux_io_uring_cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if (ring_ptr -> nx_linux_io_uring_cq_map_size > ring_ptr -> nx_linux_io_uring_sq_map_size)
+        {
+            ring_ptr -> nx_linux_io_uring_sq_map_size = ring_ptr -> nx_linux_io_uring_cq_map_size;
+        }
+        ring_ptr -> nx_linux_io_uring_cq_map_size = 0;
+    }
+
+    map = mmap(NX_NULL, ring_ptr -> nx_linux_io_uring_sq_map_size, PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+    if (map == MAP_FAILED)
+    {
+        _nx_linux_io_uring_close(queue_ptr);
+        return(NX_NOT_SUCCESSFUL);
+    }
+    ring_ptr -> nx_linux_io_uring_sq_map = (UCHAR *)map;
+
+    if (ring_ptr -> nx_linux_io_uring_cq_map_size)
+    {
+        map = mmap(NX_NULL, ring_ptr -> nx_linux_io_uring_cq_map_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+        if (map == MAP_FAILED)
+        {
+            _nx_linux_io_uring_close(queue_ptr);
+            return(NX_NOT_SUCCESSFUL);
+        }
+    }
+    ring_ptr -> nx_linux_io_uring_cq_map = (UCHAR *)map;
+
+    ring_ptr -> nx_linux_io_uring_sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    map = mmap(NX_NULL, ring_ptr -> nx_linux_io_uring_sqes_size, PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+    if (map == MAP_FAILED)
+    {
+        _nx_linux_io_uring_close(queue_ptr);
+        return(NX_NOT_SUCCESSFUL);
+    }
+    ring_ptr -> nx_linux_io_uring_sqes = (struct io_uring_sqe *)map;
+
+    ring_ptr -> nx_linux_io_uring_sq_head = (UINT *)(ring_ptr -> nx_linux_io_uring_sq_map + params.sq_off.head);
+    ring_ptr -> nx_linux_io_uring_sq_tail = (UINT *)(ring_ptr -> nx_linux_io_uring_sq_map + params.sq_off.tail);
+    ring_ptr -> nx_linux_io_uring_sq_array = (UINT *)(ring_ptr -> nx_linux_io_uring_sq_map + params.sq_off.array);
+    ring_ptr -> nx_linux_io_uring_sq_entries = params.sq_entries;
+    ring_ptr -> nx_linux_io_uring_sq_next = *ring_ptr -> nx_linux_io_uring_sq_tail;
+    ring_ptr -> nx_linux_io_uring_cq_head = (UINT *)(ring_ptr -> nx_linux_io_uring_cq_map + params.cq_off.head);
+    ring_ptr -> nx_linux_io_uring_cq_tail = (UINT *)(ring_ptr -> nx_linux_io_uring_cq_map + params.cq_off.tail);
+    ring_ptr -> nx_linux_io_uring_cqes = (struct io_uring_cqe *)(ring_ptr -> nx_linux_io_uring_cq_map + params.cq_off.cqes);
+    ring_ptr -> nx_linux_io_uring_cq_mask = *(UINT *)(ring_ptr -> nx_linux_io_uring_cq_map + params.cq_off.ring_mask);
+
+    /* Register the buffer ring the receive picks packets from.  It must be page aligned.  */
+    map = mmap(NX_NULL, NX_LINUX_IO_URING_BUFFER_COUNT * sizeof(struct io_uring_buf), PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED)
+    {
+        _nx_linux_io_uring_close(queue_ptr);
+        return(NX_NOT_SUCCESSFUL);
+    }
+    queue_ptr -> nx_linux_receive_queue_io_uring_buffers = (struct io_uring_buf_ring *)map;
+
+    memset(&buffer_reg, 0, sizeof(buffer_reg));
+    buffer_reg.ring_addr = (ALIGN_TYPE)map;
+    buffer_reg.ring_entries = NX_LINUX_IO_URING_BUFFER_COUNT;
+    buffer_reg.bgid = 0;
+    if (syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_PBUF_RING, &buffer_reg, 1) < 0)
+    {
+        _nx_linux_io_uring_close(queue_ptr);
+        return(NX_NOT_SUCCESSFUL);
+    }
+
+    /* Arm the receive while no packet is posted.  A kernel with multishot receive
+       ends it at once with -ENOBUFS; older ones reject the request.  */
+    _nx_linux_io_uring_receive_arm(queue_ptr);
+    if (_nx_linux_io_uring_submit(ring_ptr, 1) < 0)
+    {
+        _nx_linux_io_uring_close(queue_ptr);
+        return(NX_NOT_SUCCESSFUL);
+    }
+
+    cqe_ptr = &ring_ptr -> nx_linux_io_uring_cqes[*ring_ptr -> nx_linux_io_uring_cq_head & ring_ptr -> nx_linux_io_uring_cq_mask];
+    if ((*ring_ptr -> nx_linux_io_uring_cq_head == __atomic_load_n(ring_ptr -> nx_linux_io_uring_cq_tail, __ATOMIC_ACQUIRE)) ||
+        (cqe_ptr -> res != -ENOBUFS))
+    {
+        _nx_linux_io_uring_close(queue_ptr);
+        return(NX_NOT_SUCCESSFUL);
+    }
+    __atomic_store_n(ring_ptr -> nx_linux_io_uring_cq_head, *ring_ptr -> nx_linux_io_uring_cq_head + 1, __ATOMIC_RELEASE);
+
+    /* The receive thread posts packets and asks the IP thread to arm the receive.  */
+    queue_ptr -> nx_linux_receive_queue_io_uring_armed = 0;
+    queue_ptr -> nx_linux_receive_queue_io_uring_sent = 0;
+    queue_ptr -> nx_linux_receive_queue_io_uring_completed = 0;
+
+    return(NX_SUCCESS);
+}
+
+VOID _nx_linux_io_uring_close(NX_LINUX_RECEIVE_QUEUE *queue_ptr)
+{
+NX_LINUX_IO_URING *ring_ptr = &queue_ptr -> nx_linux_receive_queue_io_uring;
+
+    /* Only called before packets are posted on the buffer ring, so there are none to release.  */
+    if (ring_ptr -> nx_linux_io_uring_fd >= 0)
+    {
+        close(ring_ptr -> nx_linux_io_uring_fd);
+    }
+
+    if (queue_ptr -> nx_linux_receive_queue_io_uring_buffers)
+    {
+        munmap(queue_ptr -> nx_linux_receive_queue_io_uring_buffers, NX_LINUX_IO_URING_BUFFER_COUNT * sizeof(struct io_uring_buf));
+        queue_ptr -> nx_linux_receive_queue_io_uring_buffers = NX_NULL;
+    }
+
+    if (ring_ptr -> nx_linux_io_uring_sqes)
+    {
+        munmap(ring_ptr -> nx_linux_io_uring_sqes, ring_ptr -> nx_linux_io_uring_sqes_size);
+    }
+
+    if (ring_ptr -> nx_linux_io_uring_cq_map_size && ring_ptr -> nx_linux_io_uring_cq_map)
+    {
+        munmap(ring_ptr -> nx_linux_io_uring_cq_map, ring_ptr -> nx_linux_io_uring_cq_map_size);
+    }
+
+    if (ring_ptr -> nx_linux_io_uring_sq_map)
+    {
+        munmap(ring_ptr -> nx_linux_io_uring_sq_map, ring_ptr -> nx_linux_io_uring_sq_map_size);
+    }
+
+    memset(ring_ptr, 0, sizeof(NX_LINUX_IO_URING));
+    ring_ptr -> nx_linux_io_uring_fd = -1;
+}
+
+struct io_uring_sqe *_nx_linux_io_uring_sqe_get(NX_LINUX_IO_URING *ring_ptr)
+{
+struct io_uring_sqe *sqe_ptr;
+UINT                 index;
+
+    /* Entries are handed to the kernel when the queue is submitted.  */
+    if ((ring_ptr -> nx_linux_io_uring_sq_next - __atomic_load_n(ring_ptr -> nx_linux_io_uring_sq_head, __ATOMIC_ACQUIRE)) >=
+        ring_ptr -> nx_linux_io_uring_sq_entries)
+    {
+        return(NX_NULL);
+    }
+
+    index = ring_ptr -> nx_linux_io_uring_sq_next & (ring_ptr -> nx_linux_io_uring_sq_entries - 1);
+    sqe_ptr = &ring_ptr -> nx_linux_io_uring_sqes[index];
+    memset(sqe_ptr, 0, sizeof(struct io_uring_sqe));
+    ring_ptr -> nx_linux_io_uring_sq_array[index] = index;
+    ring_ptr -> nx_linux_io_uring_sq_next++;
+
+    return(sqe_ptr);
+}
+
+int _nx_linux_io_uring_submit(NX_LINUX_IO_URING *ring_ptr, UINT wait_count)
+{
+UINT submit_count;
+
+    /* Publish the prepared entries and hand them to the kernel in one call.  */
+    __atomic_store_n(ring_ptr -> nx_linux_io_uring_sq_tail, ring_ptr -> nx_linux_io_uring_sq_next, __ATOMIC_RELEASE);
+    submit_count = ring_ptr -> nx_linux_io_uring_sq_next -
+                   __atomic_load_n(ring_ptr -> nx_linux_io_uring_sq_head, __ATOMIC_ACQUIRE);
+    if ((submit_count == 0) && (wait_count == 0))
+    {
+        return(0);
+    }
+
+    return((int)syscall(__NR_io_uring_enter, ring_ptr -> nx_linux_io_uring_fd, submit_count, wait_count,
+                        wait_count ? IORING_ENTER_GETEVENTS : 0, NX_NULL, 0));
+}
+
+VOID _nx_linux_io_uring_receive_arm(NX_LINUX_RECEIVE_QUEUE *queue_ptr)
+{
+struct io_uring_sqe *sqe_ptr;
+
+    sqe_ptr = _nx_linux_io_uring_sqe_get(&queue_ptr -> nx_linux_receive_queue_io_uring);
+    if (sqe_ptr == NX_NULL)
+    {
+        return;
+    }
+
+    /* Receive frames into the posted packets until the kernel ends the request.
+       Sends carry their packet as user data, so a receive carries 0.  */
+    sqe_ptr -> opcode = IORING_OP_RECV;
+    sqe_ptr -> fd = queue_ptr -> nx_linux_receive_queue_socket;
+    sqe_ptr -> ioprio = IORING_RECV_MULTISHOT;
+    sqe_ptr -> flags = IOSQE_BUFFER_SELECT;
+    sqe_ptr -> buf_group = 0;
+    sqe_ptr -> user_data = 0;
+
+    __atomic_store_n(&queue_ptr -> nx_linux_receive_queue_io_uring_armed, 1, __ATOMIC_RELEASE);
+}
+
+int _nx_linux_io_uring_process(NX_LINUX_RECEIVE_QUEUE *queue_ptr)
+{
+NX_LINUX_IO_URING   *ring_ptr = &queue_ptr -> nx_linux_receive_queue_io_uring;
+struct io_uring_cqe *cqe_ptr;
+NX_PACKET           *packet_ptr;
+UINT                 head;
+UINT                 tail;
+UINT                 buffer_id;
+
+    head = *ring_ptr -> nx_linux_io_uring_cq_head;
+    tail = __atomic_load_n(ring_ptr -> nx_linux_io_uring_cq_tail, __ATOMIC_ACQUIRE);
+
+    for (; head != tail; head++)
+    {
+        cqe_ptr = &ring_ptr -> nx_linux_io_uring_cqes[head & ring_ptr -> nx_linux_io_uring_cq_mask];
+
+        if (cqe_ptr -> user_data)
+        {
+
+            /* A send completed.  */
+            packet_ptr = (NX_PACKET *)(ALIGN_TYPE)cqe_ptr -> user_data;
+            if (cqe_ptr -> res < 0)
+            {
+                NX_LINUX_STATISTICS_ADD(queue_ptr -> nx_linux_receive_queue_instance, tx_errors, 1);
+            }
+
+            /* Remove the Ethernet header.  */
+            packet_ptr -> nx_packet_prepend_ptr =  packet_ptr -> nx_packet_prepend_ptr + NX_ETHERNET_SIZE;
+
+            /* Adjust the packet length.  */
+            packet_ptr -> nx_packet_length =  packet_ptr -> nx_packet_length - NX_ETHERNET_SIZE;
+
+            /* Now that the Ethernet frame has been removed, release the packet.  */
+            nx_packet_transmit_release(packet_ptr);
+
+            __atomic_store_n(&queue_ptr -> nx_linux_receive_queue_io_uring_completed,
+                             queue_ptr -> nx_linux_receive_queue_io_uring_completed + 1, __ATOMIC_RELEASE);
+            continue;
+        }
+
+        _nx_linux_io_uring_receive(queue_ptr, cqe_ptr);
+
+        if ((cqe_ptr -> flags & IORING_CQE_F_MORE) == 0)
+        {
+
+            /* The kernel ended the receive.  */
+            __atomic_store_n(&queue_ptr -> nx_linux_receive_queue_io_uring_armed, 0, __ATOMIC_RELEASE);
+        }
+    }
+
+    __atomic_store_n(ring_ptr -> nx_linux_io_uring_cq_head, head, __ATOMIC_RELEASE);
+
+#ifdef NX_LINUX_ENABLE_GRO
+    /* Hand the last merged packet of the wakeup to NetX.  */
+    _nx_linux_gro_flush(queue_ptr);
+#endif /* NX_LINUX_ENABLE_GRO */
+
+    _nx_linux_io_uring_fill(queue_ptr);
+
+    if (__atomic_load_n(&queue_ptr -> nx_linux_receive_queue_io_uring_armed, __ATOMIC_ACQUIRE))
+    {
+        return(-1);
+    }
+
+    /* Ask the IP thread to arm the receive once a packet is posted, and poll again
+       after 1 ms until it has.  */
+    for (buffer_id = 0; buffer_id < NX_LINUX_IO_URING_BUFFER_COUNT; buffer_id++)
+    {
+        if (queue_ptr -> nx_linux_receive_queue_io_uring_packets[buffer_id])
+        {
+            _nx_ip_driver_deferred_processing(queue_ptr -> nx_linux_receive_queue_instance -> nx_linux_instance_ip);
+            break;
+        }
+    }
+
+    return(1);
+}
+
+VOID _nx_linux_io_uring_receive(NX_LINUX_RECEIVE_QUEUE *queue_ptr, struct io_uring_cqe *cqe_ptr)
+{
+NX_LINUX_INSTANCE *instance_ptr = queue_ptr -> nx_linux_receive_queue_instance;
+NX_PACKET         *packet_ptr;
+UINT               buffer_id;
+
+    /* A receive that ends without a frame does not take a packet.  */
+    if ((cqe_ptr -> flags & IORING_CQE_F_BUFFER) == 0)
+    {
+        return;
+    }
+
+    /* The frame sits 2 bytes into the packet posted with this buffer ID.  */
+    buffer_id = cqe_ptr -> flags >> IORING_CQE_BUFFER_SHIFT;
+    packet_ptr = queue_ptr -> nx_linux_receive_queue_io_uring_packets[buffer_id];
+    queue_ptr -> nx_linux_receive_queue_io_uring_packets[buffer_id] = NX_NULL;
+
+    /* Drop frames that are too short to carry an Ethernet header, or that are not for us.  */
+    if ((cqe_ptr -> res < 0) ||
+        !_nx_linux_frame_check(instance_ptr, packet_ptr -> nx_packet_prepend_ptr + 2, (ULONG)cqe_ptr -> res))
+    {
+        nx_packet_release(packet_ptr);
+        return;
+    }
+
+    packet_ptr -> nx_packet_prepend_ptr += 2;
+    packet_ptr -> nx_packet_append_ptr = packet_ptr -> nx_packet_prepend_ptr + cqe_ptr -> res;
+    packet_ptr -> nx_packet_length = (ULONG)cqe_ptr -> res;
+
+#ifdef NX_LINUX_ENABLE_CHECKSUM_OFFLOAD
+    _nx_linux_receive_status_set(packet_ptr, 0);
+#endif /* NX_LINUX_ENABLE_CHECKSUM_OFFLOAD */
+#ifdef NX_LINUX_ENABLE_GRO
+    _nx_linux_gro_receive(queue_ptr, packet_ptr);
+#else
+    _nx_linux_packet_receive(instance_ptr, packet_ptr);
+#endif /* NX_LINUX_ENABLE_GRO */
+}
+
+VOID _nx_linux_io_uring_fill(NX_LINUX_RECEIVE_QUEUE *queue_ptr)
+{
+NX_PACKET_POOL           *pool_ptr = queue_ptr -> nx_linux_receive_queue_instance -> nx_linux_instance_ip -> nx_ip_default_packet_pool;
+struct io_uring_buf_ring *buffers_ptr = queue_ptr -> nx_linux_receive_queue_io_uring_buffers;
+struct io_uring_buf      *buffer_ptr;
+NX_PACKET                *packet_ptr;
+USHORT                    tail;
+UINT                      buffer_id;
+
+    /* Post a packet for every buffer ID whose packet has been received.  At most
+       NX_LINUX_IO_URING_BUFFER_COUNT packets are posted, so the ring never fills.  */
+    tail = buffers_ptr -> tail;
+    for (buffer_id = 0; buffer_id < NX_LINUX_IO_URING_BUFFER_COUNT; buffer_id++)
+    {
+        if (queue_ptr -> nx_linux_receive_queue_io_uring_packets[buffer_id])
+        {
+            continue;
+        }
+
+        if (nx_packet_allocate(pool_ptr, &packet_ptr, NX_RECEIVE_PACKET, NX_NO_WAIT))
+        {
+            NX_LINUX_STATISTICS_ADD(queue_ptr -> nx_linux_receive_queue_instance, allocation_errors, 1);
+            break;
+        }
+        queue_ptr -> nx_linux_receive_queue_io_uring_packets[buffer_id] = packet_ptr;
+
+        /* Set the fields one by one, as the tail overlays the first entry.  */
+        buffer_ptr = &buffers_ptr -> bufs[tail & (NX_LINUX_IO_URING_BUFFER_COUNT - 1)];
+        buffer_ptr -> addr = (ALIGN_TYPE)(packet_ptr -> nx_packet_prepend_ptr + 2);
+        buffer_ptr -> len = (UINT)(packet_ptr -> nx_packet_data_end - packet_ptr -> nx_packet_prepend_ptr - 2);
+        buffer_ptr -> bid = (USHORT)buffer_id;
+        tail++;
+    }
+
+    __atomic_store_n(&buffers_ptr -> tail, tail, __ATOMIC_RELEASE);
+}
+
+UINT _nx_linux_io_uring_send(NX_LINUX_INSTANCE *instance_ptr, NX_PACKET *packet_ptr)
+{
+NX_LINUX_RECEIVE_QUEUE *queue_ptr = &instance_ptr -> nx_linux_instance_receive_queues[0];
+NX_LINUX_IO_URING      *ring_ptr = &queue_ptr -> nx_linux_receive_queue_io_uring;
+struct io_uring_sqe    *sqe_ptr = NX_NULL;
+UINT                    pending;
+
+    if (ring_ptr -> nx_linux_io_uring_fd < 0)
+    {
+        return(NX_NOT_SUCCESSFUL);
+    }
+
+    /* Only a frame held in one packet, with its checksums complete, can be sent in
+       place, and every send in flight needs room on the completion queue.  */
+    if (
+#ifndef NX_DISABLE_PACKET_CHAIN
+        (packet_ptr -> nx_packet_next == NX_NULL) &&
+#endif /* NX_DISABLE_PACKET_CHAIN */
+#ifdef NX_LINUX_ENABLE_CHECKSUM_OFFLOAD
+        ((packet_ptr -> nx_packet_interface_capability_flag & NX_INTERFACE_TX_CAPABILITY) == 0) &&
+#endif /* NX_LINUX_ENABLE_CHECKSUM_OFFLOAD */
+        ((queue_ptr -> nx_linux_receive_queue_io_uring_sent -
+          __atomic_load_n(&queue_ptr -> nx_linux_receive_queue_io_uring_completed, __ATOMIC_ACQUIRE)) < NX_LINUX_IO_URING_ENTRIES))
+    {
+        sqe_ptr = _nx_linux_io_uring_sqe_get(ring_ptr);
+    }
+
+    if (sqe_ptr == NX_NULL)
+    {
+
+        /* Submit the queued sends first to keep the frames in order.  */
+        if (_nx_linux_io_uring_submit(ring_ptr, 0))
+        {
+            NX_LINUX_STATISTICS_ADD(instance_ptr, tx_syscalls, 1);
+        }
+        return(NX_NOT_SUCCESSFUL);
+    }
+
+    sqe_ptr -> opcode = IORING_OP_SEND;
+    sqe_ptr -> fd = queue_ptr -> nx_linux_receive_queue_socket;
+    sqe_ptr -> addr = (ALIGN_TYPE)packet_ptr -> nx_packet_prepend_ptr;
+    sqe_ptr -> len = packet_ptr -> nx_packet_length;
+    sqe_ptr -> user_data = (ALIGN_TYPE)packet_ptr;
+    queue_ptr -> nx_linux_receive_queue_io_uring_sent++;
+    NX_LINUX_STATISTICS_ADD(instance_ptr, tx_frames, 1);
+    NX_LINUX_STATISTICS_ADD(instance_ptr, tx_bytes, packet_ptr -> nx_packet_length);
+
+    pending = ring_ptr -> nx_linux_io_uring_sq_next - __atomic_load_n(ring_ptr -> nx_linux_io_uring_sq_head, __ATOMIC_ACQUIRE);
+    if (pending >= NX_LINUX_IO_URING_FLUSH_THRESHOLD)
+    {
+        if (_nx_linux_io_uring_submit(ring_ptr, 0))
+        {
+            NX_LINUX_STATISTICS_ADD(instance_ptr, tx_syscalls, 1);
+        }
+    }
+    else if (pending == 1)
+    {
+
+        /* Ask the IP thread to submit once it is done with the current burst.  */
+        _nx_ip_driver_deferred_processing(instance_ptr -> nx_linux_instance_ip);
+    }
+
+    return(NX_SUCCESS);
+}
+
+VOID _nx_linux_io_uring_flush(NX_LINUX_INSTANCE *instance_ptr)
+{
+NX_LINUX_RECEIVE_QUEUE *queue_ptr;
+UINT                    old_threshold = 0;
+
+    /* Keep other NetX threads from sending while the rings are submitted.  */
+    tx_thread_preemption_change(tx_thread_identify(), 0, &old_threshold);
+
+    for (queue_ptr = instance_ptr -> nx_linux_instance_receive_queues;
+         queue_ptr < &instance_ptr -> nx_linux_instance_receive_queues[instance_ptr -> nx_linux_instance_receive_queue_count];
+         queue_ptr++)
+    {
+        if (queue_ptr -> nx_linux_receive_queue_io_uring.nx_linux_io_uring_fd < 0)
+        {
+            continue;
+        }
+
+        /* Arm the receive again if the kernel has ended it.  */
+        if (__atomic_load_n(&queue_ptr -> nx_linux_receive_queue_io_uring_armed, __ATOMIC_ACQUIRE) == 0)
+        {
+            _nx_linux_io_uring_receive_arm(queue_ptr);
+        }
+
+        if (_nx_linux_io_uring_submit(&queue_ptr -> nx_linux_receive_queue_io_uring, 0))
+        {
+            NX_LINUX_STATISTICS_ADD(instance_ptr, tx_syscalls, 1);
+        }
+    }
+
+    /* Restore preemption.  */
+    tx_thread_preemption_change(tx_thread_identify(), old_threshold, &old_threshold);
+}
+#endif /* NX_LINUX_ENABLE_IO_URING */
+
+#ifdef NX_LINUX_ENABLE_DEFERRED_RECEIVE
+VOID _nx_linux_receive_deferred(NX_LINUX_RECEIVE_QUEUE *queue_ptr)
+{
+NX_LINUX_INSTANCE       *instance_ptr = queue_ptr -> nx_linux_receive_queue_instance;
+NX_PACKET               *packet_ptr;
+UINT                     head;
+UINT                     frame_count;
+int                      frames_received;
+UCHAR                    discard;
+#if NX_LINUX_RECEIVE_BATCH_SIZE > 1
+UINT                     i;
+#else
+NX_PACKET               *packets[NX_LINUX_RECEIVE_VECTOR_COUNT];
+struct iovec             vectors[NX_LINUX_RECEIVE_VECTOR_COUNT];
+struct msghdr            message;
+UINT                     packet_count;
+#ifdef NX_LINUX_ENABLE_CHECKSUM_OFFLOAD
+NX_LINUX_AUXDATA_CONTROL control;
+#endif /* NX_LINUX_ENABLE_CHECKSUM_OFFLOAD */
+#endif /* NX_LINUX_RECEIVE_BATCH_SIZE > 1 */
+
+    head = queue_ptr -> nx_linux_receive_queue_head;
+    frame_count = NX_LINUX_DEFERRED_RING_SIZE -
+                  (head - __atomic_load_n(&queue_ptr -> nx_linux_receive_queue_tail, __ATOMIC_ACQUIRE));
+
+    if (frame_count == 0)
+    {
+
+        /* The IP thread is behind. Drop one frame.  */
+        if (recv(queue_ptr -> nx_linux_receive_queue_socket, &discard, sizeof(discard), MSG_DONTWAIT) >= 0)
+        {
+            NX_LINUX_STATISTICS_ADD(instance_ptr, rx_frames, 1);
+            NX_LINUX_STATISTICS_ADD(instance_ptr, rx_queue_full_drops, 1);
+        }
+        NX_LINUX_STATISTICS_ADD(instance_ptr, rx_syscalls, 1);
+        return;
+    }
+
+#if NX_LINUX_RECEIVE_BATCH_SIZE > 1
+    if (frame_count > NX_LINUX_RECEIVE_BATCH_SIZE)
+    {
+        frame_count = NX_LINUX_RECEIVE_BATCH_SIZE;
+    }
+
+    /* Make sure the batch slots for the free ring entries hold packets.  */
+    _tx_thread_context_save();
+    frame_count = _nx_linux_receive_slots_fill(queue_ptr, frame_count);
+    _tx_thread_context_restore();
+#else
+
+    /* Allocate the packets the frame is received into.  */
+    _tx_thread_context_save();
+    packet_count = _nx_linux_receive_packets_allocate(instance_ptr, packets, vectors);
+    _tx_thread_context_restore();
+    frame_count = (packet_count != 0);
+    if (packet_count == 0)
+    {
+        NX_LINUX_STATISTICS_ADD(instance_ptr, allocation_errors, 1);
+    }
+#endif /* NX_LINUX_RECEIVE_BATCH_SIZE > 1 */
+
+    if (frame_count == 0)
+    {
+
+        /* No packet available. Drop one frame without copying it.  The failed
+           allocation has been counted above.  */
+        if (recv(queue_ptr -> nx_linux_receive_queue_socket, NX_NULL, 0, MSG_TRUNC | MSG_DONTWAIT) >= 0)
+        {
+            NX_LINUX_STATISTICS_ADD(instance_ptr, rx_frames, 1);
+        }
+        NX_LINUX_STATISTICS_ADD(instance_ptr, rx_syscalls, 1);
+        return;
+    }
+
+#if NX_LINUX_RECEIVE_BATCH_SIZE > 1
+
+    /* Read as many frames as are queued straight into the slot packets.  */
+    frames_received = recvmmsg(queue_ptr -> nx_linux_receive_queue_socket, queue_ptr -> nx_linux_receive_queue_messages,
+                               frame_count, MSG_DONTWAIT, NX_NULL);
+    NX_LINUX_STATISTICS_ADD(instance_ptr, rx_syscalls, 1);
+    if (frames_received <= 0)
+    {
+        return;
+    }
+
+    /* Queue the packets of the frames received for the IP thread.  */
+    _tx_thread_context_save();
+    frame_count = 0;
+    for (i = 0; i < (UINT)frames_received; i++)
+    {
+        packet_ptr = _nx_linux_receive_slot_build(queue_ptr, i);
+        if (packet_ptr)
+        {
+            queue_ptr -> nx_linux_receive_queue_deferred_packets[(head + frame_count) & (NX_LINUX_DEFERRED_RING_SIZE - 1)] = packet_ptr;
+            frame_count++;
+        }
+    }
+#else
+
+    /* Receive the frame straight into the packet payloads.  */
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = vectors;
+    message.msg_iovlen = packet_count;
+#ifdef NX_LINUX_ENABLE_CHECKSUM_OFFLOAD
+    message.msg_control = &control;
+    message.msg_controllen = sizeof(control);
+#endif /* NX_LINUX_ENABLE_CHECKSUM_OFFLOAD */
+    frames_received = recvmsg(queue_ptr -> nx_linux_receive_queue_socket, &message, MSG_DONTWAIT);
+    NX_LINUX_STATISTICS_ADD(instance_ptr, rx_syscalls, 1);
+
+    /* Queue the packet for the IP thread.  */
+    _tx_thread_context_save();
+    frame_count = 0;
+    packet_ptr = _nx_linux_receive_packets_build(instance_ptr, packets, vectors, packet_count, frames_received, message.msg_flags);
+    if (packet_ptr)
+    {
+#ifdef NX_LINUX_ENABLE_CHECKSUM_OFFLOAD
+        _nx_linux_receive_status_set(packet_ptr, _nx_linux_receive_status_get(&message));
+#endif /* NX_LINUX_ENABLE_CHECKSUM_OFFLOAD */
+        queue_ptr -> nx_linux_receive_queue_deferred_packets[head & (NX_LINUX_DEFERRED_RING_SIZE - 1)] = packet_ptr;
+        frame_count = 1;
+    }
+#endif /* NX_LINUX_RECEIVE_BATCH_SIZE > 1 */
 
-/* For the linux ethernet driver, physical addresses are allocated starting
-   at the preset value and then incremented before the next allocation.  */
+    if (frame_count)
+    {
 
-ULONG              nx_linux_address_msw =  0x0011;
-ULONG              nx_linux_address_lsw =  0x22334457;
+        /* Publish the packets to the IP thread.  */
+        __atomic_store_n(&queue_ptr -> nx_linux_receive_queue_head, head + frame_count, __ATOMIC_RELEASE);
 
-static const CHAR *nx_linux_interface_name = NX_LINUX_INTERFACE_NAME;
-static int         nx_linux_interface_index = 0;
-static pthread_t   nx_linux_receive_thread;
-static NX_IP      *nx_linux_default_ip;
-static int         nx_linux_socket = -1;
+        /* Notify the IP thread unless a notification is already outstanding.  */
+        if (__atomic_exchange_n(&instance_ptr -> nx_linux_instance_deferred_receive_pending, 1, __ATOMIC_ACQ_REL) == 0)
+        {
+            _nx_ip_driver_deferred_processing(instance_ptr -> nx_linux_instance_ip);
+        }
+    }
+    _tx_thread_context_restore();
+}
 
-/* Define the buffer to store data that will be used by linux socket. */
-static UCHAR nx_linux_transmit_buffer[NX_MAX_PACKET_SIZE];
-static UCHAR nx_linux_receive_buffer[NX_MAX_PACKET_SIZE];
+VOID _nx_linux_deferred_receive_process(NX_LINUX_INSTANCE *instance_ptr)
+{
+NX_LINUX_RECEIVE_QUEUE *queue_ptr;
+NX_PACKET              *packet_ptr;
+UINT                    head;
+UINT                    tail;
 
+    /* Clear the notification first, so packets published while draining notify again.  */
+    __atomic_store_n(&instance_ptr -> nx_linux_instance_deferred_receive_pending, 0, __ATOMIC_SEQ_CST);
 
-/* Define driver prototypes.  */
+    for (queue_ptr = instance_ptr -> nx_linux_instance_receive_queues;
+         queue_ptr < &instance_ptr -> nx_linux_instance_receive_queues[instance_ptr -> nx_linux_instance_receive_queue_count];
+         queue_ptr++)
+    {
+        tail = queue_ptr -> nx_linux_receive_queue_tail;
+        head = __atomic_load_n(&queue_ptr -> nx_linux_receive_queue_head, __ATOMIC_ACQUIRE);
 
-UINT  _nx_linux_initialize(NX_IP *ip_ptr);
-UINT  _nx_linux_send_packet(NX_PACKET *packet_ptr);
-void *_nx_linux_receive_thread_entry(void *arg);
-VOID  _nx_linux_network_driver_output(NX_PACKET *packet_ptr);
-VOID  _nx_linux_network_driver(NX_IP_DRIVER *driver_req_ptr);
+        for (; tail != head; tail++)
+        {
 
-/* Define interface capability.  */
+            /* The receive thread has already checked the frame and built its packet.  */
+            packet_ptr = queue_ptr -> nx_linux_receive_queue_deferred_packets[tail & (NX_LINUX_DEFERRED_RING_SIZE - 1)];
+#ifdef NX_LINUX_ENABLE_GRO
+            _nx_linux_gro_receive(queue_ptr, packet_ptr);
+#else
+            _nx_linux_packet_receive(instance_ptr, packet_ptr);
+#endif /* NX_LINUX_ENABLE_GRO */
+        }
 
-#ifdef NX_ENABLE_INTERFACE_CAPABILITY
-#define NX_INTERFACE_CAPABILITY (NX_INTERFACE_CAPABILITY_IPV4_RX_CHECKSUM |   \
-                                 NX_INTERFACE_CAPABILITY_TCP_RX_CHECKSUM |    \
-                                 NX_INTERFACE_CAPABILITY_UDP_RX_CHECKSUM |    \
-                                 NX_INTERFACE_CAPABILITY_ICMPV4_RX_CHECKSUM | \
-                                 NX_INTERFACE_CAPABILITY_ICMPV6_RX_CHECKSUM)
-#endif /* NX_ENABLE_INTERFACE_CAPABILITY */
+#ifdef NX_LINUX_ENABLE_GRO
+        /* Hand the last merged packet of the queue to NetX.  */
+        _nx_linux_gro_flush(queue_ptr);
+#endif /* NX_LINUX_ENABLE_GRO */
 
-VOID nx_linux_set_interface_name(const CHAR *interface_name)
-{
-    nx_linux_interface_name = interface_name;
-    nx_linux_interface_index = if_nametoindex(interface_name);
+        /* Hand the entries back to the receive thread.  */
+        __atomic_store_n(&queue_ptr -> nx_linux_receive_queue_tail, tail, __ATOMIC_RELEASE);
+    }
 }
+#endif /* NX_LINUX_ENABLE_DEFERRED_RECEIVE */
 
-UINT _nx_linux_send_packet(NX_PACKET *packet_ptr)
+#if defined(NX_LINUX_ENABLE_BUSY_POLL) || defined(NX_LINUX_ENABLE_IMPAIRMENT)
+ULONG64 _nx_linux_time_get(VOID)
 {
-ULONG              size = 0;
-UCHAR             *data;
-struct sockaddr_ll to_address;
+struct timespec now;
 
-    /* Make sure the data length is less than MTU. */
-    if (packet_ptr -> nx_packet_length > NX_MAX_PACKET_SIZE)
-    {
-        return NX_NOT_SUCCESSFUL;
-    }
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return((ULONG64)now.tv_sec * 1000000000 + (ULONG64)now.tv_nsec);
+}
+#endif /* NX_LINUX_ENABLE_BUSY_POLL || NX_LINUX_ENABLE_IMPAIRMENT */
 
-    /* Set data pointer to be transmitted.  */
-#ifndef NX_DISABLE_PACKET_CHAIN
-    if (packet_ptr -> nx_packet_next)
+int _nx_linux_receive_wait(NX_LINUX_RECEIVE_QUEUE *queue_ptr, struct pollfd *poll_fds, nfds_t fd_count, int timeout)
+{
+#ifdef NX_LINUX_ENABLE_BUSY_POLL
+ULONG64 start;
+ULONG64 now;
+#endif /* NX_LINUX_ENABLE_BUSY_POLL */
+int     result;
+
+#ifdef NX_LINUX_ENABLE_BUSY_POLL
+    /* Spin with non-blocking polls until the budget after the last wakeup runs out.  */
+    start = _nx_linux_time_get();
+    now = start;
+    while ((now - queue_ptr -> nx_linux_receive_queue_busy_poll_last) < (ULONG64)NX_LINUX_BUSY_POLL_BUDGET * 1000)
     {
-        if (nx_packet_data_retrieve(packet_ptr, nx_linux_transmit_buffer, &size))
+        result = poll(poll_fds, fd_count, 0);
+        NX_LINUX_STATISTICS_ADD(queue_ptr -> nx_linux_receive_queue_instance, rx_syscalls, 1);
+        now = _nx_linux_time_get();
+        if (result)
         {
-            return NX_NOT_SUCCESSFUL;
+            __atomic_fetch_add(&nx_linux_receive_poll_time, now - start, __ATOMIC_RELAXED);
+            queue_ptr -> nx_linux_receive_queue_busy_poll_last = now;
+            if (result > 0)
+            {
+                NX_LINUX_STATISTICS_ADD(queue_ptr -> nx_linux_receive_queue_instance, rx_wakeups, 1);
+            }
+            return(result);
         }
-        data = nx_linux_transmit_buffer;
     }
-    else
-#endif /* NX_DISABLE_PACKET_CHAIN */
+    __atomic_fetch_add(&nx_linux_receive_poll_time, now - start, __ATOMIC_RELAXED);
+
+    /* Nothing came within the budget. Sleep until the next event.  */
+    result = poll(poll_fds, fd_count, timeout);
+    start = now;
+    now = _nx_linux_time_get();
+    __atomic_fetch_add(&nx_linux_receive_sleep_time, now - start, __ATOMIC_RELAXED);
+    if (result > 0)
     {
-        data = packet_ptr -> nx_packet_prepend_ptr;
-        size = packet_ptr -> nx_packet_length;
+        queue_ptr -> nx_linux_receive_queue_busy_poll_last = now;
     }
+#else
+    NX_PARAMETER_NOT_USED(queue_ptr);
 
-    /* Set destination address.  */
-    to_address.sll_family = AF_PACKET;
-    to_address.sll_protocol = htons(ETH_P_ALL);
-    to_address.sll_ifindex = nx_linux_interface_index;
+    result = poll(poll_fds, fd_count, timeout);
+#endif /* NX_LINUX_ENABLE_BUSY_POLL */
 
-    if (sendto(nx_linux_socket, (CHAR *)data, size, 0, (struct sockaddr *)&to_address, sizeof(to_address)) != size)
+    NX_LINUX_STATISTICS_ADD(queue_ptr -> nx_linux_receive_queue_instance, rx_syscalls, 1);
+    if (result > 0)
     {
-        return NX_NOT_SUCCESSFUL;
+        NX_LINUX_STATISTICS_ADD(queue_ptr -> nx_linux_receive_queue_instance, rx_wakeups, 1);
     }
 
-    return NX_SUCCESS;
+    return(result);
 }
 
 void *_nx_linux_receive_thread_entry(void *arg)
 {
-fd_set             read_fds;
-UCHAR             *data;
-int                bytes_received;
-struct sockaddr_ll from_address;
-int                address_len;
-NX_PACKET         *packet_ptr;
-UINT               status;
-UINT               packet_type;
+NX_LINUX_RECEIVE_QUEUE    *queue_ptr = (NX_LINUX_RECEIVE_QUEUE *)arg;
+int                        socket_fd = queue_ptr -> nx_linux_receive_queue_socket;
+struct pollfd              poll_fd;
+#ifdef NX_LINUX_ENABLE_RX_RING
+struct tpacket_block_desc *block_ptr;
+#endif /* NX_LINUX_ENABLE_RX_RING */
+#ifdef NX_LINUX_ENABLE_XSK
+struct pollfd              xsk_poll_fds[2];
+eventfd_t                  event;
+int                        timeout;
+#endif /* NX_LINUX_ENABLE_XSK */
+#ifdef NX_LINUX_ENABLE_IO_URING
+int                        uring_timeout;
+#endif /* NX_LINUX_ENABLE_IO_URING */
 
     /* Loop to capture packets. */
     for (;;)
     {
-        FD_ZERO(&read_fds);
-        FD_SET(nx_linux_socket, &read_fds);
-
-        if (select(nx_linux_socket + 1, &read_fds, NULL, NULL, NULL) <= 0)
-        {
-            continue;
-        }
-
-        _tx_thread_context_save();
-
-        status = nx_packet_allocate(nx_linux_default_ip -> nx_ip_default_packet_pool,
-                                    &packet_ptr, NX_RECEIVE_PACKET, NX_NO_WAIT);
-
-        if (status)
-        {
-            packet_ptr = NX_NULL;
-            data = nx_linux_receive_buffer;
-        }
-        else if (nx_linux_default_ip -> nx_ip_default_packet_pool -> nx_packet_pool_payload_size >= (NX_LINK_MTU + 2))
+#ifdef NX_LINUX_ENABLE_XSK
+        if (queue_ptr -> nx_linux_receive_queue_xsk_socket >= 0)
         {
-            data = packet_ptr -> nx_packet_prepend_ptr + 2;
-        }
-        else
-        {
-            data = nx_linux_receive_buffer;
-        }
 
-        address_len = sizeof(from_address);
-        bytes_received = recvfrom(nx_linux_socket, (VOID *)data, NX_LINK_MTU, 0,
-                                  (struct sockaddr *)&from_address, &address_len);
-
-        if (bytes_received < 14)
-        {
+            /* Release sent packets, receive frames and post packets for the next ones.  */
+            _tx_thread_context_save();
+            timeout = _nx_linux_xsk_process(queue_ptr);
+            _tx_thread_context_restore();
 
-            /* Not an Ethernet header.  */
-            if (packet_ptr)
+            /* Wait for a frame, or for the sender to put the first frame in flight.  */
+            xsk_poll_fds[0].fd = queue_ptr -> nx_linux_receive_queue_xsk_socket;
+            xsk_poll_fds[0].events = POLLIN;
+            xsk_poll_fds[0].revents = 0;
+            xsk_poll_fds[1].fd = queue_ptr -> nx_linux_receive_queue_xsk_event;
+            xsk_poll_fds[1].events = POLLIN;
+            xsk_poll_fds[1].revents = 0;
+            if ((_nx_linux_receive_wait(queue_ptr, xsk_poll_fds, 2, timeout) > 0) && (xsk_poll_fds[1].revents & POLLIN))
             {
-                nx_packet_release(packet_ptr);
+                eventfd_read(queue_ptr -> nx_linux_receive_queue_xsk_event, &event);
             }
-            _tx_thread_context_restore();
             continue;
         }
-
-        if (packet_ptr == NX_NULL)
+#endif /* NX_LINUX_ENABLE_XSK */
+#ifdef NX_LINUX_ENABLE_IO_URING
+        if (queue_ptr -> nx_linux_receive_queue_io_uring.nx_linux_io_uring_fd >= 0)
         {
 
-            /* No packet available. Drop it and continue.  */
+            /* Release sent packets, receive frames and post packets for the next ones.  */
+            _tx_thread_context_save();
+            uring_timeout = _nx_linux_io_uring_process(queue_ptr);
             _tx_thread_context_restore();
+
+            /* Wait for the next completion.  */
+            poll_fd.fd = queue_ptr -> nx_linux_receive_queue_io_uring.nx_linux_io_uring_fd;
+            poll_fd.events = POLLIN;
+            poll_fd.revents = 0;
+            _nx_linux_receive_wait(queue_ptr, &poll_fd, 1, uring_timeout);
             continue;
         }
-
-        /* Make sure IP header is 4-byte aligned. */
-        packet_ptr -> nx_packet_prepend_ptr += 2;
-        packet_ptr -> nx_packet_append_ptr += 2;
-
-        if (data == nx_linux_receive_buffer)
+#endif /* NX_LINUX_ENABLE_IO_URING */
+#ifdef NX_LINUX_ENABLE_RX_RING
+        if (queue_ptr -> nx_linux_receive_queue_ring)
         {
+            block_ptr = (struct tpacket_block_desc *)(queue_ptr -> nx_linux_receive_queue_ring +
+                                                      (size_t)queue_ptr -> nx_linux_receive_queue_ring_block *
+                                                      NX_LINUX_RX_RING_BLOCK_SIZE);
 
-            /* Copy data into packet.  */
-
-            status = nx_packet_data_append(packet_ptr, (VOID *)data, bytes_received,
-                                           nx_linux_default_ip -> nx_ip_default_packet_pool, NX_NO_WAIT);
-            if (status)
+            /* Wait for the kernel only when the current block is not ready.  */
+            if ((block_ptr -> hdr.bh1.block_status & TP_STATUS_USER) == 0)
             {
-                nx_packet_release(packet_ptr);
-                _tx_thread_context_restore();
+                poll_fd.fd = socket_fd;
+                poll_fd.events = POLLIN | POLLERR;
+                poll_fd.revents = 0;
+                _nx_linux_receive_wait(queue_ptr, &poll_fd, 1, -1);
                 continue;
             }
+            __sync_synchronize();
+
+            _tx_thread_context_save();
+            _nx_linux_receive_ring_block(queue_ptr, block_ptr);
+            _tx_thread_context_restore();
+            continue;
         }
-        else
-        {
-            packet_ptr -> nx_packet_length = (ULONG)bytes_received;
-            packet_ptr -> nx_packet_append_ptr += (ULONG)bytes_received;
-        }
+#endif /* NX_LINUX_ENABLE_RX_RING */
 
-        /* Pickup the packet header to determine where the packet needs to be sent.  */
-        packet_type =  (((UINT)(*(packet_ptr -> nx_packet_prepend_ptr + 12))) << 8) |
-                        ((UINT)(*(packet_ptr -> nx_packet_prepend_ptr + 13)));
+        poll_fd.fd = socket_fd;
+        poll_fd.events = POLLIN;
+        poll_fd.revents = 0;
 
-        /* Route the incoming packet according to its ethernet type.  */
-        if ((packet_type == NX_ETHERNET_IP) || (packet_type == NX_ETHERNET_IPV6))
+        if (_nx_linux_receive_wait(queue_ptr, &poll_fd, 1, -1) <= 0)
         {
+            continue;
+        }
 
-            /* Note:  The length reported by some Ethernet hardware includes bytes after the packet
-               as well as the Ethernet header.  In some cases, the actual packet length after the
-               Ethernet header should be derived from the length in the IP header (lower 16 bits of
-               the first 32-bit word).  */
+#ifdef NX_LINUX_ENABLE_DEFERRED_RECEIVE
+        /* Queue the frames for the IP thread.  */
+        _nx_linux_receive_deferred(queue_ptr);
+#else
+        _tx_thread_context_save();
 
-            /* Clean off the Ethernet header.  */
-            packet_ptr -> nx_packet_prepend_ptr =  packet_ptr -> nx_packet_prepend_ptr + NX_ETHERNET_SIZE;
+#if NX_LINUX_RECEIVE_BATCH_SIZE > 1
+        _nx_linux_receive_batch(queue_ptr);
+#else
+        _nx_linux_receive_frame(queue_ptr);
+#endif /* NX_LINUX_RECEIVE_BATCH_SIZE > 1 */
 
-            /* Adjust the packet length.  */
-            packet_ptr -> nx_packet_length =  packet_ptr -> nx_packet_length - NX_ETHERNET_SIZE;
+        _tx_thread_context_restore();
+#endif /* NX_LINUX_ENABLE_DEFERRED_RECEIVE */
+    }
+    return((void *)0);
+}
 
-            _nx_ip_packet_deferred_receive(nx_linux_default_ip, packet_ptr);
-        }
-        else if (packet_type == NX_ETHERNET_ARP)
-        {
+UINT _nx_linux_receive_queue_create(NX_LINUX_INSTANCE *instance_ptr, NX_LINUX_RECEIVE_QUEUE *queue_ptr)
+{
+struct sockaddr_ll sa;
+int                socket_fd;
+#if NX_LINUX_RECEIVE_QUEUE_COUNT > 1
+int                fanout;
+socklen_t          fanout_length = sizeof(fanout);
+#endif /* NX_LINUX_RECEIVE_QUEUE_COUNT > 1 */
+#ifdef NX_LINUX_ENABLE_CHECKSUM_OFFLOAD
+int                enable = 1;
+#endif /* NX_LINUX_ENABLE_CHECKSUM_OFFLOAD */
+#ifdef NX_LINUX_ENABLE_BUSY_POLL
+int                busy_poll = NX_LINUX_BUSY_POLL_BUDGET;
+#endif /* NX_LINUX_ENABLE_BUSY_POLL */
+
+    queue_ptr -> nx_linux_receive_queue_instance = instance_ptr;
+#ifdef NX_LINUX_ENABLE_XSK
+    queue_ptr -> nx_linux_receive_queue_xsk_socket = -1;
+    queue_ptr -> nx_linux_receive_queue_xsk_event = -1;
+#endif /* NX_LINUX_ENABLE_XSK */
+#ifdef NX_LINUX_ENABLE_IO_URING
+    queue_ptr -> nx_linux_receive_queue_io_uring.nx_linux_io_uring_fd = -1;
+#endif /* NX_LINUX_ENABLE_IO_URING */
+
+    socket_fd = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+    if (socket_fd < 0)
+    {
+        return(NX_NOT_CREATED);
+    }
 
-            /* Clean off the Ethernet header.  */
-            packet_ptr -> nx_packet_prepend_ptr =  packet_ptr -> nx_packet_prepend_ptr + NX_ETHERNET_SIZE;
+#ifdef NX_LINUX_ENABLE_RECEIVE_FILTER
+    /* Attach the filter before binding, so no foreign frame is queued on the socket.  */
+    _nx_linux_receive_filter_attach(instance_ptr, socket_fd);
+#endif /* NX_LINUX_ENABLE_RECEIVE_FILTER */
 
-            /* Adjust the packet length.  */
-            packet_ptr -> nx_packet_length =  packet_ptr -> nx_packet_length - NX_ETHERNET_SIZE;
+    sa.sll_family = AF_PACKET;
+    sa.sll_protocol = htons(ETH_P_ALL);
+    sa.sll_ifindex = instance_ptr -> nx_linux_instance_interface_index;
+    if (bind(socket_fd, (struct sockaddr *)&sa, sizeof(sa)) < 0)
+    {
+        close(socket_fd);
+        return(NX_NOT_BOUND);
+    }
 
-            _nx_arp_packet_deferred_receive(nx_linux_default_ip, packet_ptr);
+#if NX_LINUX_RECEIVE_QUEUE_COUNT > 1
+    /* Join the fanout group of this interface. The kernel hashes each flow to one socket.
+       Group ids are shared by every process in the network namespace, so the first queue
+       has the kernel pick an unused id and the other queues of the instance join it.  */
+    if (queue_ptr == &instance_ptr -> nx_linux_instance_receive_queues[0])
+    {
+        fanout = (PACKET_FANOUT_HASH | PACKET_FANOUT_FLAG_UNIQUEID) << 16;
+        if ((setsockopt(socket_fd, SOL_PACKET, PACKET_FANOUT, &fanout, sizeof(fanout)) < 0) ||
+            (getsockopt(socket_fd, SOL_PACKET, PACKET_FANOUT, &fanout, &fanout_length) < 0))
+        {
+            close(socket_fd);
+            return(NX_NOT_SUCCESSFUL);
         }
-        else if (packet_type == NX_ETHERNET_RARP)
+        instance_ptr -> nx_linux_instance_fanout_id = fanout & 0xFFFF;
+    }
+    else
+    {
+        fanout = instance_ptr -> nx_linux_instance_fanout_id | (PACKET_FANOUT_HASH << 16);
+        if (setsockopt(socket_fd, SOL_PACKET, PACKET_FANOUT, &fanout, sizeof(fanout)) < 0)
         {
+            close(socket_fd);
+            return(NX_NOT_SUCCESSFUL);
+        }
+    }
+#endif /* NX_LINUX_RECEIVE_QUEUE_COUNT > 1 */
 
-            /* Clean off the Ethernet header.  */
-            packet_ptr -> nx_packet_prepend_ptr =  packet_ptr -> nx_packet_prepend_ptr + NX_ETHERNET_SIZE;
-
-            /* Adjust the packet length.  */
-            packet_ptr -> nx_packet_length =  packet_ptr -> nx_packet_length - NX_ETHERNET_SIZE;
+#ifdef NX_LINUX_ENABLE_CHECKSUM_OFFLOAD
+    /* Report the checksum status of each frame. Without it every frame is checked by the driver.  */
+    setsockopt(socket_fd, SOL_PACKET, PACKET_AUXDATA, &enable, sizeof(enable));
+#endif /* NX_LINUX_ENABLE_CHECKSUM_OFFLOAD */
 
-            _nx_rarp_packet_deferred_receive(nx_linux_default_ip, packet_ptr);
-        }
-#ifdef NX_ENABLE_PPPOE
-        else if ((packet_type == NX_ETHERNET_PPPOE_DISCOVERY) ||
-                 (packet_type == NX_ETHERNET_PPPOE_SESSION))
-        {
+#ifdef NX_LINUX_ENABLE_BUSY_POLL
+    /* Let the kernel poll the device queue while the receive thread spins.  */
+    setsockopt(socket_fd, SOL_SOCKET, SO_BUSY_POLL, &busy_poll, sizeof(busy_poll));
+#endif /* NX_LINUX_ENABLE_BUSY_POLL */
 
-            /* Clean off the Ethernet header.  */
-            packet_ptr -> nx_packet_prepend_ptr =  packet_ptr -> nx_packet_prepend_ptr + NX_ETHERNET_SIZE;
+    queue_ptr -> nx_linux_receive_queue_socket = socket_fd;
 
-            /* Adjust the packet length.  */
-            packet_ptr -> nx_packet_length =  packet_ptr -> nx_packet_length - NX_ETHERNET_SIZE;
+#ifdef NX_LINUX_ENABLE_RX_RING
+    /* Map the receive ring. On failure frames are received with recvfrom().  */
+    _nx_linux_rx_ring_create(queue_ptr);
+#endif /* NX_LINUX_ENABLE_RX_RING */
 
-            /* Route to the PPPoE receive function.  */
-            _nx_pppoe_packet_deferred_receive(packet_ptr);
-        }
-#endif
-        else
-        {
+#ifdef NX_LINUX_ENABLE_IO_URING
+    /* Set up the io_uring. On failure frames are received with recvfrom() and sent with sendto().  */
+    _nx_linux_io_uring_create(queue_ptr);
+#endif /* NX_LINUX_ENABLE_IO_URING */
 
-            /* Invalid ethernet header... release the packet.  */
-            nx_packet_release(packet_ptr);
-        }
-        _tx_thread_context_restore();
-    }
-    return((void *)0);
+    return(NX_SUCCESS);
 }
 
-UINT _nx_linux_initialize(NX_IP *ip_ptr)
+UINT _nx_linux_initialize(NX_LINUX_INSTANCE *instance_ptr)
 {
-struct sched_param sp;
-struct sockaddr_ll sa;
+struct sched_param      sp;
+NX_LINUX_RECEIVE_QUEUE *queue_ptr;
+UINT                    queue_count;
+UINT                    status;
+#ifdef NX_LINUX_RECEIVE_QUEUE_FIRST_CPU
+cpu_set_t               cpu_set;
+#endif /* NX_LINUX_RECEIVE_QUEUE_FIRST_CPU */
 
     /* Define the thread's priority. */
 #ifdef TX_LINUX_PRIORITY_ISR
@@ -306,47 +5074,224 @@ struct sockaddr_ll sa;
 #endif
 
     /* Return if socket has been created. */
-    if (nx_linux_socket > 0)
+    if (instance_ptr -> nx_linux_instance_socket >= 0)
     {
         return(NX_ALREADY_ENABLED);
     }
 
-    nx_linux_socket = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
-    if (nx_linux_socket < 0)
+    instance_ptr -> nx_linux_instance_interface_index = if_nametoindex(instance_ptr -> nx_linux_instance_interface_name);
+
+    /* Open the first receive queue, whose socket is also used for sending.  */
+    status = _nx_linux_receive_queue_create(instance_ptr, &instance_ptr -> nx_linux_instance_receive_queues[0]);
+    if (status)
     {
-        return(NX_NOT_CREATED);
+        return(status);
     }
+    instance_ptr -> nx_linux_instance_socket = instance_ptr -> nx_linux_instance_receive_queues[0].nx_linux_receive_queue_socket;
 
-    nx_linux_interface_index = if_nametoindex(nx_linux_interface_name);
-    sa.sll_family = AF_PACKET;
-    sa.sll_protocol = htons(ETH_P_ALL);
-    sa.sll_ifindex = nx_linux_interface_index;
-    if (bind(nx_linux_socket, (struct sockaddr *)&sa, sizeof(sa)) < 0)
+    /* Open the additional receive queues. Stop at the first one that fails.  */
+    for (queue_count = 1; queue_count < NX_LINUX_RECEIVE_QUEUE_COUNT; queue_count++)
     {
-        close(nx_linux_socket);
-        return(NX_NOT_BOUND);
+        if (_nx_linux_receive_queue_create(instance_ptr, &instance_ptr -> nx_linux_instance_receive_queues[queue_count]))
+        {
+            break;
+        }
+    }
+
+    instance_ptr -> nx_linux_instance_receive_queue_count = queue_count;
+
+#ifdef NX_LINUX_ENABLE_XSK
+    /* Move the receive queues to AF_XDP sockets. On failure they stay on AF_PACKET.  */
+    _nx_linux_xsk_create(instance_ptr);
+#endif /* NX_LINUX_ENABLE_XSK */
+
+#ifdef NX_LINUX_ENABLE_CHECKSUM_OFFLOAD
+    /* Open the socket for frames with a virtio-net header. On failure transmit
+       checksums are not offloaded.  */
+    _nx_linux_vnet_socket_create(instance_ptr);
+#endif /* NX_LINUX_ENABLE_CHECKSUM_OFFLOAD */
+
+#ifdef NX_LINUX_ENABLE_TX_RING
+    /* Map the transmit ring. On failure frames are sent with sendto().  */
+    _nx_linux_tx_ring_create(instance_ptr);
+#endif /* NX_LINUX_ENABLE_TX_RING */
+
+    /* Create a Linux thread per receive queue to loop for capturing packets */
+    for (queue_ptr = instance_ptr -> nx_linux_instance_receive_queues;
+         queue_ptr < &instance_ptr -> nx_linux_instance_receive_queues[queue_count]; queue_ptr++)
+    {
+        pthread_create(&queue_ptr -> nx_linux_receive_queue_thread, NULL, _nx_linux_receive_thread_entry, queue_ptr);
+
+        /* Set the thread's policy and priority */
+        pthread_setschedparam(queue_ptr -> nx_linux_receive_queue_thread, SCHED_FIFO, &sp);
+
+#ifdef NX_LINUX_RECEIVE_QUEUE_FIRST_CPU
+        /* Pin the thread to its CPU. Each instance takes the next NX_LINUX_RECEIVE_QUEUE_COUNT CPUs.  */
+        CPU_ZERO(&cpu_set);
+        CPU_SET(NX_LINUX_RECEIVE_QUEUE_FIRST_CPU + (instance_ptr - nx_linux_instances) * NX_LINUX_RECEIVE_QUEUE_COUNT +
+                (queue_ptr - instance_ptr -> nx_linux_instance_receive_queues), &cpu_set);
+        pthread_setaffinity_np(queue_ptr -> nx_linux_receive_queue_thread, sizeof(cpu_set), &cpu_set);
+#endif /* NX_LINUX_RECEIVE_QUEUE_FIRST_CPU */
     }
 
-    nx_linux_default_ip = ip_ptr;
+#ifdef NX_LINUX_ENABLE_CAPTURE
+    /* Start the capture writer with the first interface.  */
+    pthread_once(&nx_linux_capture_once, _nx_linux_capture_start);
+#endif /* NX_LINUX_ENABLE_CAPTURE */
 
-    /* Create a Linux thread to loop for capturing packets */
-    pthread_create(&nx_linux_receive_thread, NULL, _nx_linux_receive_thread_entry, NULL);
+#ifdef NX_LINUX_ENABLE_IMPAIRMENT
+    /* Seed the impairment and start the timer thread with the first interface.  */
+    _nx_linux_impairment_initialize(instance_ptr);
+    pthread_once(&nx_linux_impairment_once, _nx_linux_impairment_start);
+#endif /* NX_LINUX_ENABLE_IMPAIRMENT */
 
-    /* Set the thread's policy and priority */
-    pthread_setschedparam(nx_linux_receive_thread, SCHED_FIFO, &sp);
+#ifdef NX_LINUX_ENABLE_ASYNC_TRANSMIT
+    /* Create a Linux thread to send queued packets.  */
+    sem_init(&instance_ptr -> nx_linux_instance_transmit_semaphore, 0, 0);
+    pthread_create(&instance_ptr -> nx_linux_instance_transmit_thread, NULL, _nx_linux_transmit_thread_entry, instance_ptr);
+    pthread_setschedparam(instance_ptr -> nx_linux_instance_transmit_thread, SCHED_FIFO, &sp);
+#endif /* NX_LINUX_ENABLE_ASYNC_TRANSMIT */
 
     return NX_SUCCESS;
 }
 
 
-VOID  _nx_linux_network_driver_output(NX_PACKET *packet_ptr)
+#ifdef NX_LINUX_ENABLE_ASYNC_TRANSMIT
+void *_nx_linux_transmit_thread_entry(void *arg)
+{
+NX_LINUX_INSTANCE *instance_ptr = (NX_LINUX_INSTANCE *)arg;
+NX_PACKET         *packet_ptr;
+NX_PACKET         *complete_head;
+NX_PACKET         *complete_tail;
+UINT               tail;
+
+    for (;;)
+    {
+
+        /* Wait for NetX to queue a frame.  */
+        if (sem_wait(&instance_ptr -> nx_linux_instance_transmit_semaphore))
+        {
+            continue;
+        }
+
+        /* Send a batch of queued frames, remembering them for TX completion.  */
+        complete_head = NX_NULL;
+        complete_tail = NX_NULL;
+        tail = instance_ptr -> nx_linux_instance_transmit_queue_tail;
+        while ((tail != __atomic_load_n(&instance_ptr -> nx_linux_instance_transmit_queue_head, __ATOMIC_ACQUIRE)) &&
+               ((tail - instance_ptr -> nx_linux_instance_transmit_queue_tail) < NX_LINUX_TRANSMIT_BATCH_SIZE))
+        {
+            packet_ptr = instance_ptr -> nx_linux_instance_transmit_queue[tail & (NX_LINUX_TRANSMIT_QUEUE_SIZE - 1)];
+            tail++;
+
+            _nx_linux_send_packet(instance_ptr, packet_ptr);
+
+            packet_ptr -> nx_packet_queue_next = NX_NULL;
+            if (complete_tail)
+            {
+                complete_tail -> nx_packet_queue_next = packet_ptr;
+            }
+            else
+            {
+                complete_head = packet_ptr;
+            }
+            complete_tail = packet_ptr;
+        }
+        __atomic_store_n(&instance_ptr -> nx_linux_instance_transmit_queue_tail, tail, __ATOMIC_RELEASE);
+
+#ifdef NX_LINUX_ENABLE_TX_RING
+        if (instance_ptr -> nx_linux_instance_tx_ring)
+        {
+            _nx_linux_tx_ring_flush(instance_ptr);
+        }
+#endif /* NX_LINUX_ENABLE_TX_RING */
+
+        if (complete_head == NX_NULL)
+        {
+            continue;
+        }
+
+        /* Simulate the TX complete interrupt.  */
+        _tx_thread_context_save();
+
+        while (complete_head)
+        {
+            packet_ptr = complete_head;
+            complete_head = packet_ptr -> nx_packet_queue_next;
+            packet_ptr -> nx_packet_queue_next = NX_NULL;
+
+            /* Remove the Ethernet header.  */
+            packet_ptr -> nx_packet_prepend_ptr =  packet_ptr -> nx_packet_prepend_ptr + NX_ETHERNET_SIZE;
+
+            /* Adjust the packet length.  */
+            packet_ptr -> nx_packet_length =  packet_ptr -> nx_packet_length - NX_ETHERNET_SIZE;
+
+            /* Now that the Ethernet frame has been removed, release the packet.  */
+            nx_packet_transmit_release(packet_ptr);
+        }
+
+        _tx_thread_context_restore();
+    }
+    return((void *)0);
+}
+#endif /* NX_LINUX_ENABLE_ASYNC_TRANSMIT */
+
+VOID  _nx_linux_network_driver_output(NX_LINUX_INSTANCE *instance_ptr, NX_PACKET *packet_ptr)
 {
 UINT old_threshold = 0;
+#ifdef NX_LINUX_ENABLE_ASYNC_TRANSMIT
+UINT head;
+#endif /* NX_LINUX_ENABLE_ASYNC_TRANSMIT */
+
+#ifdef NX_LINUX_ENABLE_CAPTURE
+    _nx_linux_capture(instance_ptr, packet_ptr, NX_LINUX_CAPTURE_OUTBOUND);
+#endif /* NX_LINUX_ENABLE_CAPTURE */
 
     /* Disable preemption.  */
     tx_thread_preemption_change(tx_thread_identify(), 0, &old_threshold);
 
-    _nx_linux_send_packet(packet_ptr);
+#ifdef NX_LINUX_ENABLE_XSK
+    /* Send the frame in place on the AF_XDP socket. The packet is released on TX complete.  */
+    if (_nx_linux_xsk_send(instance_ptr, packet_ptr) == NX_SUCCESS)
+    {
+
+        /* Restore preemption.  */
+        tx_thread_preemption_change(tx_thread_identify(), old_threshold, &old_threshold);
+        return;
+    }
+#endif /* NX_LINUX_ENABLE_XSK */
+
+#ifdef NX_LINUX_ENABLE_IO_URING
+    /* Send the frame in place on the io_uring. The packet is released on TX complete.  */
+    if (_nx_linux_io_uring_send(instance_ptr, packet_ptr) == NX_SUCCESS)
+    {
+
+        /* Restore preemption.  */
+        tx_thread_preemption_change(tx_thread_identify(), old_threshold, &old_threshold);
+        return;
+    }
+#endif /* NX_LINUX_ENABLE_IO_URING */
+
+#ifdef NX_LINUX_ENABLE_ASYNC_TRANSMIT
+    head = instance_ptr -> nx_linux_instance_transmit_queue_head;
+    if ((head - __atomic_load_n(&instance_ptr -> nx_linux_instance_transmit_queue_tail, __ATOMIC_ACQUIRE)) < NX_LINUX_TRANSMIT_QUEUE_SIZE)
+    {
+
+        /* Queue the frame for the transmit thread. The packet is released on TX complete.  */
+        instance_ptr -> nx_linux_instance_transmit_queue[head & (NX_LINUX_TRANSMIT_QUEUE_SIZE - 1)] = packet_ptr;
+        __atomic_store_n(&instance_ptr -> nx_linux_instance_transmit_queue_head, head + 1, __ATOMIC_RELEASE);
+        sem_post(&instance_ptr -> nx_linux_instance_transmit_semaphore);
+
+        /* Restore preemption.  */
+        tx_thread_preemption_change(tx_thread_identify(), old_threshold, &old_threshold);
+        return;
+    }
+
+    /* The transmit queue is full. Drop the frame.  */
+    NX_LINUX_STATISTICS_ADD(instance_ptr, tx_queue_full_drops, 1);
+#else
+    _nx_linux_send_packet(instance_ptr, packet_ptr);
+#endif /* NX_LINUX_ENABLE_ASYNC_TRANSMIT */
 
     /* Remove the Ethernet header.  In real hardware environments, this is typically
        done after a transmit complete interrupt.  */
@@ -365,11 +5310,15 @@ UINT old_threshold = 0;
 
 VOID  _nx_linux_network_driver(NX_IP_DRIVER *driver_req_ptr)
 {
-NX_IP        *ip_ptr;
-NX_PACKET    *packet_ptr;
-ULONG        *ethernet_frame_ptr;
-NX_INTERFACE *interface_ptr;
-UINT          interface_index;
+NX_IP             *ip_ptr;
+NX_PACKET         *packet_ptr;
+ULONG             *ethernet_frame_ptr;
+NX_INTERFACE      *interface_ptr;
+UINT               interface_index;
+NX_LINUX_INSTANCE *instance_ptr;
+#ifdef NX_LINUX_ENABLE_STATISTICS
+NX_LINUX_STATISTICS *statistics_ptr;
+#endif /* NX_LINUX_ENABLE_STATISTICS */
 
     /* Setup the IP pointer from the driver request.  */
     ip_ptr =  driver_req_ptr -> nx_ip_driver_ptr;
@@ -383,6 +5332,16 @@ UINT          interface_index;
     /* Obtain the index number of the network interface. */
     interface_index = interface_ptr -> nx_interface_index;
 
+    /* Find the driver instance of the interface, creating it on first use.  */
+    instance_ptr = _nx_linux_instance_get(interface_ptr);
+    if (instance_ptr == NX_NULL)
+    {
+
+        /* Every instance is in use.  The link never comes up, so NetX sends nothing on it.  */
+        driver_req_ptr -> nx_ip_driver_status =  NX_NOT_SUCCESSFUL;
+        return;
+    }
+
     /* Process according to the driver request type in the IP control
        block.  */
     switch (driver_req_ptr -> nx_ip_driver_command)
@@ -411,18 +5370,34 @@ UINT          interface_index;
             incrementing a base lsw value, to simulate multiple nodes hanging on the
             ethernet.  */
             nx_ip_interface_physical_address_set(ip_ptr, interface_index,
-                                                nx_linux_address_msw,
-                                                nx_linux_address_lsw,
+                                                instance_ptr -> nx_linux_instance_address_msw,
+                                                instance_ptr -> nx_linux_instance_address_lsw,
                                                 NX_FALSE);
 
             /* Indicate to the IP software that IP to physical mapping is required.  */
             nx_ip_interface_address_mapping_configure(ip_ptr, interface_index, NX_TRUE);
 
-            _nx_linux_initialize(ip_ptr);
+            instance_ptr -> nx_linux_instance_ip = ip_ptr;
+            _nx_linux_initialize(instance_ptr);
 
 #ifdef NX_ENABLE_INTERFACE_CAPABILITY
+#ifdef NX_LINUX_ENABLE_CHECKSUM_OFFLOAD
+            if (instance_ptr -> nx_linux_instance_vnet_socket < 0)
+            {
+
+                /* Transmit checksums and segments cannot be offloaded without the
+                   virtio-net header.  */
+                nx_ip_interface_capability_set(ip_ptr, interface_index, NX_INTERFACE_RX_CAPABILITY);
+                break;
+            }
+#endif /* NX_LINUX_ENABLE_CHECKSUM_OFFLOAD */
             nx_ip_interface_capability_set(ip_ptr, interface_index, NX_INTERFACE_CAPABILITY);
 #endif /* NX_ENABLE_INTERFACE_CAPABILITY */
+
+#ifdef NX_LINUX_ENABLE_GSO
+            /* Let NetX hand down TCP segments up to the GSO MTU.  */
+            nx_ip_interface_mtu_set(ip_ptr, interface_index, NX_LINUX_GSO_MTU);
+#endif /* NX_LINUX_ENABLE_GSO */
             break;
         }
 
@@ -539,7 +5514,21 @@ UINT          interface_index;
                on the wire.
 
                In this example, the linux network transmit routine is called. */
-            _nx_linux_network_driver_output(packet_ptr);
+#ifdef NX_LINUX_ENABLE_GSO
+            /* NetX sees the GSO MTU, so fragment UDP and ICMP datagrams to the link MTU.  */
+            if ((packet_ptr -> nx_packet_length > NX_LINK_MTU) && _nx_linux_gso_fragment(instance_ptr, packet_ptr))
+            {
+                break;
+            }
+#endif /* NX_LINUX_ENABLE_GSO */
+#ifdef NX_LINUX_ENABLE_IMPAIRMENT
+            /* Drop or hold back the frame as configured.  */
+            if (_nx_linux_impairment_apply(instance_ptr, packet_ptr, NX_LINUX_IMPAIRMENT_TRANSMIT))
+            {
+                break;
+            }
+#endif /* NX_LINUX_ENABLE_IMPAIRMENT */
+            _nx_linux_network_driver_output(instance_ptr, packet_ptr);
             break;
         }
 
@@ -556,6 +5545,9 @@ UINT          interface_index;
             Later if a multicast address is removed, the driver needs
             to reprogram the hash table based on the remaining multicast MAC addresses. */
 
+            driver_req_ptr -> nx_ip_driver_status =
+                _nx_linux_multicast_join(instance_ptr, driver_req_ptr -> nx_ip_driver_physical_address_msw,
+                                         driver_req_ptr -> nx_ip_driver_physical_address_lsw);
             break;
         }
 
@@ -571,6 +5563,9 @@ UINT          interface_index;
             /* The following procedure only applies to our linux network driver, which manages
             multicast MAC addresses by a simple look up table. */
 
+            driver_req_ptr -> nx_ip_driver_status =
+                _nx_linux_multicast_leave(instance_ptr, driver_req_ptr -> nx_ip_driver_physical_address_msw,
+                                          driver_req_ptr -> nx_ip_driver_physical_address_lsw);
             break;
         }
 
@@ -578,10 +5573,57 @@ UINT          interface_index;
         {
 
             /* Return the link status in the supplied return pointer.  */
-            *(driver_req_ptr -> nx_ip_driver_return_ptr) =  ip_ptr -> nx_ip_interface[0].nx_interface_link_up;
+            *(driver_req_ptr -> nx_ip_driver_return_ptr) =  interface_ptr -> nx_interface_link_up;
+            break;
+        }
+
+#ifdef NX_LINUX_ENABLE_STATISTICS
+        case NX_LINK_GET_RX_COUNT:
+        {
+
+            /* Return the number of frames received, including the dropped ones.  */
+            *(driver_req_ptr -> nx_ip_driver_return_ptr) =
+                (ULONG)instance_ptr -> nx_linux_instance_statistics.nx_linux_statistics_rx_frames;
+            break;
+        }
+
+        case NX_LINK_GET_TX_COUNT:
+        {
+
+            /* Return the number of frames handed to the kernel.  */
+            *(driver_req_ptr -> nx_ip_driver_return_ptr) =
+                (ULONG)instance_ptr -> nx_linux_instance_statistics.nx_linux_statistics_tx_frames;
+            break;
+        }
+
+        case NX_LINK_GET_ALLOC_ERRORS:
+        {
+
+            /* Return the number of receive packets that could not be allocated.  */
+            *(driver_req_ptr -> nx_ip_driver_return_ptr) =
+                (ULONG)instance_ptr -> nx_linux_instance_statistics.nx_linux_statistics_allocation_errors;
             break;
         }
 
+        case NX_LINK_GET_ERROR_COUNT:
+        {
+
+            /* Return the frames lost to errors.  Frames filtered out or of an unknown
+               type are not errors.  */
+            statistics_ptr = &instance_ptr -> nx_linux_instance_statistics;
+            *(driver_req_ptr -> nx_ip_driver_return_ptr) =
+                (ULONG)(statistics_ptr -> nx_linux_statistics_rx_short_drops +
+                        statistics_ptr -> nx_linux_statistics_rx_truncated_drops +
+                        statistics_ptr -> nx_linux_statistics_rx_checksum_drops +
+                        statistics_ptr -> nx_linux_statistics_rx_queue_full_drops +
+                        statistics_ptr -> nx_linux_statistics_allocation_errors +
+                        statistics_ptr -> nx_linux_statistics_tx_errors +
+                        statistics_ptr -> nx_linux_statistics_tx_queue_full_drops +
+                        statistics_ptr -> nx_linux_statistics_tx_oversize_drops);
+            break;
+        }
+#endif /* NX_LINUX_ENABLE_STATISTICS */
+
         case NX_LINK_DEFERRED_PROCESSING:
         {
 
@@ -598,9 +5640,30 @@ UINT          interface_index;
             the pending receive process.
             */
 
-            /* The linux driver doesn't require a deferred process so it breaks out of
-            the switch case. */
+#ifdef NX_LINUX_ENABLE_DEFERRED_RECEIVE
+            /* Process the frames queued by the receive threads.  */
+            _nx_linux_deferred_receive_process(instance_ptr);
+#endif /* NX_LINUX_ENABLE_DEFERRED_RECEIVE */
+
+#ifdef NX_LINUX_ENABLE_IMPAIRMENT
+            /* Send and receive the held frames that are due, ahead of the flushes below.  */
+            _nx_linux_impairment_process(instance_ptr);
+#endif /* NX_LINUX_ENABLE_IMPAIRMENT */
+
+#if defined(NX_LINUX_ENABLE_TX_RING) && !defined(NX_LINUX_ENABLE_ASYNC_TRANSMIT)
+            /* Flush the frames queued on the transmit ring during the last burst.  */
+            _nx_linux_tx_ring_flush(instance_ptr);
+#endif /* NX_LINUX_ENABLE_TX_RING && !NX_LINUX_ENABLE_ASYNC_TRANSMIT */
+
+#ifdef NX_LINUX_ENABLE_XSK
+            /* Kick the frames queued on the AF_XDP transmit ring during the last burst.  */
+            _nx_linux_xsk_flush(instance_ptr);
+#endif /* NX_LINUX_ENABLE_XSK */
 
+#ifdef NX_LINUX_ENABLE_IO_URING
+            /* Submit the sends queued during the last burst, and arm the receives the kernel ended.  */
+            _nx_linux_io_uring_flush(instance_ptr);
+#endif /* NX_LINUX_ENABLE_IO_URING */
 
             break;
         }
@@ -609,8 +5672,11 @@ UINT          interface_index;
         {
 
             /* Set mac address.  */
-            nx_linux_address_msw = driver_req_ptr -> nx_ip_driver_physical_address_msw;
-            nx_linux_address_lsw = driver_req_ptr -> nx_ip_driver_physical_address_lsw;
+            instance_ptr -> nx_linux_instance_address_msw = driver_req_ptr -> nx_ip_driver_physical_address_msw;
+            instance_ptr -> nx_linux_instance_address_lsw = driver_req_ptr -> nx_ip_driver_physical_address_lsw;
+#ifdef NX_LINUX_ENABLE_RECEIVE_FILTER
+            _nx_linux_receive_filter_update(instance_ptr);
+#endif /* NX_LINUX_ENABLE_RECEIVE_FILTER */
             break;
         }
 
@@ -0,0 +1,669 @@
+/**************************************************************************/
+/*                                                                        */
+/*       Copyright (c) Microsoft Corporation. All rights reserved.        */
+/*                                                                        */
+/*       This software is licensed under the Microsoft Software License   */
+/*       Terms for Microsoft Azure RTOS. Full text of the license can be  */
+/*       found in the LICENSE file at https://aka.ms/AzureRTOS_EULA       */
+/*       and in the root directory of this software.                      */
+/*                                                                        */
+/**************************************************************************/
+
+/* This driver connects two NetX interfaces with a point-to-point Ethernet link
+   made of two single-producer single-consumer frame rings in shared memory, one
+   per direction.  No kernel network device is involved, so it runs without root
+   privileges and measures the cost of the NetX stack itself.
+
+   By default the link lives in the memory of this process and connects two IP
+   instances created with _nx_shm_network_driver.  Define NX_SHM_LINK_NAME to the
+   name of a POSIX shared memory object, e.g. "/nx_shm_link", to connect two
+   processes instead; each process creates one IP instance on the link.  The
+   first interface initialized takes endpoint 0 and the second endpoint 1.  */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include "nx_api.h"
+
+#ifdef NX_ENABLE_PPPOE
+#include "nx_pppoe_server.h"
+#endif
+
+/* Define the IP MTU of the link.  Frames never leave the process or the host,
+   so it can be raised above the Ethernet MTU to reduce the per-packet cost.  */
+#ifndef NX_SHM_MTU
+#define NX_SHM_MTU                  1500
+#endif
+
+/* Define the Link MTU. Note this is not the same as the IP MTU.  The Link MTU
+   includes the addition of the Physical Network header (usually Ethernet). This
+   should be larger than the IP instance MTU by the size of the physical header. */
+#define NX_LINK_MTU                 (NX_SHM_MTU + NX_ETHERNET_SIZE)
+
+/* Define Ethernet address format.  This is prepended to the incoming IP
+   and ARP/RARP messages.  The frame beginning is 14 bytes, but for speed
+   purposes, we are going to assume there are 16 bytes free in front of the
+   prepend pointer and that the prepend pointer is 32-bit aligned.
+
+   Byte Offset     Size            Meaning
+
+   0           6           Destination Ethernet Address
+   6           6           Source Ethernet Address
+   12          2           Ethernet Frame Type, where:
+
+   0x0800 -> IP Datagram
+   0x0806 -> ARP Request/Reply
+   0x0835 -> RARP request reply
+
+   42          18          Padding on ARP and RARP messages only.  */
+
+#define NX_ETHERNET_IP              0x0800
+#define NX_ETHERNET_ARP             0x0806
+#define NX_ETHERNET_RARP            0x8035
+#define NX_ETHERNET_IPV6            0x86DD
+#define NX_ETHERNET_PPPOE_DISCOVERY 0x8863
+#define NX_ETHERNET_PPPOE_SESSION   0x8864
+#define NX_ETHERNET_SIZE            14
+
+/* Define the number of frames each ring holds.  It must be a power of two.
+   A frame sent while the ring toward the peer is full is dropped.  */
+#ifndef NX_SHM_RING_SIZE
+#define NX_SHM_RING_SIZE            256
+#endif
+
+#if (NX_SHM_RING_SIZE & (NX_SHM_RING_SIZE - 1)) != 0
+#error "NX_SHM_RING_SIZE must be a power of two."
+#endif
+
+/* Define the maximum number of frames the receive thread hands to NetX within
+   one context save/restore window.  */
+#ifndef NX_SHM_RECEIVE_BATCH_SIZE
+#define NX_SHM_RECEIVE_BATCH_SIZE   32
+#endif
+
+/* Define the size of a ring slot, rounded up to a cache line.  */
+#define NX_SHM_SLOT_SIZE            ((NX_LINK_MTU + 63) & ~63)
+
+/* Define the number of interfaces that can be on the link.  */
+#define NX_SHM_ENDPOINT_COUNT       2
+
+/* For the shared memory driver, physical addresses are allocated starting
+   at the preset value and incremented by the endpoint number.  */
+
+ULONG              nx_shm_address_msw =  0x0011;
+ULONG              nx_shm_address_lsw =  0x22334500;
+
+/* Define the frame ring.  The head is written by the sender only and the tail
+   by the receiver only, so they sit on separate cache lines.  The receiver sets
+   the waiting flag before it sleeps on it with a futex.  */
+typedef struct NX_SHM_RING_STRUCT
+{
+    UINT            nx_shm_ring_head __attribute__((aligned(64)));
+    UINT            nx_shm_ring_tail __attribute__((aligned(64)));
+    UINT            nx_shm_ring_waiting;
+    UINT            nx_shm_ring_length[NX_SHM_RING_SIZE] __attribute__((aligned(64)));
+    UCHAR           nx_shm_ring_frames[NX_SHM_RING_SIZE][NX_SHM_SLOT_SIZE] __attribute__((aligned(64)));
+} NX_SHM_RING;
+
+/* Define the link.  Ring N carries the frames sent to endpoint N.  */
+typedef struct NX_SHM_LINK_STRUCT
+{
+    UINT            nx_shm_link_endpoint_count;
+    NX_SHM_RING     nx_shm_link_rings[NX_SHM_ENDPOINT_COUNT];
+} NX_SHM_LINK;
+
+/* Define the driver instance of a NetX interface on the link.  */
+typedef struct NX_SHM_INSTANCE_STRUCT
+{
+    NX_INTERFACE   *nx_shm_instance_interface;
+    NX_IP          *nx_shm_instance_ip;
+    UINT            nx_shm_instance_endpoint;
+    NX_SHM_RING    *nx_shm_instance_receive_ring;
+    NX_SHM_RING    *nx_shm_instance_transmit_ring;
+    pthread_t       nx_shm_instance_receive_thread;
+    ULONG           nx_shm_instance_address_msw;
+    ULONG           nx_shm_instance_address_lsw;
+} NX_SHM_INSTANCE;
+
+static NX_SHM_LINK     *nx_shm_link = NX_NULL;
+static NX_SHM_INSTANCE  nx_shm_instances[NX_SHM_ENDPOINT_COUNT];
+static UINT             nx_shm_instance_count = 0;
+
+/* Define the drop counters.  nx_shm_transmit_drop_count counts the frames sent
+   while the ring toward the peer was full, and nx_shm_receive_drop_count the
+   frames received while no packet was available.  Both are updated atomically,
+   as the transmit path and the receive thread run on different host threads.  */
+ULONG              nx_shm_transmit_drop_count;
+ULONG              nx_shm_receive_drop_count;
+
+
+/* Define driver prototypes.  */
+
+NX_SHM_INSTANCE *_nx_shm_instance_get(NX_INTERFACE *interface_ptr);
+NX_SHM_LINK *_nx_shm_link_map(VOID);
+UINT  _nx_shm_initialize(NX_SHM_INSTANCE *instance_ptr);
+VOID  _nx_shm_ring_wake(NX_SHM_RING *ring_ptr);
+VOID  _nx_shm_ring_wait(NX_SHM_RING *ring_ptr, UINT tail);
+void *_nx_shm_receive_thread_entry(void *arg);
+UINT  _nx_shm_receive_frames(NX_SHM_INSTANCE *instance_ptr, UINT tail, UINT head);
+VOID  _nx_shm_packet_receive(NX_SHM_INSTANCE *instance_ptr, NX_PACKET *packet_ptr);
+VOID  _nx_shm_network_driver_output(NX_SHM_INSTANCE *instance_ptr, NX_PACKET *packet_ptr);
+VOID  _nx_shm_network_driver(NX_IP_DRIVER *driver_req_ptr);
+
+NX_SHM_INSTANCE *_nx_shm_instance_get(NX_INTERFACE *interface_ptr)
+{
+NX_SHM_INSTANCE *instance_ptr;
+UINT             i;
+
+    for (i = 0; i < nx_shm_instance_count; i++)
+    {
+        if (nx_shm_instances[i].nx_shm_instance_interface == interface_ptr)
+        {
+            return(&nx_shm_instances[i]);
+        }
+    }
+
+    if (nx_shm_instance_count == NX_SHM_ENDPOINT_COUNT)
+    {
+        return(NX_NULL);
+    }
+
+    instance_ptr = &nx_shm_instances[nx_shm_instance_count++];
+    memset(instance_ptr, 0, sizeof(NX_SHM_INSTANCE));
+    instance_ptr -> nx_shm_instance_interface = interface_ptr;
+
+    return(instance_ptr);
+}
+
+NX_SHM_LINK *_nx_shm_link_map(VOID)
+{
+VOID *link;
+#ifdef NX_SHM_LINK_NAME
+int   fd;
+
+    /* Both processes open the same object.  A new object reads as zeros, which
+       is an empty link.  */
+    fd = shm_open(NX_SHM_LINK_NAME, O_RDWR | O_CREAT, 0600);
+    if (fd < 0)
+    {
+        return(NX_NULL);
+    }
+
+    if (ftruncate(fd, sizeof(NX_SHM_LINK)) < 0)
+    {
+        close(fd);
+        return(NX_NULL);
+    }
+
+    link = mmap(NX_NULL, sizeof(NX_SHM_LINK), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+#else
+    link = mmap(NX_NULL, sizeof(NX_SHM_LINK), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+#endif /* NX_SHM_LINK_NAME */
+
+    if (link == MAP_FAILED)
+    {
+        return(NX_NULL);
+    }
+
+    return((NX_SHM_LINK *)link);
+}
+
+UINT _nx_shm_initialize(NX_SHM_INSTANCE *instance_ptr)
+{
+struct sched_param sp;
+UINT               endpoint;
+
+    /* Define the thread's priority. */
+#ifdef TX_LINUX_PRIORITY_ISR
+    sp.sched_priority = TX_LINUX_PRIORITY_ISR;
+#else
+    sp.sched_priority = 2;
+#endif
+
+    /* Return if the interface is already on the link.  */
+    if (instance_ptr -> nx_shm_instance_receive_ring)
+    {
+        return(NX_ALREADY_ENABLED);
+    }
+
+    if (nx_shm_link == NX_NULL)
+    {
+        nx_shm_link = _nx_shm_link_map();
+        if (nx_shm_link == NX_NULL)
+        {
+            return(NX_NOT_CREATED);
+        }
+    }
+
+    /* Claim the next endpoint of the link.  */
+    endpoint = __atomic_fetch_add(&nx_shm_link -> nx_shm_link_endpoint_count, 1, __ATOMIC_ACQ_REL);
+    if (endpoint >= NX_SHM_ENDPOINT_COUNT)
+    {
+
+        /* Both ends are taken.  A named link may be left over from an earlier run
+           that did not complete; remove it from /dev/shm and start again.  */
+        return(NX_NOT_SUCCESSFUL);
+    }
+
+#ifdef NX_SHM_LINK_NAME
+    if (endpoint == NX_SHM_ENDPOINT_COUNT - 1)
+    {
+
+        /* Both processes have mapped the link.  Remove the name so the next run
+           starts from an empty link.  */
+        shm_unlink(NX_SHM_LINK_NAME);
+    }
+#endif /* NX_SHM_LINK_NAME */
+
+    instance_ptr -> nx_shm_instance_endpoint = endpoint;
+    instance_ptr -> nx_shm_instance_receive_ring = &nx_shm_link -> nx_shm_link_rings[endpoint];
+    instance_ptr -> nx_shm_instance_transmit_ring = &nx_shm_link -> nx_shm_link_rings[endpoint ^ 1];
+    instance_ptr -> nx_shm_instance_address_msw = nx_shm_address_msw;
+    instance_ptr -> nx_shm_instance_address_lsw = nx_shm_address_lsw + endpoint;
+
+    /* Create a Linux thread to loop for receiving frames.  */
+    pthread_create(&instance_ptr -> nx_shm_instance_receive_thread, NULL, _nx_shm_receive_thread_entry, instance_ptr);
+
+    /* Set the thread's policy and priority */
+    pthread_setschedparam(instance_ptr -> nx_shm_instance_receive_thread, SCHED_FIFO, &sp);
+
+    return(NX_SUCCESS);
+}
+
+VOID _nx_shm_ring_wake(NX_SHM_RING *ring_ptr)
+{
+
+    /* Wake the receiver only if it is about to sleep or sleeping.  */
+    if (__atomic_exchange_n(&ring_ptr -> nx_shm_ring_waiting, 0, __ATOMIC_SEQ_CST))
+    {
+        syscall(SYS_futex, &ring_ptr -> nx_shm_ring_waiting, FUTEX_WAKE, 1, NX_NULL, NX_NULL, 0);
+    }
+}
+
+VOID _nx_shm_ring_wait(NX_SHM_RING *ring_ptr, UINT tail)
+{
+
+    /* Announce the sleep before checking the head one last time.  A sender that
+       publishes after the check sees the flag and wakes us; the futex returns at
+       once if it cleared the flag before we sleep.  */
+    __atomic_store_n(&ring_ptr -> nx_shm_ring_waiting, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ring_ptr -> nx_shm_ring_head, __ATOMIC_SEQ_CST) == tail)
+    {
+        syscall(SYS_futex, &ring_ptr -> nx_shm_ring_waiting, FUTEX_WAIT, 1, NX_NULL, NX_NULL, 0);
+    }
+    __atomic_store_n(&ring_ptr -> nx_shm_ring_waiting, 0, __ATOMIC_RELAXED);
+}
+
+void *_nx_shm_receive_thread_entry(void *arg)
+{
+NX_SHM_INSTANCE *instance_ptr = (NX_SHM_INSTANCE *)arg;
+NX_SHM_RING     *ring_ptr = instance_ptr -> nx_shm_instance_receive_ring;
+UINT             head;
+UINT             tail;
+
+    /* Loop to receive frames. */
+    for (;;)
+    {
+        tail = ring_ptr -> nx_shm_ring_tail;
+        head = __atomic_load_n(&ring_ptr -> nx_shm_ring_head, __ATOMIC_ACQUIRE);
+        if (head == tail)
+        {
+            _nx_shm_ring_wait(ring_ptr, tail);
+            continue;
+        }
+
+        _tx_thread_context_save();
+        tail = _nx_shm_receive_frames(instance_ptr, tail, head);
+        _tx_thread_context_restore();
+
+        /* Give the slots back to the sender.  */
+        __atomic_store_n(&ring_ptr -> nx_shm_ring_tail, tail, __ATOMIC_RELEASE);
+    }
+    return((void *)0);
+}
+
+UINT _nx_shm_receive_frames(NX_SHM_INSTANCE *instance_ptr, UINT tail, UINT head)
+{
+NX_PACKET_POOL *pool_ptr = instance_ptr -> nx_shm_instance_ip -> nx_ip_default_packet_pool;
+NX_SHM_RING    *ring_ptr = instance_ptr -> nx_shm_instance_receive_ring;
+NX_PACKET      *packet_ptr;
+UINT            length;
+UINT            count;
+
+    for (count = 0; (tail != head) && (count < NX_SHM_RECEIVE_BATCH_SIZE); tail++, count++)
+    {
+        length = ring_ptr -> nx_shm_ring_length[tail & (NX_SHM_RING_SIZE - 1)];
+
+        /* Drop frames that are too short to carry an Ethernet header, or for which
+           no packet is available.  */
+        if ((length < NX_ETHERNET_SIZE) || (length > NX_LINK_MTU) ||
+            nx_packet_allocate(pool_ptr, &packet_ptr, NX_RECEIVE_PACKET, NX_NO_WAIT))
+        {
+            __atomic_fetch_add(&nx_shm_receive_drop_count, 1, __ATOMIC_RELAXED);
+            continue;
+        }
+
+        /* Make sure IP header is 4-byte aligned. */
+        packet_ptr -> nx_packet_prepend_ptr += 2;
+        packet_ptr -> nx_packet_append_ptr += 2;
+
+        /* Copy the frame into the packet, chaining if the payload is small.  */
+        if (nx_packet_data_append(packet_ptr, ring_ptr -> nx_shm_ring_frames[tail & (NX_SHM_RING_SIZE - 1)],
+                                  length, pool_ptr, NX_NO_WAIT))
+        {
+            nx_packet_release(packet_ptr);
+            __atomic_fetch_add(&nx_shm_receive_drop_count, 1, __ATOMIC_RELAXED);
+            continue;
+        }
+
+        _nx_shm_packet_receive(instance_ptr, packet_ptr);
+    }
+
+    return(tail);
+}
+
+VOID _nx_shm_packet_receive(NX_SHM_INSTANCE *instance_ptr, NX_PACKET *packet_ptr)
+{
+NX_IP *ip_ptr = instance_ptr -> nx_shm_instance_ip;
+UINT   packet_type;
+
+    packet_ptr -> nx_packet_address.nx_packet_interface_ptr = instance_ptr -> nx_shm_instance_interface;
+
+    /* Pickup the packet header to determine where the packet needs to be sent.  */
+    packet_type =  (((UINT)(*(packet_ptr -> nx_packet_prepend_ptr + 12))) << 8) |
+                    ((UINT)(*(packet_ptr -> nx_packet_prepend_ptr + 13)));
+
+    /* Clean off the Ethernet header.  */
+    packet_ptr -> nx_packet_prepend_ptr =  packet_ptr -> nx_packet_prepend_ptr + NX_ETHERNET_SIZE;
+
+    /* Adjust the packet length.  */
+    packet_ptr -> nx_packet_length =  packet_ptr -> nx_packet_length - NX_ETHERNET_SIZE;
+
+    /* Route the incoming packet according to its ethernet type.  */
+    if ((packet_type == NX_ETHERNET_IP) || (packet_type == NX_ETHERNET_IPV6))
+    {
+        _nx_ip_packet_deferred_receive(ip_ptr, packet_ptr);
+    }
+    else if (packet_type == NX_ETHERNET_ARP)
+    {
+        _nx_arp_packet_deferred_receive(ip_ptr, packet_ptr);
+    }
+    else if (packet_type == NX_ETHERNET_RARP)
+    {
+        _nx_rarp_packet_deferred_receive(ip_ptr, packet_ptr);
+    }
+#ifdef NX_ENABLE_PPPOE
+    else if ((packet_type == NX_ETHERNET_PPPOE_DISCOVERY) ||
+             (packet_type == NX_ETHERNET_PPPOE_SESSION))
+    {
+
+        /* Route to the PPPoE receive function.  */
+        _nx_pppoe_packet_deferred_receive(packet_ptr);
+    }
+#endif
+    else
+    {
+
+        /* Invalid ethernet header... release the packet.  */
+        nx_packet_release(packet_ptr);
+    }
+}
+
+VOID  _nx_shm_network_driver_output(NX_SHM_INSTANCE *instance_ptr, NX_PACKET *packet_ptr)
+{
+NX_SHM_RING *ring_ptr = instance_ptr -> nx_shm_instance_transmit_ring;
+UINT         old_threshold = 0;
+UINT         head;
+UCHAR       *frame_ptr;
+ULONG        size = 0;
+
+    /* Disable preemption, so the NetX threads sending on this interface take turns
+       as the single producer of the ring.  */
+    tx_thread_preemption_change(tx_thread_identify(), 0, &old_threshold);
+
+    head = ring_ptr -> nx_shm_ring_head;
+    if ((packet_ptr -> nx_packet_length > NX_LINK_MTU) ||
+        ((head - __atomic_load_n(&ring_ptr -> nx_shm_ring_tail, __ATOMIC_ACQUIRE)) >= NX_SHM_RING_SIZE))
+    {
+
+        /* The frame is too large or the peer is not keeping up. Drop the frame.  */
+        __atomic_fetch_add(&nx_shm_transmit_drop_count, 1, __ATOMIC_RELAXED);
+    }
+    else
+    {
+
+        /* Copy the frame into the slot, linearizing chained packets in place.  */
+        frame_ptr = ring_ptr -> nx_shm_ring_frames[head & (NX_SHM_RING_SIZE - 1)];
+#ifndef NX_DISABLE_PACKET_CHAIN
+        if (packet_ptr -> nx_packet_next)
+        {
+            nx_packet_data_retrieve(packet_ptr, frame_ptr, &size);
+        }
+        else
+#endif /* NX_DISABLE_PACKET_CHAIN */
+        {
+            size = packet_ptr -> nx_packet_length;
+            memcpy(frame_ptr, packet_ptr -> nx_packet_prepend_ptr, size);
+        }
+        ring_ptr -> nx_shm_ring_length[head & (NX_SHM_RING_SIZE - 1)] = (UINT)size;
+
+        /* Publish the frame, then wake the peer if it is sleeping.  */
+        __atomic_store_n(&ring_ptr -> nx_shm_ring_head, head + 1, __ATOMIC_SEQ_CST);
+        _nx_shm_ring_wake(ring_ptr);
+    }
+
+    /* Remove the Ethernet header.  */
+    packet_ptr -> nx_packet_prepend_ptr =  packet_ptr -> nx_packet_prepend_ptr + NX_ETHERNET_SIZE;
+
+    /* Adjust the packet length.  */
+    packet_ptr -> nx_packet_length =  packet_ptr -> nx_packet_length - NX_ETHERNET_SIZE;
+
+    /* Now that the Ethernet frame has been removed, release the packet.  */
+    nx_packet_transmit_release(packet_ptr);
+
+    /* Restore preemption.  */
+    tx_thread_preemption_change(tx_thread_identify(), old_threshold, &old_threshold);
+}
+
+
+VOID  _nx_shm_network_driver(NX_IP_DRIVER *driver_req_ptr)
+{
+NX_IP           *ip_ptr;
+NX_PACKET       *packet_ptr;
+ULONG           *ethernet_frame_ptr;
+NX_INTERFACE    *interface_ptr;
+UINT             interface_index;
+NX_SHM_INSTANCE *instance_ptr;
+
+    /* Setup the IP pointer from the driver request.  */
+    ip_ptr =  driver_req_ptr -> nx_ip_driver_ptr;
+
+    /* Default to successful return.  */
+    driver_req_ptr -> nx_ip_driver_status =  NX_SUCCESS;
+
+    /* Setup interface pointer.  */
+    interface_ptr = driver_req_ptr -> nx_ip_driver_interface;
+
+    /* Obtain the index number of the network interface. */
+    interface_index = interface_ptr -> nx_interface_index;
+
+    /* Find the driver instance of the interface, creating it on first use.  */
+    instance_ptr = _nx_shm_instance_get(interface_ptr);
+    if (instance_ptr == NX_NULL)
+    {
+
+        /* The link has no free endpoint.  The link never comes up, so NetX sends nothing on it.  */
+        driver_req_ptr -> nx_ip_driver_status =  NX_NOT_SUCCESSFUL;
+        return;
+    }
+
+    /* Process according to the driver request type in the IP control
+       block.  */
+    switch (driver_req_ptr -> nx_ip_driver_command)
+    {
+
+        case NX_LINK_INTERFACE_ATTACH:
+        {
+            break;
+        }
+
+        case NX_LINK_INITIALIZE:
+        {
+
+            /* Join the link, which also picks the MAC address of the endpoint.  */
+            instance_ptr -> nx_shm_instance_ip = ip_ptr;
+            driver_req_ptr -> nx_ip_driver_status = _nx_shm_initialize(instance_ptr);
+            if (driver_req_ptr -> nx_ip_driver_status)
+            {
+                break;
+            }
+
+            /* The nx_interface_ip_mtu_size should be the MTU for the IP payload.  */
+            nx_ip_interface_mtu_set(ip_ptr, interface_index, NX_SHM_MTU);
+
+            /* Set the physical address (MAC address) of this IP instance.  */
+            nx_ip_interface_physical_address_set(ip_ptr, interface_index,
+                                                 instance_ptr -> nx_shm_instance_address_msw,
+                                                 instance_ptr -> nx_shm_instance_address_lsw,
+                                                 NX_FALSE);
+
+            /* Indicate to the IP software that IP to physical mapping is required.  */
+            nx_ip_interface_address_mapping_configure(ip_ptr, interface_index, NX_TRUE);
+            break;
+        }
+
+        case NX_LINK_ENABLE:
+        {
+
+            /* In the driver, just set the enabled flag.  */
+            interface_ptr -> nx_interface_link_up =  NX_TRUE;
+            break;
+        }
+
+        case NX_LINK_DISABLE:
+        {
+
+            /* In the driver, just clear the enabled flag.  */
+            interface_ptr -> nx_interface_link_up =  NX_FALSE;
+            break;
+        }
+
+        case NX_LINK_PACKET_SEND:
+        case NX_LINK_PACKET_BROADCAST:
+        case NX_LINK_ARP_SEND:
+        case NX_LINK_ARP_RESPONSE_SEND:
+        case NX_LINK_RARP_SEND:
+#ifdef NX_ENABLE_PPPOE
+        case NX_LINK_PPPOE_DISCOVERY_SEND:
+        case NX_LINK_PPPOE_SESSION_SEND:
+#endif
+        {
+
+            /* Place the ethernet frame at the front of the packet.  */
+            packet_ptr =  driver_req_ptr -> nx_ip_driver_packet;
+
+            /* Adjust the prepend pointer.  */
+            packet_ptr -> nx_packet_prepend_ptr =  packet_ptr -> nx_packet_prepend_ptr - NX_ETHERNET_SIZE;
+
+            /* Adjust the packet length.  */
+            packet_ptr -> nx_packet_length =  packet_ptr -> nx_packet_length + NX_ETHERNET_SIZE;
+
+            /* Setup the ethernet frame pointer to build the ethernet frame.  Backup another 2
+               bytes to get 32-bit word alignment.  */
+            ethernet_frame_ptr =  (ULONG *)(packet_ptr -> nx_packet_prepend_ptr - 2);
+
+            /* Build the ethernet frame.  */
+            *ethernet_frame_ptr     =  driver_req_ptr -> nx_ip_driver_physical_address_msw;
+            *(ethernet_frame_ptr + 1) =  driver_req_ptr -> nx_ip_driver_physical_address_lsw;
+            *(ethernet_frame_ptr + 2) =  (interface_ptr -> nx_interface_physical_address_msw << 16) |
+                (interface_ptr -> nx_interface_physical_address_lsw >> 16);
+            *(ethernet_frame_ptr + 3) =  (interface_ptr -> nx_interface_physical_address_lsw << 16);
+
+            if ((driver_req_ptr -> nx_ip_driver_command == NX_LINK_ARP_SEND) ||
+                (driver_req_ptr -> nx_ip_driver_command == NX_LINK_ARP_RESPONSE_SEND))
+            {
+                *(ethernet_frame_ptr + 3) |= NX_ETHERNET_ARP;
+            }
+            else if (driver_req_ptr -> nx_ip_driver_command == NX_LINK_RARP_SEND)
+            {
+                *(ethernet_frame_ptr + 3) |= NX_ETHERNET_RARP;
+            }
+#ifdef NX_ENABLE_PPPOE
+            else if (driver_req_ptr -> nx_ip_driver_command == NX_LINK_PPPOE_DISCOVERY_SEND)
+            {
+                *(ethernet_frame_ptr + 3) |= NX_ETHERNET_PPPOE_DISCOVERY;
+            }
+            else if (driver_req_ptr -> nx_ip_driver_command == NX_LINK_PPPOE_SESSION_SEND)
+            {
+                *(ethernet_frame_ptr + 3) |= NX_ETHERNET_PPPOE_SESSION;
+            }
+#endif
+            else if (packet_ptr -> nx_packet_ip_version == 4)
+            {
+                *(ethernet_frame_ptr + 3) |= NX_ETHERNET_IP;
+            }
+            else
+            {
+                *(ethernet_frame_ptr + 3) |= NX_ETHERNET_IPV6;
+            }
+
+            /* Endian swapping if NX_LITTLE_ENDIAN is defined.  */
+            NX_CHANGE_ULONG_ENDIAN(*(ethernet_frame_ptr));
+            NX_CHANGE_ULONG_ENDIAN(*(ethernet_frame_ptr + 1));
+            NX_CHANGE_ULONG_ENDIAN(*(ethernet_frame_ptr + 2));
+            NX_CHANGE_ULONG_ENDIAN(*(ethernet_frame_ptr + 3));
+
+            /* Put the frame on the ring toward the peer.  */
+            _nx_shm_network_driver_output(instance_ptr, packet_ptr);
+            break;
+        }
+
+        case NX_LINK_MULTICAST_JOIN:
+        case NX_LINK_MULTICAST_LEAVE:
+        {
+
+            /* Every frame sent on the link reaches the peer, so there is no
+               multicast filter to program.  */
+            break;
+        }
+
+        case NX_LINK_GET_STATUS:
+        {
+
+            /* Return the link status in the supplied return pointer.  */
+            *(driver_req_ptr -> nx_ip_driver_return_ptr) =  interface_ptr -> nx_interface_link_up;
+            break;
+        }
+
+        case NX_LINK_DEFERRED_PROCESSING:
+        {
+
+            /* Frames are handed to NetX by the receive thread.  */
+            break;
+        }
+
+        case NX_LINK_SET_PHYSICAL_ADDRESS:
+        {
+
+            /* Set mac address.  */
+            instance_ptr -> nx_shm_instance_address_msw = driver_req_ptr -> nx_ip_driver_physical_address_msw;
+            instance_ptr -> nx_shm_instance_address_lsw = driver_req_ptr -> nx_ip_driver_physical_address_lsw;
+            break;
+        }
+
+        default:
+        {
+
+            /* Invalid driver request.  */
+            /* Return the unhandled command status.  */
+            driver_req_ptr -> nx_ip_driver_status =  NX_UNHANDLED_COMMAND;
+        }
+    }
+}
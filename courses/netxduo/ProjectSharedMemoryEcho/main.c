@@ -0,0 +1,335 @@
+/**************************************************************************/
+/*                                                                        */
+/*       Copyright (c) Microsoft Corporation. All rights reserved.        */
+/*                                                                        */
+/*       This software is licensed under the Microsoft Software License   */
+/*       Terms for Microsoft Azure RTOS. Full text of the license can be  */
+/*       found in the LICENSE file at https://aka.ms/AzureRTOS_EULA       */
+/*       and in the root directory of this software.                      */
+/*                                                                        */
+/**************************************************************************/
+
+/* This sample runs a UDP echo server and client in one process, each on its own IP
+   instance, joined by the shared memory driver.  It needs no network device and no
+   privileges, and measures the round trip through the NetX stack alone.  */
+
+#include   "tx_api.h"
+#include   "nx_api.h"
+#include   "sample_histogram.h"
+#include   <time.h>
+
+/* Define sample IP addresses.  */
+#define SERVER_IPV4_ADDRESS             IP_ADDRESS(192, 168, 1, 1)
+#define CLIENT_IPV4_ADDRESS             IP_ADDRESS(192, 168, 1, 2)
+#define SAMPLE_IPV4_MASK                0xFFFFFF00UL
+
+/* Define ECHO server port, data and the number of round trips.  */
+#define ECHO_SERVER_PORT                7
+#define ECHO_DATA                       "ABCDEFGHIJKLMNOPQRSTUVWXYZ "
+#define ECHO_RECEIVE_TIMEOUT            NX_IP_PERIODIC_RATE
+#define ECHO_COUNT                      10000
+
+/* Define packet pool.  */
+#define PACKET_SIZE                     1536
+#define PACKET_COUNT                    30
+#define PACKET_POOL_SIZE                ((PACKET_SIZE + sizeof(NX_PACKET)) * PACKET_COUNT)
+
+/* Define IP stack size.   */
+#define IP_STACK_SIZE                   2048
+
+/* Define IP thread priority.  */
+#define IP_THREAD_PRIORITY              1
+
+/* Define stack size of sample threads.  */
+#define SAMPLE_THREAD_STACK_SIZE        2048
+
+/* Define priority of sample threads.  */
+#define SERVER_THREAD_PRIORITY          3
+#define CLIENT_THREAD_PRIORITY          4
+
+/* Define ARP pool.  */
+#define ARP_POOL_SIZE                   1024
+
+/* Define UDP socket TTL and receive queue size.  */
+#define SAMPLE_SOCKET_TTL               0x80
+#define SAMPLE_SOCKET_RX_QUEUE_MAXIMUM  5
+
+/* Define the ThreadX and NetX object control blocks...  */
+NX_PACKET_POOL          default_pool;
+NX_IP                   server_ip;
+NX_IP                   client_ip;
+NX_UDP_SOCKET           udp_server;
+NX_UDP_SOCKET           udp_client;
+TX_THREAD               server_thread;
+TX_THREAD               client_thread;
+
+/* Define memory buffers.  */
+ULONG                   pool_area[PACKET_POOL_SIZE >> 2];
+ULONG                   server_ip_stack[IP_STACK_SIZE >> 2];
+ULONG                   client_ip_stack[IP_STACK_SIZE >> 2];
+ULONG                   server_arp_area[ARP_POOL_SIZE >> 2];
+ULONG                   client_arp_area[ARP_POOL_SIZE >> 2];
+ULONG                   server_thread_stack[SAMPLE_THREAD_STACK_SIZE >> 2];
+ULONG                   client_thread_stack[SAMPLE_THREAD_STACK_SIZE >> 2];
+
+/* Define the counters and the round trip times of the demo application...  */
+ULONG                   error_counter;
+ULONG                   echo_received;
+SAMPLE_HISTOGRAM        echo_latency;
+
+/***** Substitute your ethernet driver entry function here *********/
+extern  VOID SAMPLE_NETWORK_DRIVER(NX_IP_DRIVER*);
+
+/* Define thread prototypes.  */
+void server_thread_entry(ULONG thread_input);
+void client_thread_entry(ULONG thread_input);
+static ULONG64 echo_time_get(VOID);
+
+/* Define main entry point.  */
+int main()
+{
+
+    /* Enter the ThreadX kernel.  */
+    tx_kernel_enter();
+}
+
+
+/* Define what the initial system looks like.  */
+void    tx_application_define(void *first_unused_memory)
+{
+
+UINT    status;
+
+    NX_PARAMETER_NOT_USED(first_unused_memory);
+
+    /* Initialize the NetX system.  */
+    nx_system_initialize();
+
+    /* Create the sample threads.  */
+    tx_thread_create(&server_thread, "Server Thread", server_thread_entry, 0,
+                     server_thread_stack, sizeof(server_thread_stack),
+                     SERVER_THREAD_PRIORITY, SERVER_THREAD_PRIORITY, TX_NO_TIME_SLICE, TX_AUTO_START);
+    tx_thread_create(&client_thread, "Client Thread", client_thread_entry, 0,
+                     client_thread_stack, sizeof(client_thread_stack),
+                     CLIENT_THREAD_PRIORITY, CLIENT_THREAD_PRIORITY, TX_NO_TIME_SLICE, TX_AUTO_START);
+
+    /* Create a packet pool shared by both IP instances.  */
+    status = nx_packet_pool_create(&default_pool, "NetX Main Packet Pool",
+                                   PACKET_SIZE, pool_area, sizeof(pool_area));
+
+    /* Check for packet pool create errors.  */
+    if (status)
+        error_counter++;
+
+    /* Create the server IP instance; it takes endpoint 0 of the link.  */
+    status = nx_ip_create(&server_ip, "NetX IP Instance 0", SERVER_IPV4_ADDRESS, SAMPLE_IPV4_MASK,
+                          &default_pool, SAMPLE_NETWORK_DRIVER,
+                          (void *)server_ip_stack, sizeof(server_ip_stack), IP_THREAD_PRIORITY);
+
+    /* Check for IP create errors.  */
+    if (status)
+        error_counter++;
+
+    /* Create the client IP instance; it takes endpoint 1 of the link.  */
+    status = nx_ip_create(&client_ip, "NetX IP Instance 1", CLIENT_IPV4_ADDRESS, SAMPLE_IPV4_MASK,
+                          &default_pool, SAMPLE_NETWORK_DRIVER,
+                          (void *)client_ip_stack, sizeof(client_ip_stack), IP_THREAD_PRIORITY);
+
+    /* Check for IP create errors.  */
+    if (status)
+        error_counter++;
+
+    /* Enable ARP and supply ARP cache memory for both IP instances.  */
+    status =  nx_arp_enable(&server_ip, (void *)server_arp_area, sizeof(server_arp_area));
+    status += nx_arp_enable(&client_ip, (void *)client_arp_area, sizeof(client_arp_area));
+
+    /* Check for ARP enable errors.  */
+    if (status)
+        error_counter++;
+
+    /* Enable UDP */
+    status =  nx_udp_enable(&server_ip);
+    status += nx_udp_enable(&client_ip);
+
+    /* Check for UDP enable errors.  */
+    if(status)
+        error_counter++;
+
+    sample_histogram_reset(&echo_latency);
+
+    printf("NetXDuo is running\r\n");
+}
+
+
+/* Server thread entry.  */
+void server_thread_entry(ULONG thread_input)
+{
+UINT       status;
+NX_PACKET *packet_ptr;
+NXD_ADDRESS echo_client_address;
+UINT echo_client_port;
+
+    /* Create a UDP socket.  */
+    status = nx_udp_socket_create(&server_ip, &udp_server, "UDP Echo Server", NX_IP_NORMAL, NX_FRAGMENT_OKAY,
+                                  SAMPLE_SOCKET_TTL, SAMPLE_SOCKET_RX_QUEUE_MAXIMUM);
+
+    /* Check status.  */
+    if (status)
+    {
+        error_counter++;
+        return;
+    }
+
+    /* Bind the UDP socket to echo port.  */
+    status =  nx_udp_socket_bind(&udp_server, ECHO_SERVER_PORT, NX_WAIT_FOREVER);
+
+    /* Check status.  */
+    if (status)
+    {
+        error_counter++;
+        return;
+    }
+
+    /* Loop to echo data from client.  */
+    for (;;)
+    {
+
+        /* Receive a packet.  */
+        status =  nx_udp_socket_receive(&udp_server, &packet_ptr, NX_WAIT_FOREVER);
+
+        /* Check status.  */
+        if (status != NX_SUCCESS)
+        {
+            error_counter++;
+            break;
+        }
+
+        /* Get address of peer.  */
+        status = nxd_udp_source_extract(packet_ptr, &echo_client_address, &echo_client_port);
+
+        /* Echo data to client.  */
+        status =  nxd_udp_socket_send(&udp_server, packet_ptr, &echo_client_address, echo_client_port);
+
+        /* Check status.  */
+        if (status != NX_SUCCESS)
+        {
+            nx_packet_release(packet_ptr);
+            error_counter++;
+            break;
+        }
+    }
+
+    /* Cleanup the UDP socket.  */
+    nx_udp_socket_unbind(&udp_server);
+    nx_udp_socket_delete(&udp_server);
+}
+
+
+/* Client thread entry.  */
+void client_thread_entry(ULONG thread_input)
+{
+UINT        status;
+NX_PACKET  *packet_ptr;
+NXD_ADDRESS echo_server_address;
+ULONG       i;
+ULONG64     start_time;
+ULONG64     send_time;
+ULONG64     now;
+
+    /* Create a UDP socket.  */
+    status = nx_udp_socket_create(&client_ip, &udp_client, "UDP Echo Client", NX_IP_NORMAL, NX_FRAGMENT_OKAY,
+                                  SAMPLE_SOCKET_TTL, SAMPLE_SOCKET_RX_QUEUE_MAXIMUM);
+
+    /* Check status.  */
+    if (status)
+    {
+        error_counter++;
+        return;
+    }
+
+    /* Bind the UDP socket to any port.  */
+    status =  nx_udp_socket_bind(&udp_client, NX_ANY_PORT, NX_WAIT_FOREVER);
+
+    /* Check status.  */
+    if (status)
+    {
+        error_counter++;
+        return;
+    }
+
+    echo_server_address.nxd_ip_version = NX_IP_VERSION_V4;
+    echo_server_address.nxd_ip_address.v4 = SERVER_IPV4_ADDRESS;
+
+    start_time = echo_time_get();
+
+    /* Send the echo requests one at a time.  */
+    for (i = 0; i < ECHO_COUNT; i++)
+    {
+
+        /* Allocate a packet.  */
+        status =  nx_packet_allocate(&default_pool, &packet_ptr, NX_UDP_PACKET, NX_WAIT_FOREVER);
+
+        /* Check status.  */
+        if (status != NX_SUCCESS)
+        {
+            error_counter++;
+            break;
+        }
+
+        /* Write ABCs into the packet payload.  */
+        nx_packet_data_append(packet_ptr, ECHO_DATA, sizeof(ECHO_DATA), &default_pool, TX_WAIT_FOREVER);
+
+        send_time = echo_time_get();
+
+        /* Send the packet.  */
+        status =  nxd_udp_socket_send(&udp_client, packet_ptr, &echo_server_address, ECHO_SERVER_PORT);
+
+        /* Check status.  */
+        if (status != NX_SUCCESS)
+        {
+            nx_packet_release(packet_ptr);
+            error_counter++;
+            continue;
+        }
+
+        /* Receive the echo.  */
+        status =  nx_udp_socket_receive(&udp_client, &packet_ptr, ECHO_RECEIVE_TIMEOUT);
+
+        /* Check status.  */
+        if (status != NX_SUCCESS)
+        {
+            error_counter++;
+            continue;
+        }
+
+        now = echo_time_get();
+        sample_histogram_record(&echo_latency, (ULONG)(now - send_time));
+        echo_received++;
+
+        /* Release the packet.  */
+        nx_packet_release(packet_ptr);
+    }
+
+    now = echo_time_get();
+
+    /* Output the result.  */
+    printf("Echoed %lu of %lu in %lu us, %lu round trips per second, errors %lu\r\n",
+           echo_received, (ULONG)ECHO_COUNT, (ULONG)(now - start_time),
+           (now > start_time) ? (ULONG)((ULONG64)echo_received * 1000000 / (now - start_time)) : 0,
+           error_counter);
+    sample_histogram_print(&echo_latency, "Round trip", "us");
+
+    /* Cleanup the UDP socket.  */
+    nx_udp_socket_unbind(&udp_client);
+    nx_udp_socket_delete(&udp_client);
+}
+
+
+/* Read the host clock in microseconds; ThreadX ticks are too coarse for echo latency.  */
+static ULONG64 echo_time_get(VOID)
+{
+struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return((ULONG64)now.tv_sec * 1000000 + (ULONG64)now.tv_nsec / 1000);
+}
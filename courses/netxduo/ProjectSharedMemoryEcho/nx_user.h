@@ -0,0 +1,8 @@
+#ifndef NX_USER_H
+#define NX_USER_H
+
+#ifndef SAMPLE_NETWORK_DRIVER
+#define SAMPLE_NETWORK_DRIVER _nx_shm_network_driver
+#endif
+
+#endif
@@ -11,6 +11,10 @@
 
 #include   "tx_api.h"
 #include   "nx_api.h"
+#ifdef SAMPLE_ENABLE_LOAD_GENERATOR
+#include   "sample_histogram.h"
+#include   <time.h>
+#endif /* SAMPLE_ENABLE_LOAD_GENERATOR */
 
 /* Make sure IPv6 is enabled.  */
 #if !defined(FEATURE_NX_IPV6) || !defined(NX_ENABLE_IPV6_ADDRESS_CHANGE_NOTIFY)
@@ -36,9 +40,55 @@
 #define ECHO_DATA                       "ABCDEFGHIJKLMNOPQRSTUVWXYZ "
 #define ECHO_RECEIVE_TIMEOUT            NX_IP_PERIODIC_RATE
 
+/* Define the load generator mode.  With SAMPLE_ENABLE_LOAD_GENERATOR defined the client opens
+   SAMPLE_LOAD_CONNECTIONS connections to the echo server, each with its own thread, and keeps
+   up to SAMPLE_LOAD_PIPELINE requests outstanding on each.  Request sizes are drawn uniformly
+   from SAMPLE_LOAD_MESSAGE_MIN to SAMPLE_LOAD_MESSAGE_MAX bytes.  SAMPLE_LOAD_RATE caps the
+   requests per second over all connections; 0 sends as fast as the echoes come back.  After
+   SAMPLE_LOAD_DURATION seconds the client prints the throughput and the latency percentiles from
+   sending a request to receiving the last byte of its echo.  The throughput is over the time from
+   the first request sent to the last echo completed, so connection setup and teardown are left out.  */
+#ifdef SAMPLE_ENABLE_LOAD_GENERATOR
+#ifndef SAMPLE_LOAD_CONNECTIONS
+#define SAMPLE_LOAD_CONNECTIONS         8
+#endif /* SAMPLE_LOAD_CONNECTIONS */
+
+#ifndef SAMPLE_LOAD_PIPELINE
+#define SAMPLE_LOAD_PIPELINE            4
+#endif /* SAMPLE_LOAD_PIPELINE */
+
+#ifndef SAMPLE_LOAD_MESSAGE_MIN
+#define SAMPLE_LOAD_MESSAGE_MIN         (sizeof(ECHO_DATA))
+#endif /* SAMPLE_LOAD_MESSAGE_MIN */
+
+#ifndef SAMPLE_LOAD_MESSAGE_MAX
+#define SAMPLE_LOAD_MESSAGE_MAX         1024
+#endif /* SAMPLE_LOAD_MESSAGE_MAX */
+
+#ifndef SAMPLE_LOAD_RATE
+#define SAMPLE_LOAD_RATE                0
+#endif /* SAMPLE_LOAD_RATE */
+
+#ifndef SAMPLE_LOAD_DURATION
+#define SAMPLE_LOAD_DURATION            10
+#endif /* SAMPLE_LOAD_DURATION */
+
+#if (SAMPLE_LOAD_CONNECTIONS < 1) || (SAMPLE_LOAD_PIPELINE < 1)
+#error "SAMPLE_LOAD_CONNECTIONS and SAMPLE_LOAD_PIPELINE must be at least 1"
+#endif
+
+#define SAMPLE_LOAD_CONNECT_TIMEOUT     (5 * NX_IP_PERIODIC_RATE)
+#define SAMPLE_LOAD_DISCONNECT_TIMEOUT  NX_IP_PERIODIC_RATE
+#endif /* SAMPLE_ENABLE_LOAD_GENERATOR */
+
 /* Define packet pool.  */
 #define PACKET_SIZE                     1536
+#ifdef SAMPLE_ENABLE_LOAD_GENERATOR
+#define PACKET_COUNT                    (30 + SAMPLE_LOAD_CONNECTIONS * SAMPLE_LOAD_PIPELINE * 2 * \
+                                         (SAMPLE_LOAD_MESSAGE_MAX / PACKET_SIZE + 1))
+#else
 #define PACKET_COUNT                    30
+#endif /* SAMPLE_ENABLE_LOAD_GENERATOR */
 #define PACKET_POOL_SIZE                ((PACKET_SIZE + sizeof(NX_PACKET)) * PACKET_COUNT)
 
 /* Define IP stack size.   */
@@ -63,10 +113,41 @@
 /* Define time wait for IPv6 DAD process.  */
 #define SAMPLE_DAD_WAIT                 (3 * NX_IP_PERIODIC_RATE)
 
+#ifdef SAMPLE_ENABLE_LOAD_GENERATOR
+/* Define the state of a connection.  The echo of a request is complete once as many bytes as
+   it had have come back, as TCP keeps them in order.  */
+typedef struct SAMPLE_LOAD_CONNECTION_STRUCT
+{
+    NX_TCP_SOCKET           load_socket;
+    TX_THREAD               load_thread;
+    ULONG                   load_thread_stack[SAMPLE_THREAD_STACK_SIZE >> 2];
+
+    ULONG64                 load_request_time[SAMPLE_LOAD_PIPELINE];
+    ULONG                   load_request_size[SAMPLE_LOAD_PIPELINE];
+    UINT                    load_request_head;
+    UINT                    load_request_count;
+    ULONG                   load_request_received;
+    ULONG                   load_random;
+
+    ULONG                   load_sent;
+    ULONG                   load_completed;
+    ULONG64                 load_first_time;
+    ULONG64                 load_last_time;
+    ULONG64                 load_bytes;
+    ULONG                   load_errors;
+    SAMPLE_HISTOGRAM        load_latency;
+} SAMPLE_LOAD_CONNECTION;
+#endif /* SAMPLE_ENABLE_LOAD_GENERATOR */
+
 /* Define the ThreadX and NetX object control blocks...  */
 NX_PACKET_POOL          default_pool;
 NX_IP                   default_ip;
+#ifdef SAMPLE_ENABLE_LOAD_GENERATOR
+SAMPLE_LOAD_CONNECTION  load_connections[SAMPLE_LOAD_CONNECTIONS];
+TX_SEMAPHORE            load_done_semaphore;
+#else
 NX_TCP_SOCKET           tcp_client;
+#endif /* SAMPLE_ENABLE_LOAD_GENERATOR */
 TX_THREAD               client_thread;
 
 /* Define memory buffers.  */
@@ -75,14 +156,27 @@ ULONG                   ip_stack[IP_STACK_SIZE >> 2];
 ULONG                   arp_area[ARP_POOL_SIZE >> 2];
 ULONG                   client_thread_stack[SAMPLE_THREAD_STACK_SIZE >> 2];
 
+#ifdef SAMPLE_ENABLE_LOAD_GENERATOR
+UCHAR                   load_data[SAMPLE_LOAD_MESSAGE_MAX];
+NXD_ADDRESS             load_server_address;
+ULONG64                 load_start_time;
+SAMPLE_HISTOGRAM        load_latency;
+#endif /* SAMPLE_ENABLE_LOAD_GENERATOR */
+
 /* Define the counters used in the demo application...  */
 ULONG                   error_counter;
 
 /***** Substitute your ethernet driver entry function here *********/
-extern  VOID _nx_linux_network_driver(NX_IP_DRIVER*);
+extern  VOID SAMPLE_NETWORK_DRIVER(NX_IP_DRIVER*);
 
 /* Define function prototypes.  */
 void client_thread_entry(ULONG thread_input);
+#ifdef SAMPLE_ENABLE_LOAD_GENERATOR
+void load_thread_entry(ULONG thread_input);
+static VOID load_connection_run(SAMPLE_LOAD_CONNECTION *connection_ptr);
+static VOID load_report(VOID);
+static ULONG64 load_time_get(VOID);
+#endif /* SAMPLE_ENABLE_LOAD_GENERATOR */
 static VOID print_ipv6_address(ULONG *ipv6_address);
 static VOID ipv6_address_DAD_notify(NX_IP *ip_ptr, UINT status, UINT interface_index,
                                     UINT ipv6_addr_index, ULONG *ipv6_address);
@@ -122,7 +216,7 @@ UINT    status;
 
     /* Create an IP instance.  */
     status = nx_ip_create(&default_ip, "NetX IP Instance 0", SAMPLE_IPV4_ADDRESS, SAMPLE_IPV4_MASK,
-                          &default_pool, _nx_linux_network_driver,
+                          &default_pool, SAMPLE_NETWORK_DRIVER,
                           (void *)ip_stack, sizeof(ip_stack), IP_THREAD_PRIORITY);
 
     /* Check for IP create errors.  */
@@ -176,7 +270,11 @@ UINT    status;
 void client_thread_entry(ULONG thread_input)
 {
 UINT       status;
+#ifdef SAMPLE_ENABLE_LOAD_GENERATOR
+UINT        i;
+#else
 NX_PACKET *packet_ptr;
+#endif /* SAMPLE_ENABLE_LOAD_GENERATOR */
 NXD_ADDRESS sample_ipv6_address;
 NXD_ADDRESS echo_server_address;
 
@@ -209,6 +307,32 @@ NXD_ADDRESS echo_server_address;
     echo_server_address.nxd_ip_address.v6[2] = ECHO_SERVER_ADDRESS_2;
     echo_server_address.nxd_ip_address.v6[3] = ECHO_SERVER_ADDRESS_3;
 
+#ifdef SAMPLE_ENABLE_LOAD_GENERATOR
+    /* Fill the request payload with ABCs.  */
+    for (i = 0; i < SAMPLE_LOAD_MESSAGE_MAX; i++)
+    {
+        load_data[i] = (UCHAR)ECHO_DATA[i % (sizeof(ECHO_DATA) - 1)];
+    }
+
+    /* Start the connections and wait for them to finish.  */
+    printf("Loading server: ");
+    print_ipv6_address(echo_server_address.nxd_ip_address.v6);
+    load_server_address = echo_server_address;
+    load_start_time = load_time_get();
+    tx_semaphore_create(&load_done_semaphore, "Load Done", 0);
+    for (i = 0; i < SAMPLE_LOAD_CONNECTIONS; i++)
+    {
+        tx_thread_create(&load_connections[i].load_thread, "Load Thread", load_thread_entry, i,
+                         load_connections[i].load_thread_stack, sizeof(load_connections[i].load_thread_stack),
+                         SAMPLE_THREAD_PRIORITY, SAMPLE_THREAD_PRIORITY, TX_NO_TIME_SLICE, TX_AUTO_START);
+    }
+    for (i = 0; i < SAMPLE_LOAD_CONNECTIONS; i++)
+    {
+        tx_semaphore_get(&load_done_semaphore, TX_WAIT_FOREVER);
+    }
+
+    load_report();
+#else
     /* Create a TCP socket.  */
     status = nx_tcp_socket_create(&default_ip, &tcp_client, "TCP Echo Client", NX_IP_NORMAL, NX_DONT_FRAGMENT,
                                   SAMPLE_SOCKET_TTL, SAMPLE_SOCKET_WINDOW_SIZE, NX_NULL, NX_NULL);
@@ -305,7 +429,244 @@ NXD_ADDRESS echo_server_address;
     nx_tcp_socket_disconnect(&tcp_client, NX_WAIT_FOREVER);
     nx_tcp_client_socket_unbind(&tcp_client);
     nx_tcp_socket_delete(&tcp_client);
+#endif /* SAMPLE_ENABLE_LOAD_GENERATOR */
+}
+
+#ifdef SAMPLE_ENABLE_LOAD_GENERATOR
+/* Load thread entry.  */
+void load_thread_entry(ULONG thread_input)
+{
+UINT                    status;
+SAMPLE_LOAD_CONNECTION *connection_ptr = &load_connections[thread_input];
+
+    connection_ptr -> load_random = thread_input + 1;
+    sample_histogram_reset(&connection_ptr -> load_latency);
+
+    /* Create a TCP socket.  */
+    status = nx_tcp_socket_create(&default_ip, &connection_ptr -> load_socket, "TCP Load Client", NX_IP_NORMAL,
+                                  NX_DONT_FRAGMENT, SAMPLE_SOCKET_TTL, SAMPLE_SOCKET_WINDOW_SIZE, NX_NULL, NX_NULL);
+
+    /* Check status.  */
+    if (status)
+    {
+        connection_ptr -> load_errors++;
+        tx_semaphore_put(&load_done_semaphore);
+        return;
+    }
+
+    /* Bind the TCP socket to any port and connect to server.  */
+    status =  nx_tcp_client_socket_bind(&connection_ptr -> load_socket, NX_ANY_PORT, NX_WAIT_FOREVER);
+    if (status == NX_SUCCESS)
+    {
+        status = nxd_tcp_client_socket_connect(&connection_ptr -> load_socket, &load_server_address, ECHO_SERVER_PORT,
+                                               SAMPLE_LOAD_CONNECT_TIMEOUT);
+    }
+
+    /* Check status.  */
+    if (status == NX_SUCCESS)
+    {
+        load_connection_run(connection_ptr);
+    }
+    else
+    {
+        connection_ptr -> load_errors++;
+    }
+
+    /* Cleanup the TCP socket.  */
+    nx_tcp_socket_disconnect(&connection_ptr -> load_socket, SAMPLE_LOAD_DISCONNECT_TIMEOUT);
+    nx_tcp_client_socket_unbind(&connection_ptr -> load_socket);
+    nx_tcp_socket_delete(&connection_ptr -> load_socket);
+    tx_semaphore_put(&load_done_semaphore);
+}
+
+/* Send requests and take their echoes until the load duration ends.  */
+static VOID load_connection_run(SAMPLE_LOAD_CONNECTION *connection_ptr)
+{
+UINT       status;
+UINT       slot;
+ULONG      size;
+ULONG      length;
+ULONG      wait;
+ULONG64    now;
+ULONG64    end_time = load_start_time + (ULONG64)SAMPLE_LOAD_DURATION * 1000000;
+NX_PACKET *packet_ptr;
+
+    for (;;)
+    {
+        now = load_time_get();
+        if (now >= end_time)
+        {
+            break;
+        }
+
+        /* Send requests while the pipeline has room and the rate allows.  */
+        while (connection_ptr -> load_request_count < SAMPLE_LOAD_PIPELINE)
+        {
+#if SAMPLE_LOAD_RATE > 0
+            /* Each connection sends its share of the rate, evenly spaced.  */
+            if (load_start_time + (ULONG64)connection_ptr -> load_sent * SAMPLE_LOAD_CONNECTIONS * 1000000 /
+                SAMPLE_LOAD_RATE > now)
+            {
+                break;
+            }
+#endif /* SAMPLE_LOAD_RATE > 0 */
+
+            /* Draw the request size with xorshift32.  */
+            connection_ptr -> load_random ^= connection_ptr -> load_random << 13;
+            connection_ptr -> load_random ^= connection_ptr -> load_random >> 17;
+            connection_ptr -> load_random ^= connection_ptr -> load_random << 5;
+            size = SAMPLE_LOAD_MESSAGE_MIN +
+                   connection_ptr -> load_random % (SAMPLE_LOAD_MESSAGE_MAX - SAMPLE_LOAD_MESSAGE_MIN + 1);
+
+            /* Allocate a packet and write ABCs into the packet payload.  */
+            status =  nx_packet_allocate(&default_pool, &packet_ptr, NX_TCP_PACKET, NX_WAIT_FOREVER);
+
+            /* Check status.  */
+            if (status != NX_SUCCESS)
+            {
+                connection_ptr -> load_errors++;
+                return;
+            }
+
+            status = nx_packet_data_append(packet_ptr, load_data, size, &default_pool, NX_WAIT_FOREVER);
+
+            /* Check status.  */
+            if (status != NX_SUCCESS)
+            {
+                nx_packet_release(packet_ptr);
+                connection_ptr -> load_errors++;
+                return;
+            }
+
+            /* Send data to echo server.  */
+            slot = (connection_ptr -> load_request_head + connection_ptr -> load_request_count) % SAMPLE_LOAD_PIPELINE;
+            connection_ptr -> load_request_time[slot] = load_time_get();
+            connection_ptr -> load_request_size[slot] = size;
+            if (connection_ptr -> load_sent == 0)
+            {
+                connection_ptr -> load_first_time = connection_ptr -> load_request_time[slot];
+            }
+            status =  nx_tcp_socket_send(&connection_ptr -> load_socket, packet_ptr, ECHO_RECEIVE_TIMEOUT);
+
+            /* Check status.  */
+            if (status != NX_SUCCESS)
+            {
+                nx_packet_release(packet_ptr);
+                connection_ptr -> load_errors++;
+                return;
+            }
+            connection_ptr -> load_request_count++;
+            connection_ptr -> load_sent++;
+        }
+
+        /* Receive data from echo server.  While the rate holds requests back, wait no longer
+           than a tick so they go out on time.  */
+        wait = (connection_ptr -> load_request_count < SAMPLE_LOAD_PIPELINE) ? 1 : ECHO_RECEIVE_TIMEOUT;
+        status =  nx_tcp_socket_receive(&connection_ptr -> load_socket, &packet_ptr, wait);
+        if (status == NX_NO_PACKET)
+        {
+            if (wait == ECHO_RECEIVE_TIMEOUT)
+            {
+
+                /* No response received.  */
+                connection_ptr -> load_errors++;
+                return;
+            }
+            continue;
+        }
+        else if (status)
+        {
+            connection_ptr -> load_errors++;
+            return;
+        }
+
+        now = load_time_get();
+        length = packet_ptr -> nx_packet_length;
+        connection_ptr -> load_bytes += length;
+        nx_packet_release(packet_ptr);
+
+        /* Complete the requests whose echo is in.  */
+        while (length && connection_ptr -> load_request_count)
+        {
+            slot = connection_ptr -> load_request_head;
+            size = connection_ptr -> load_request_size[slot] - connection_ptr -> load_request_received;
+            if (length < size)
+            {
+                connection_ptr -> load_request_received += length;
+                break;
+            }
+
+            length -= size;
+            sample_histogram_record(&connection_ptr -> load_latency,
+                                    (ULONG)(now - connection_ptr -> load_request_time[slot]));
+            connection_ptr -> load_request_received = 0;
+            connection_ptr -> load_request_head = (slot + 1) % SAMPLE_LOAD_PIPELINE;
+            connection_ptr -> load_request_count--;
+            connection_ptr -> load_completed++;
+            connection_ptr -> load_last_time = now;
+        }
+    }
+}
+
+/* Print the throughput and latency over all connections.  */
+static VOID load_report(VOID)
+{
+UINT    i;
+ULONG   sent = 0;
+ULONG   completed = 0;
+ULONG   errors = 0;
+ULONG64 bytes = 0;
+ULONG64 first_time = ~((ULONG64)0);
+ULONG64 last_time = 0;
+ULONG64 elapsed;
+
+    sample_histogram_reset(&load_latency);
+    for (i = 0; i < SAMPLE_LOAD_CONNECTIONS; i++)
+    {
+        sent += load_connections[i].load_sent;
+        completed += load_connections[i].load_completed;
+        errors += load_connections[i].load_errors;
+        bytes += load_connections[i].load_bytes;
+        sample_histogram_merge(&load_latency, &load_connections[i].load_latency);
+
+        /* Measure from the first request sent to the last echo completed on any connection.  */
+        if (load_connections[i].load_completed == 0)
+        {
+            continue;
+        }
+        if (load_connections[i].load_first_time < first_time)
+        {
+            first_time = load_connections[i].load_first_time;
+        }
+        if (load_connections[i].load_last_time > last_time)
+        {
+            last_time = load_connections[i].load_last_time;
+        }
+    }
+
+    printf("%u connections, pipeline %u, %lu-%lu byte requests, %lu requests/s offered, %lu s\r\n",
+           (UINT)SAMPLE_LOAD_CONNECTIONS, (UINT)SAMPLE_LOAD_PIPELINE, (ULONG)SAMPLE_LOAD_MESSAGE_MIN,
+           (ULONG)SAMPLE_LOAD_MESSAGE_MAX, (ULONG)SAMPLE_LOAD_RATE, (ULONG)SAMPLE_LOAD_DURATION);
+    printf("Sent %lu requests, %lu echoed, %lu errors\r\n", sent, completed, errors);
+    if ((completed == 0) || (last_time <= first_time))
+    {
+        return;
+    }
+    elapsed = last_time - first_time;
+    printf("Throughput: %lu requests/s, %lu kbit/s\r\n",
+           (ULONG)((ULONG64)completed * 1000000 / elapsed), (ULONG)(bytes * 8000 / elapsed));
+    sample_histogram_print(&load_latency, "Latency", "us");
+}
+
+/* Read the host clock in microseconds; ThreadX ticks are too coarse for echo latency.  */
+static ULONG64 load_time_get(VOID)
+{
+struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return((ULONG64)now.tv_sec * 1000000 + (ULONG64)now.tv_nsec / 1000);
 }
+#endif /* SAMPLE_ENABLE_LOAD_GENERATOR */
 
 static VOID print_ipv6_address(ULONG *ipv6_address)
 {
@@ -36,9 +36,68 @@
 #define ECHO_DATA                       "ABCDEFGHIJKLMNOPQRSTUVWXYZ "
 #define ECHO_RECEIVE_TIMEOUT            NX_IP_PERIODIC_RATE
 
+/* Define the worker pool mode.  With SAMPLE_ENABLE_WORKER_POOL defined the server creates
+   SAMPLE_SERVER_SOCKET_COUNT sockets up front.  One of them listens on the echo port at a
+   time; once it accepts a connection, the next free socket takes over the listen with
+   nx_tcp_server_socket_relisten.  The receive and disconnect notify callbacks of connected
+   sockets hand them to SAMPLE_SERVER_WORKER_COUNT worker threads, and the server thread
+   reports connections per second and echoed bytes per second.  */
+
+/* Define the event loop mode.  With SAMPLE_ENABLE_EVENT_LOOP defined the server keeps the
+   same socket pool, but the listen, receive and disconnect notify callbacks post the sockets
+   to a queue that the server thread alone drains.  It accepts, receives and sends with
+   NX_NO_WAIT only, so a connection costs a socket and no thread stack.  */
+#if defined(SAMPLE_ENABLE_WORKER_POOL) && defined(SAMPLE_ENABLE_EVENT_LOOP)
+#error "Enable only one of SAMPLE_ENABLE_WORKER_POOL and SAMPLE_ENABLE_EVENT_LOOP"
+#endif
+
+#if defined(SAMPLE_ENABLE_WORKER_POOL) || defined(SAMPLE_ENABLE_EVENT_LOOP)
+#define SAMPLE_SERVER_SOCKET_POOL
+
+#ifndef SAMPLE_SERVER_SOCKET_COUNT
+#define SAMPLE_SERVER_SOCKET_COUNT      256
+#endif /* SAMPLE_SERVER_SOCKET_COUNT */
+
+#define SAMPLE_SERVER_REPORT_INTERVAL   (5 * NX_IP_PERIODIC_RATE)
+
+/* Define the state of a socket in the pool, neither listening nor connected.  */
+#define SERVER_SOCKET_FREE              0
+#endif /* SAMPLE_ENABLE_WORKER_POOL || SAMPLE_ENABLE_EVENT_LOOP */
+
+#ifdef SAMPLE_ENABLE_WORKER_POOL
+#ifndef SAMPLE_SERVER_WORKER_COUNT
+#define SAMPLE_SERVER_WORKER_COUNT      4
+#endif /* SAMPLE_SERVER_WORKER_COUNT */
+
+#define SAMPLE_SERVER_SEND_TIMEOUT      NX_IP_PERIODIC_RATE
+#define SAMPLE_SERVER_DISCONNECT_TIMEOUT NX_IP_PERIODIC_RATE
+
+/* Define the states of a connected socket.  A socket is queued to the workers at most once,
+   and a notify while a worker echoes on it makes that worker look again.  */
+#define SERVER_SOCKET_IDLE              1
+#define SERVER_SOCKET_QUEUED            2
+#define SERVER_SOCKET_BUSY              3
+#define SERVER_SOCKET_BUSY_AGAIN        4
+#endif /* SAMPLE_ENABLE_WORKER_POOL */
+
+#ifdef SAMPLE_ENABLE_EVENT_LOOP
+/* Define how often the server thread looks at sockets that wait to send or to close, which
+   get no notify of their own.  */
+#define SAMPLE_SERVER_POLL_INTERVAL     (NX_IP_PERIODIC_RATE / 20)
+
+/* Define the states of a socket owned by the event loop.  */
+#define SERVER_SOCKET_LISTEN            1
+#define SERVER_SOCKET_CONNECTED         2
+#define SERVER_SOCKET_CLOSING           3
+#endif /* SAMPLE_ENABLE_EVENT_LOOP */
+
 /* Define packet pool.  */
 #define PACKET_SIZE                     1536
+#ifdef SAMPLE_SERVER_SOCKET_POOL
+#define PACKET_COUNT                    (SAMPLE_SERVER_SOCKET_COUNT * 2)
+#else
 #define PACKET_COUNT                    30
+#endif /* SAMPLE_SERVER_SOCKET_POOL */
 #define PACKET_POOL_SIZE                ((PACKET_SIZE + sizeof(NX_PACKET)) * PACKET_COUNT)
 
 /* Define IP stack size.   */
@@ -67,7 +126,17 @@
 /* Define the ThreadX and NetX object control blocks...  */
 NX_PACKET_POOL          default_pool;
 NX_IP                   default_ip;
+#ifdef SAMPLE_SERVER_SOCKET_POOL
+NX_TCP_SOCKET           server_sockets[SAMPLE_SERVER_SOCKET_COUNT];
+TX_QUEUE                server_ready_queue;
+#else
 NX_TCP_SOCKET           tcp_server;
+#endif /* SAMPLE_SERVER_SOCKET_POOL */
+#ifdef SAMPLE_ENABLE_WORKER_POOL
+TX_SEMAPHORE            server_free_semaphore;
+TX_THREAD               accept_thread;
+TX_THREAD               worker_threads[SAMPLE_SERVER_WORKER_COUNT];
+#endif /* SAMPLE_ENABLE_WORKER_POOL */
 TX_THREAD               server_thread;
 
 /* Define memory buffers.  */
@@ -75,15 +144,58 @@ ULONG                   pool_area[PACKET_POOL_SIZE >> 2];
 ULONG                   ip_stack[IP_STACK_SIZE >> 2];
 ULONG                   arp_area[ARP_POOL_SIZE >> 2];
 ULONG                   server_thread_stack[SAMPLE_THREAD_STACK_SIZE >> 2];
+#ifdef SAMPLE_ENABLE_WORKER_POOL
+ULONG                   accept_thread_stack[SAMPLE_THREAD_STACK_SIZE >> 2];
+ULONG                   worker_thread_stacks[SAMPLE_SERVER_WORKER_COUNT][SAMPLE_THREAD_STACK_SIZE >> 2];
+#endif /* SAMPLE_ENABLE_WORKER_POOL */
+#ifdef SAMPLE_SERVER_SOCKET_POOL
+ULONG                   server_ready_queue_area[SAMPLE_SERVER_SOCKET_COUNT];
+
+/* Define the socket pool.  */
+UINT                    server_socket_state[SAMPLE_SERVER_SOCKET_COUNT];
+NX_TCP_SOCKET          *server_free_sockets[SAMPLE_SERVER_SOCKET_COUNT];
+UINT                    server_free_count;
+NX_TCP_SOCKET          *server_listen_socket;
+#endif /* SAMPLE_SERVER_SOCKET_POOL */
+#ifdef SAMPLE_ENABLE_EVENT_LOOP
+UINT                    server_socket_queued[SAMPLE_SERVER_SOCKET_COUNT];
+NX_PACKET              *server_socket_pending[SAMPLE_SERVER_SOCKET_COUNT];
+UINT                    server_waiting_count;
+#endif /* SAMPLE_ENABLE_EVENT_LOOP */
 
 /* Define the counters used in the demo application...  */
 ULONG                   error_counter;
+#ifdef SAMPLE_SERVER_SOCKET_POOL
+ULONG                   server_connections;
+#endif /* SAMPLE_SERVER_SOCKET_POOL */
+#ifdef SAMPLE_ENABLE_WORKER_POOL
+ULONG                   server_worker_bytes[SAMPLE_SERVER_WORKER_COUNT];
+#endif /* SAMPLE_ENABLE_WORKER_POOL */
+#ifdef SAMPLE_ENABLE_EVENT_LOOP
+ULONG                   server_bytes;
+#endif /* SAMPLE_ENABLE_EVENT_LOOP */
 
 /***** Substitute your ethernet driver entry function here *********/
-extern  VOID _nx_linux_network_driver(NX_IP_DRIVER*);
+extern  VOID SAMPLE_NETWORK_DRIVER(NX_IP_DRIVER*);
 
 /* Define function prototypes.  */
 void server_thread_entry(ULONG thread_input);
+#ifdef SAMPLE_SERVER_SOCKET_POOL
+static VOID server_socket_ready(NX_TCP_SOCKET *socket_ptr);
+static VOID server_report(VOID);
+#endif /* SAMPLE_SERVER_SOCKET_POOL */
+#ifdef SAMPLE_ENABLE_WORKER_POOL
+void accept_thread_entry(ULONG thread_input);
+void worker_thread_entry(ULONG thread_input);
+static VOID server_socket_free(NX_TCP_SOCKET *socket_ptr);
+#endif /* SAMPLE_ENABLE_WORKER_POOL */
+#ifdef SAMPLE_ENABLE_EVENT_LOOP
+static VOID server_listen_ready(NX_TCP_SOCKET *socket_ptr, UINT port);
+static VOID server_listen_next(VOID);
+static VOID server_socket_process(ULONG index);
+static VOID server_socket_echo(ULONG index);
+static VOID server_socket_close(ULONG index);
+#endif /* SAMPLE_ENABLE_EVENT_LOOP */
 static VOID print_ipv6_address(ULONG *ipv6_address);
 static VOID ipv6_address_DAD_notify(NX_IP *ip_ptr, UINT status, UINT interface_index,
                                     UINT ipv6_addr_index, ULONG *ipv6_address);
@@ -123,7 +235,7 @@ UINT    status;
 
     /* Create an IP instance.  */
     status = nx_ip_create(&default_ip, "NetX IP Instance 0", SAMPLE_IPV4_ADDRESS, SAMPLE_IPV4_MASK,
-                          &default_pool, _nx_linux_network_driver,
+                          &default_pool, SAMPLE_NETWORK_DRIVER,
                           (void *)ip_stack, sizeof(ip_stack), IP_THREAD_PRIORITY);
 
     /* Check for IP create errors.  */
@@ -177,10 +289,21 @@ UINT    status;
 void server_thread_entry(ULONG thread_input)
 {
 UINT       status;
-NX_PACKET *packet_ptr;
 NXD_ADDRESS sample_ipv6_address;
+#ifdef SAMPLE_SERVER_SOCKET_POOL
+UINT        i;
+#ifdef SAMPLE_ENABLE_EVENT_LOOP
+ULONG       index;
+ULONG       now;
+ULONG       wait;
+ULONG       poll_time;
+ULONG       report_time;
+#endif /* SAMPLE_ENABLE_EVENT_LOOP */
+#else
+NX_PACKET *packet_ptr;
 NXD_ADDRESS client_ipv6_address;
 ULONG       client_port;
+#endif /* SAMPLE_SERVER_SOCKET_POOL */
 
     /* Set link local address by stateless address auto configuration.  */
     sample_ipv6_address.nxd_ip_version = NX_IP_VERSION_V6;
@@ -204,6 +327,121 @@ ULONG       client_port;
     /* Suspend current thread for the IPv6 stack to finish DAD process. */
     tx_thread_suspend(tx_thread_identify());
 
+#ifdef SAMPLE_SERVER_SOCKET_POOL
+    /* Create the socket pool.  Every socket is queued on data and on disconnect.  */
+    for (i = 0; i < SAMPLE_SERVER_SOCKET_COUNT; i++)
+    {
+        status = nx_tcp_socket_create(&default_ip, &server_sockets[i], "TCP Echo Server", NX_IP_NORMAL, NX_DONT_FRAGMENT,
+                                      SAMPLE_SOCKET_TTL, SAMPLE_SOCKET_WINDOW_SIZE, NX_NULL, server_socket_ready);
+
+        /* Check status.  */
+        if (status)
+        {
+            error_counter++;
+            return;
+        }
+
+        nx_tcp_socket_receive_notify(&server_sockets[i], server_socket_ready);
+#ifdef SAMPLE_ENABLE_EVENT_LOOP
+        nx_tcp_socket_window_update_notify_set(&server_sockets[i], server_socket_ready);
+#endif /* SAMPLE_ENABLE_EVENT_LOOP */
+        server_socket_state[i] = SERVER_SOCKET_FREE;
+        if (i > 0)
+        {
+            server_free_sockets[server_free_count++] = &server_sockets[i];
+        }
+    }
+
+    /* Create the queue of ready sockets.  */
+    tx_queue_create(&server_ready_queue, "Server Ready Queue", TX_1_ULONG,
+                    server_ready_queue_area, sizeof(server_ready_queue_area));
+
+    /* Listen on port 7 with the first socket.  */
+    server_listen_socket = &server_sockets[0];
+#ifdef SAMPLE_ENABLE_EVENT_LOOP
+    server_socket_state[0] = SERVER_SOCKET_LISTEN;
+    status =  nx_tcp_server_socket_listen(&default_ip, ECHO_SERVER_PORT, server_listen_socket,
+                                          SAMPLE_SOCKET_LISTEN_QUEUE_SIZE, server_listen_ready);
+#else
+    status =  nx_tcp_server_socket_listen(&default_ip, ECHO_SERVER_PORT, server_listen_socket,
+                                          SAMPLE_SOCKET_LISTEN_QUEUE_SIZE, NX_NULL);
+#endif /* SAMPLE_ENABLE_EVENT_LOOP */
+
+    /* Check status.  */
+    if (status)
+    {
+        error_counter++;
+        return;
+    }
+
+    printf("Waiting for connections\r\n");
+
+#ifdef SAMPLE_ENABLE_WORKER_POOL
+    /* Create the count of free sockets, the accept thread and the workers.  */
+    tx_semaphore_create(&server_free_semaphore, "Server Free Sockets", server_free_count);
+    tx_thread_create(&accept_thread, "Accept Thread", accept_thread_entry, 0,
+                     accept_thread_stack, sizeof(accept_thread_stack),
+                     SAMPLE_THREAD_PRIORITY, SAMPLE_THREAD_PRIORITY, TX_NO_TIME_SLICE, TX_AUTO_START);
+    for (i = 0; i < SAMPLE_SERVER_WORKER_COUNT; i++)
+    {
+        tx_thread_create(&worker_threads[i], "Worker Thread", worker_thread_entry, i,
+                         worker_thread_stacks[i], sizeof(worker_thread_stacks[i]),
+                         SAMPLE_THREAD_PRIORITY, SAMPLE_THREAD_PRIORITY, TX_NO_TIME_SLICE, TX_AUTO_START);
+    }
+
+    /* Report the load periodically.  */
+    for (;;)
+    {
+        tx_thread_sleep(SAMPLE_SERVER_REPORT_INTERVAL);
+        server_report();
+    }
+#else
+    /* Run the event loop.  */
+    report_time = tx_time_get() + SAMPLE_SERVER_REPORT_INTERVAL;
+    poll_time = tx_time_get() + SAMPLE_SERVER_POLL_INTERVAL;
+    for (;;)
+    {
+
+        /* Wait for a socket event, but not past the next report, nor the next poll while
+           sockets wait.  */
+        now = tx_time_get();
+        wait = ((LONG)(report_time - now) > 0) ? (report_time - now) : TX_NO_WAIT;
+        if (server_waiting_count && ((LONG)(poll_time - now) < (LONG)wait))
+        {
+            wait = ((LONG)(poll_time - now) > 0) ? (poll_time - now) : TX_NO_WAIT;
+        }
+
+        if (tx_queue_receive(&server_ready_queue, &index, wait) == TX_SUCCESS)
+        {
+            server_socket_process(index);
+        }
+
+        /* Look at the sockets that wait to send or to close.  */
+        now = tx_time_get();
+        if ((LONG)(now - poll_time) >= 0)
+        {
+            if (server_waiting_count)
+            {
+                server_waiting_count = 0;
+                for (i = 0; i < SAMPLE_SERVER_SOCKET_COUNT; i++)
+                {
+                    if ((server_socket_state[i] == SERVER_SOCKET_CLOSING) || server_socket_pending[i])
+                    {
+                        server_socket_process(i);
+                    }
+                }
+            }
+            poll_time = now + SAMPLE_SERVER_POLL_INTERVAL;
+        }
+
+        if ((LONG)(now - report_time) >= 0)
+        {
+            server_report();
+            report_time += SAMPLE_SERVER_REPORT_INTERVAL;
+        }
+    }
+#endif /* SAMPLE_ENABLE_WORKER_POOL */
+#else
     /* Create a TCP socket.  */
     status = nx_tcp_socket_create(&default_ip, &tcp_server, "TCP Echo Server", NX_IP_NORMAL, NX_DONT_FRAGMENT,
                                   SAMPLE_SOCKET_TTL, SAMPLE_SOCKET_WINDOW_SIZE, NX_NULL, NX_NULL);
@@ -273,7 +511,410 @@ ULONG       client_port;
     nx_tcp_socket_disconnect(&tcp_server, NX_WAIT_FOREVER);
     nx_tcp_client_socket_unbind(&tcp_server);
     nx_tcp_socket_delete(&tcp_server);
+#endif /* SAMPLE_SERVER_SOCKET_POOL */
+}
+
+#ifdef SAMPLE_SERVER_SOCKET_POOL
+/* Print connections per second, echoed bytes per second and open connections.  */
+static VOID server_report(VOID)
+{
+static ULONG last_connections;
+static ULONG last_bytes;
+ULONG        connections = server_connections;
+ULONG        bytes;
+UINT         connected = 0;
+UINT         i;
+
+#ifdef SAMPLE_ENABLE_WORKER_POOL
+    bytes = 0;
+    for (i = 0; i < SAMPLE_SERVER_WORKER_COUNT; i++)
+    {
+        bytes += server_worker_bytes[i];
+    }
+#else
+    bytes = server_bytes;
+#endif /* SAMPLE_ENABLE_WORKER_POOL */
+
+    for (i = 0; i < SAMPLE_SERVER_SOCKET_COUNT; i++)
+    {
+#ifdef SAMPLE_ENABLE_EVENT_LOOP
+        if (server_socket_state[i] == SERVER_SOCKET_CONNECTED)
+#else
+        if (server_socket_state[i] != SERVER_SOCKET_FREE)
+#endif /* SAMPLE_ENABLE_EVENT_LOOP */
+        {
+            connected++;
+        }
+    }
+
+    printf("%lu connections/s, %lu bytes/s, %u connected\r\n",
+           (connections - last_connections) * NX_IP_PERIODIC_RATE / SAMPLE_SERVER_REPORT_INTERVAL,
+           (bytes - last_bytes) / (SAMPLE_SERVER_REPORT_INTERVAL / NX_IP_PERIODIC_RATE), connected);
+    last_connections = connections;
+    last_bytes = bytes;
+}
+#endif /* SAMPLE_SERVER_SOCKET_POOL */
+
+#ifdef SAMPLE_ENABLE_WORKER_POOL
+/* Accept thread entry.  */
+void accept_thread_entry(ULONG thread_input)
+{
+UINT           status;
+UINT           old_posture;
+NX_TCP_SOCKET *socket_ptr = server_listen_socket;
+
+    NX_PARAMETER_NOT_USED(thread_input);
+
+    for (;;)
+    {
+
+        /* Accept connection from client.  */
+        status = nx_tcp_server_socket_accept(socket_ptr, NX_WAIT_FOREVER);
+
+        /* Check status.  */
+        if (status == NX_SUCCESS)
+        {
+
+            /* Hand the connection to the workers, with any data that came in with it.  */
+            server_connections++;
+            server_socket_state[socket_ptr - server_sockets] = SERVER_SOCKET_IDLE;
+            server_socket_ready(socket_ptr);
+        }
+        else
+        {
+            error_counter++;
+            nx_tcp_server_socket_unaccept(socket_ptr);
+            server_socket_free(socket_ptr);
+        }
+
+        /* Let the next free socket take over the listen.  Connections that arrive until
+           then wait in the listen queue.  */
+        tx_semaphore_get(&server_free_semaphore, TX_WAIT_FOREVER);
+        old_posture = tx_interrupt_control(TX_INT_DISABLE);
+        socket_ptr = server_free_sockets[--server_free_count];
+        tx_interrupt_control(old_posture);
+
+        status = nx_tcp_server_socket_relisten(&default_ip, ECHO_SERVER_PORT, socket_ptr);
+
+        /* Check status.  */
+        if ((status != NX_SUCCESS) && (status != NX_CONNECTION_PENDING))
+        {
+            error_counter++;
+            return;
+        }
+    }
+}
+
+/* Worker thread entry.  */
+void worker_thread_entry(ULONG thread_input)
+{
+UINT           status;
+UINT           old_posture;
+UINT           closing;
+UINT           again;
+ULONG          index;
+NX_PACKET     *packet_ptr;
+NX_TCP_SOCKET *socket_ptr;
+
+    for (;;)
+    {
+
+        /* Wait for a socket with data or a disconnect.  */
+        tx_queue_receive(&server_ready_queue, &index, TX_WAIT_FOREVER);
+        socket_ptr = &server_sockets[index];
+
+        old_posture = tx_interrupt_control(TX_INT_DISABLE);
+        server_socket_state[index] = SERVER_SOCKET_BUSY;
+        tx_interrupt_control(old_posture);
+
+        do
+        {
+            closing = NX_FALSE;
+
+            /* Echo the data received so far.  */
+            while (nx_tcp_socket_receive(socket_ptr, &packet_ptr, NX_NO_WAIT) == NX_SUCCESS)
+            {
+                server_worker_bytes[thread_input] += packet_ptr -> nx_packet_length;
+                status =  nx_tcp_socket_send(socket_ptr, packet_ptr, SAMPLE_SERVER_SEND_TIMEOUT);
+
+                /* Check status.  */
+                if (status != NX_SUCCESS)
+                {
+                    nx_packet_release(packet_ptr);
+                    closing = NX_TRUE;
+                    break;
+                }
+            }
+
+            /* Close the connection once the client is done with it.  */
+            if (socket_ptr -> nx_tcp_socket_state != NX_TCP_ESTABLISHED)
+            {
+                closing = NX_TRUE;
+            }
+
+            /* Look again if data arrived meanwhile.  */
+            old_posture = tx_interrupt_control(TX_INT_DISABLE);
+            again = !closing && (server_socket_state[index] == SERVER_SOCKET_BUSY_AGAIN);
+            if (again)
+            {
+                server_socket_state[index] = SERVER_SOCKET_BUSY;
+            }
+            else
+            {
+                server_socket_state[index] = closing ? SERVER_SOCKET_FREE : SERVER_SOCKET_IDLE;
+            }
+            tx_interrupt_control(old_posture);
+        } while (again);
+
+        if (closing)
+        {
+
+            /* Cleanup the TCP socket and return it to the pool.  */
+            nx_tcp_socket_disconnect(socket_ptr, SAMPLE_SERVER_DISCONNECT_TIMEOUT);
+            nx_tcp_server_socket_unaccept(socket_ptr);
+            server_socket_free(socket_ptr);
+        }
+    }
+}
+
+/* Receive and disconnect notify callback, called from the IP thread.  */
+static VOID server_socket_ready(NX_TCP_SOCKET *socket_ptr)
+{
+UINT  old_posture;
+UINT  post = NX_FALSE;
+ULONG index = (ULONG)(socket_ptr - server_sockets);
+
+    old_posture = tx_interrupt_control(TX_INT_DISABLE);
+    if (server_socket_state[index] == SERVER_SOCKET_IDLE)
+    {
+        server_socket_state[index] = SERVER_SOCKET_QUEUED;
+        post = NX_TRUE;
+    }
+    else if (server_socket_state[index] == SERVER_SOCKET_BUSY)
+    {
+        server_socket_state[index] = SERVER_SOCKET_BUSY_AGAIN;
+    }
+    tx_interrupt_control(old_posture);
+
+    /* The queue holds every socket, so this does not fail.  */
+    if (post)
+    {
+        tx_queue_send(&server_ready_queue, &index, TX_NO_WAIT);
+    }
+}
+
+static VOID server_socket_free(NX_TCP_SOCKET *socket_ptr)
+{
+UINT old_posture;
+
+    old_posture = tx_interrupt_control(TX_INT_DISABLE);
+    server_free_sockets[server_free_count++] = socket_ptr;
+    tx_interrupt_control(old_posture);
+    tx_semaphore_put(&server_free_semaphore);
+}
+#endif /* SAMPLE_ENABLE_WORKER_POOL */
+
+#ifdef SAMPLE_ENABLE_EVENT_LOOP
+/* Receive, disconnect and window update notify callback, called from the IP thread.  */
+static VOID server_socket_ready(NX_TCP_SOCKET *socket_ptr)
+{
+UINT  old_posture;
+UINT  post;
+ULONG index = (ULONG)(socket_ptr - server_sockets);
+
+    old_posture = tx_interrupt_control(TX_INT_DISABLE);
+    post = !server_socket_queued[index];
+    server_socket_queued[index] = NX_TRUE;
+    tx_interrupt_control(old_posture);
+
+    /* The queue holds every socket, so this does not fail.  */
+    if (post)
+    {
+        tx_queue_send(&server_ready_queue, &index, TX_NO_WAIT);
+    }
+}
+
+/* Listen callback, called from the IP thread when a client connects.  */
+static VOID server_listen_ready(NX_TCP_SOCKET *socket_ptr, UINT port)
+{
+    NX_PARAMETER_NOT_USED(port);
+
+    server_socket_ready(socket_ptr);
+}
+
+/* Let the next free socket take over the listen.  */
+static VOID server_listen_next(VOID)
+{
+UINT           status;
+NX_TCP_SOCKET *socket_ptr;
+
+    /* Without a free socket, connections wait in the listen queue until one closes.  */
+    server_listen_socket = NX_NULL;
+    if (server_free_count == 0)
+    {
+        return;
+    }
+
+    socket_ptr = server_free_sockets[--server_free_count];
+    server_socket_state[socket_ptr - server_sockets] = SERVER_SOCKET_LISTEN;
+    server_listen_socket = socket_ptr;
+    status = nx_tcp_server_socket_relisten(&default_ip, ECHO_SERVER_PORT, socket_ptr);
+
+    /* A connection taken from the listen queue gets no listen callback.  */
+    if (status == NX_CONNECTION_PENDING)
+    {
+        server_socket_ready(socket_ptr);
+    }
+    else if (status != NX_SUCCESS)
+    {
+        error_counter++;
+    }
+}
+
+/* Handle an event on a socket.  */
+static VOID server_socket_process(ULONG index)
+{
+UINT           status;
+UINT           old_posture;
+NX_TCP_SOCKET *socket_ptr = &server_sockets[index];
+
+    /* Take the socket off the queue first, so later events queue it again.  */
+    old_posture = tx_interrupt_control(TX_INT_DISABLE);
+    server_socket_queued[index] = NX_FALSE;
+    tx_interrupt_control(old_posture);
+
+    switch (server_socket_state[index])
+    {
+        case SERVER_SOCKET_LISTEN:
+        {
+
+            /* Accept connection from client.  The handshake completes in the IP thread.  */
+            status = nx_tcp_server_socket_accept(socket_ptr, NX_NO_WAIT);
+
+            /* Check status.  */
+            if (status == NX_NOT_CONNECTED)
+            {
+                break;
+            }
+            if ((status != NX_SUCCESS) && (status != NX_IN_PROGRESS))
+            {
+                error_counter++;
+                nx_tcp_server_socket_unaccept(socket_ptr);
+                server_socket_state[index] = SERVER_SOCKET_FREE;
+                server_free_sockets[server_free_count++] = socket_ptr;
+                server_listen_next();
+                break;
+            }
+
+            server_connections++;
+            server_socket_state[index] = SERVER_SOCKET_CONNECTED;
+            server_listen_next();
+
+            /* Echo any data that came in with the connection.  */
+            server_socket_echo(index);
+            break;
+        }
+        case SERVER_SOCKET_CONNECTED:
+        {
+            server_socket_echo(index);
+            break;
+        }
+        case SERVER_SOCKET_CLOSING:
+        {
+            server_socket_close(index);
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+}
+
+/* Echo the data received so far.  */
+static VOID server_socket_echo(ULONG index)
+{
+UINT           status = NX_SUCCESS;
+NX_PACKET     *packet_ptr = server_socket_pending[index];
+NX_TCP_SOCKET *socket_ptr = &server_sockets[index];
+
+    /* Start with the data the client had no window for.  */
+    server_socket_pending[index] = NX_NULL;
+    for (;;)
+    {
+        if (packet_ptr == NX_NULL)
+        {
+            if (nx_tcp_socket_receive(socket_ptr, &packet_ptr, NX_NO_WAIT) != NX_SUCCESS)
+            {
+                break;
+            }
+            server_bytes += packet_ptr -> nx_packet_length;
+        }
+
+        status =  nx_tcp_socket_send(socket_ptr, packet_ptr, NX_NO_WAIT);
+
+        /* Check status.  */
+        if (status != NX_SUCCESS)
+        {
+            break;
+        }
+        packet_ptr = NX_NULL;
+    }
+
+    if (packet_ptr)
+    {
+
+        /* Keep the data until the client opens its window.  Meanwhile the data behind it
+           stays in the socket, which closes our window in turn.  */
+        if ((status == NX_WINDOW_OVERFLOW) || (status == NX_TX_QUEUE_DEPTH))
+        {
+            server_socket_pending[index] = packet_ptr;
+            server_waiting_count++;
+            return;
+        }
+
+        nx_packet_release(packet_ptr);
+        error_counter++;
+        server_socket_close(index);
+    }
+
+    /* Close the connection once the client is done with it.  */
+    else if ((socket_ptr -> nx_tcp_socket_state == NX_TCP_CLOSED) ||
+             (socket_ptr -> nx_tcp_socket_state > NX_TCP_ESTABLISHED))
+    {
+        server_socket_close(index);
+    }
+}
+
+/* Close a connection and return its socket to the pool once closed.  */
+static VOID server_socket_close(ULONG index)
+{
+NX_TCP_SOCKET *socket_ptr = &server_sockets[index];
+
+    /* Start the disconnect, which completes in the IP thread.  */
+    if (server_socket_state[index] != SERVER_SOCKET_CLOSING)
+    {
+        nx_tcp_socket_disconnect(socket_ptr, NX_NO_WAIT);
+        server_socket_state[index] = SERVER_SOCKET_CLOSING;
+        server_waiting_count++;
+    }
+
+    if (socket_ptr -> nx_tcp_socket_state != NX_TCP_CLOSED)
+    {
+        return;
+    }
+
+    nx_tcp_server_socket_unaccept(socket_ptr);
+    server_socket_state[index] = SERVER_SOCKET_FREE;
+    server_free_sockets[server_free_count++] = socket_ptr;
+
+    /* Resume listening if every socket was taken.  */
+    if (server_listen_socket == NX_NULL)
+    {
+        server_listen_next();
+    }
 }
+#endif /* SAMPLE_ENABLE_EVENT_LOOP */
 
 static VOID print_ipv6_address(ULONG *ipv6_address)
 {
@@ -2,6 +2,8 @@
 #define NX_USER_H
 
 #define NX_ENABLE_IPV6_ADDRESS_CHANGE_NOTIFY
+#ifndef SAMPLE_NETWORK_DRIVER
 #define SAMPLE_NETWORK_DRIVER _nx_linux_network_driver
+#endif
 
 #endif
\ No newline at end of file
@@ -11,6 +11,12 @@
 
 #include   "tx_api.h"
 #include   "nx_api.h"
+#ifdef SAMPLE_ENABLE_OPEN_LOOP
+#include   "sample_histogram.h"
+#include   <string.h>
+#include   <time.h>
+#include   <errno.h>
+#endif /* SAMPLE_ENABLE_OPEN_LOOP */
 
 /* Define sample IP address.  */
 #define SAMPLE_IPV4_ADDRESS             IP_ADDRESS(192, 168, 1, 2)
@@ -22,9 +28,56 @@
 #define ECHO_DATA                       "ABCDEFGHIJKLMNOPQRSTUVWXYZ "
 #define ECHO_RECEIVE_TIMEOUT            NX_IP_PERIODIC_RATE
 
+/* Define the open loop mode.  With SAMPLE_ENABLE_OPEN_LOOP defined the client sends
+   SAMPLE_OPEN_LOOP_RATE datagrams per second of SAMPLE_OPEN_LOOP_SIZE bytes for
+   SAMPLE_OPEN_LOOP_DURATION seconds, on a fixed schedule that does not wait for replies.  Each
+   datagram carries its sequence number and the time it was due to be sent, so the latency of a
+   datagram sent late because the client fell behind includes the delay.  The sends are paced
+   from the host clock, not the ThreadX tick: the client sleeps in ticks while the next datagram
+   is more than a tick away and on the host clock for the rest, so each one leaves at its due time
+   at any rate, including several per tick.  A receive thread above the client's priority matches
+   the replies and, SAMPLE_OPEN_LOOP_DRAIN ticks after the last send, the client prints loss,
+   reordering and latency percentiles.  */
+#ifdef SAMPLE_ENABLE_OPEN_LOOP
+#ifndef SAMPLE_OPEN_LOOP_RATE
+#define SAMPLE_OPEN_LOOP_RATE           1000
+#endif /* SAMPLE_OPEN_LOOP_RATE */
+
+#ifndef SAMPLE_OPEN_LOOP_SIZE
+#define SAMPLE_OPEN_LOOP_SIZE           64
+#endif /* SAMPLE_OPEN_LOOP_SIZE */
+
+#ifndef SAMPLE_OPEN_LOOP_DURATION
+#define SAMPLE_OPEN_LOOP_DURATION       10
+#endif /* SAMPLE_OPEN_LOOP_DURATION */
+
+#ifndef SAMPLE_OPEN_LOOP_DRAIN
+#define SAMPLE_OPEN_LOOP_DRAIN          NX_IP_PERIODIC_RATE
+#endif /* SAMPLE_OPEN_LOOP_DRAIN */
+
+/* Define the datagram header: the sequence number, then the due time in microseconds.  */
+#define SAMPLE_OPEN_LOOP_HEADER_SIZE    (sizeof(ULONG) + sizeof(ULONG64))
+#define SAMPLE_OPEN_LOOP_COUNT          ((ULONG)SAMPLE_OPEN_LOOP_RATE * SAMPLE_OPEN_LOOP_DURATION)
+
+/* Define the length of a tick in microseconds.  */
+#define SAMPLE_OPEN_LOOP_TICK_TIME      (1000000 / NX_IP_PERIODIC_RATE)
+
+#if SAMPLE_OPEN_LOOP_SIZE < 12
+#error "SAMPLE_OPEN_LOOP_SIZE must leave room for the sequence number and send time"
+#endif
+
+#if (SAMPLE_OPEN_LOOP_RATE < 1) || (SAMPLE_OPEN_LOOP_RATE > 1000000)
+#error "SAMPLE_OPEN_LOOP_RATE must be between 1 and 1000000 datagrams per second"
+#endif
+#endif /* SAMPLE_ENABLE_OPEN_LOOP */
+
 /* Define packet pool.  */
 #define PACKET_SIZE                     1536
+#ifdef SAMPLE_ENABLE_OPEN_LOOP
+#define PACKET_COUNT                    256
+#else
 #define PACKET_COUNT                    30
+#endif /* SAMPLE_ENABLE_OPEN_LOOP */
 #define PACKET_POOL_SIZE                ((PACKET_SIZE + sizeof(NX_PACKET)) * PACKET_COUNT)
 
 /* Define IP stack size.   */
@@ -44,28 +97,60 @@
 
 /* Define UDP socket TTL and receive queue size.  */
 #define SAMPLE_SOCKET_TTL               0x80
+#ifdef SAMPLE_ENABLE_OPEN_LOOP
+#define SAMPLE_SOCKET_RX_QUEUE_MAXIMUM  (PACKET_COUNT / 2)
+#else
 #define SAMPLE_SOCKET_RX_QUEUE_MAXIMUM  5
+#endif /* SAMPLE_ENABLE_OPEN_LOOP */
 
 /* Define the ThreadX and NetX object control blocks...  */
 NX_PACKET_POOL          default_pool;
 NX_IP                   default_ip;
 NX_UDP_SOCKET           udp_client;
 TX_THREAD               client_thread;
+#ifdef SAMPLE_ENABLE_OPEN_LOOP
+TX_THREAD               receive_thread;
+TX_SEMAPHORE            receive_done_semaphore;
+#endif /* SAMPLE_ENABLE_OPEN_LOOP */
 
 /* Define memory buffers.  */
 ULONG                   pool_area[PACKET_POOL_SIZE >> 2];
 ULONG                   ip_stack[IP_STACK_SIZE >> 2];
 ULONG                   arp_area[ARP_POOL_SIZE >> 2];
 ULONG                   client_thread_stack[SAMPLE_THREAD_STACK_SIZE >> 2];
+#ifdef SAMPLE_ENABLE_OPEN_LOOP
+ULONG                   receive_thread_stack[SAMPLE_THREAD_STACK_SIZE >> 2];
+UCHAR                   open_loop_data[SAMPLE_OPEN_LOOP_SIZE];
+
+/* Define the replies seen, and their latency in microseconds.  */
+UCHAR                   open_loop_received_map[(SAMPLE_OPEN_LOOP_COUNT + 7) / 8];
+SAMPLE_HISTOGRAM        open_loop_latency;
+ULONG64                 open_loop_start_time;
+UINT                    open_loop_send_done;
+#endif /* SAMPLE_ENABLE_OPEN_LOOP */
 
 /* Define the counters used in the demo application...  */
 ULONG                   error_counter;
+#ifdef SAMPLE_ENABLE_OPEN_LOOP
+ULONG                   open_loop_sent;
+ULONG                   open_loop_send_errors;
+ULONG                   open_loop_received;
+ULONG                   open_loop_reordered;
+ULONG                   open_loop_duplicated;
+#endif /* SAMPLE_ENABLE_OPEN_LOOP */
 
 /***** Substitute your ethernet driver entry function here *********/
-extern  VOID _nx_linux_network_driver(NX_IP_DRIVER*);
+extern  VOID SAMPLE_NETWORK_DRIVER(NX_IP_DRIVER*);
 
 /* Define thread prototypes.  */
 void client_thread_entry(ULONG thread_input);
+#ifdef SAMPLE_ENABLE_OPEN_LOOP
+void receive_thread_entry(ULONG thread_input);
+static VOID open_loop_wait(ULONG64 due_time);
+static VOID open_loop_send(NXD_ADDRESS *server_address, ULONG sequence, ULONG64 due_time);
+static VOID open_loop_report(VOID);
+static ULONG64 open_loop_time_get(VOID);
+#endif /* SAMPLE_ENABLE_OPEN_LOOP */
 
 /* Define main entry point.  */
 int main()
@@ -102,7 +187,7 @@ UINT    status;
 
     /* Create an IP instance.  */
     status = nx_ip_create(&default_ip, "NetX IP Instance 0", SAMPLE_IPV4_ADDRESS, SAMPLE_IPV4_MASK,
-                          &default_pool, _nx_linux_network_driver,
+                          &default_pool, SAMPLE_NETWORK_DRIVER,
                           (void *)ip_stack, sizeof(ip_stack), IP_THREAD_PRIORITY);
 
     /* Check for IP create errors.  */
@@ -149,7 +234,13 @@ UINT    status;
 void client_thread_entry(ULONG thread_input)
 {
 UINT       status;
+#ifdef SAMPLE_ENABLE_OPEN_LOOP
+ULONG       i;
+ULONG       sequence;
+ULONG64     due_time;
+#else
 NX_PACKET *packet_ptr;
+#endif /* SAMPLE_ENABLE_OPEN_LOOP */
 NXD_ADDRESS echo_server_address;
 
     /* Set echo server address.  */
@@ -177,6 +268,40 @@ NXD_ADDRESS echo_server_address;
         return;
     }
 
+#ifdef SAMPLE_ENABLE_OPEN_LOOP
+    /* Fill the payload after the header with ABCs.  */
+    for (i = 0; i < SAMPLE_OPEN_LOOP_SIZE; i++)
+    {
+        open_loop_data[i] = (UCHAR)ECHO_DATA[i % (sizeof(ECHO_DATA) - 1)];
+    }
+
+    /* Start the receive thread above the client, so a reply is taken as soon as it arrives
+       even while the client waits on the host clock.  */
+    printf("Sending %lu datagrams/s of %lu bytes for %lu s\r\n",
+           (ULONG)SAMPLE_OPEN_LOOP_RATE, (ULONG)SAMPLE_OPEN_LOOP_SIZE, (ULONG)SAMPLE_OPEN_LOOP_DURATION);
+    tx_semaphore_create(&receive_done_semaphore, "Receive Done", 0);
+    sample_histogram_reset(&open_loop_latency);
+    tx_thread_create(&receive_thread, "Receive Thread", receive_thread_entry, 0,
+                     receive_thread_stack, sizeof(receive_thread_stack),
+                     SAMPLE_THREAD_PRIORITY - 1, SAMPLE_THREAD_PRIORITY - 1, TX_NO_TIME_SLICE, TX_AUTO_START);
+    open_loop_start_time = open_loop_time_get();
+
+    /* Send each datagram at its due time, whether or not earlier ones were answered.  */
+    for (sequence = 0; sequence < SAMPLE_OPEN_LOOP_COUNT; sequence++)
+    {
+        due_time = open_loop_start_time + (ULONG64)sequence * 1000000 / SAMPLE_OPEN_LOOP_RATE;
+        open_loop_wait(due_time);
+        open_loop_send(&echo_server_address, sequence, due_time);
+    }
+    open_loop_sent = sequence;
+
+    /* Give the last replies time to come back, then stop the receive thread.  */
+    tx_thread_sleep(SAMPLE_OPEN_LOOP_DRAIN);
+    open_loop_send_done = NX_TRUE;
+    tx_semaphore_get(&receive_done_semaphore, TX_WAIT_FOREVER);
+
+    open_loop_report();
+#else
     /* Loop to send data to echo server.  */
     for (;;)
     {
@@ -232,8 +357,164 @@ NXD_ADDRESS echo_server_address;
             tx_thread_sleep(NX_IP_PERIODIC_RATE);
         }
     }
+#endif /* SAMPLE_ENABLE_OPEN_LOOP */
 
     /* Cleanup the UDP socket.  */
     nx_udp_socket_unbind(&udp_client);
     nx_udp_socket_delete(&udp_client);
-}
\ No newline at end of file
+}
+
+#ifdef SAMPLE_ENABLE_OPEN_LOOP
+/* Receive thread entry.  */
+void receive_thread_entry(ULONG thread_input)
+{
+UINT       status;
+ULONG      bytes;
+ULONG      sequence;
+ULONG      next_sequence = 0;
+ULONG64    now;
+ULONG64    due_time;
+UCHAR      header[SAMPLE_OPEN_LOOP_HEADER_SIZE];
+NX_PACKET *packet_ptr;
+
+    NX_PARAMETER_NOT_USED(thread_input);
+
+    while (!open_loop_send_done)
+    {
+
+        /* Receive data from echo server.  */
+        status =  nx_udp_socket_receive(&udp_client, &packet_ptr, 1);
+        if (status)
+        {
+            continue;
+        }
+
+        now = open_loop_time_get();
+        status = nx_packet_data_extract_offset(packet_ptr, 0, header, sizeof(header), &bytes);
+        nx_packet_release(packet_ptr);
+        if ((status != NX_SUCCESS) || (bytes != sizeof(header)))
+        {
+            error_counter++;
+            continue;
+        }
+        memcpy(&sequence, header, sizeof(ULONG));
+        memcpy(&due_time, header + sizeof(ULONG), sizeof(ULONG64));
+        if (sequence >= SAMPLE_OPEN_LOOP_COUNT)
+        {
+            error_counter++;
+            continue;
+        }
+
+        /* Count each datagram once.  */
+        if (open_loop_received_map[sequence >> 3] & (1 << (sequence & 7)))
+        {
+            open_loop_duplicated++;
+            continue;
+        }
+        open_loop_received_map[sequence >> 3] |= (UCHAR)(1 << (sequence & 7));
+
+        /* A datagram behind one already received was reordered.  */
+        if (sequence < next_sequence)
+        {
+            open_loop_reordered++;
+        }
+        else
+        {
+            next_sequence = sequence + 1;
+        }
+
+        open_loop_received++;
+        sample_histogram_record(&open_loop_latency, (ULONG)(now - due_time));
+    }
+
+    tx_semaphore_put(&receive_done_semaphore);
+}
+
+/* Wait until the due time.  Whole ticks are slept in ThreadX, so other threads run, and the
+   rest on the host clock, which is exact to microseconds.  A datagram already late is sent now.  */
+static VOID open_loop_wait(ULONG64 due_time)
+{
+ULONG64         now;
+struct timespec due;
+
+    for (now = open_loop_time_get(); now + SAMPLE_OPEN_LOOP_TICK_TIME < due_time; now = open_loop_time_get())
+    {
+        tx_thread_sleep(1);
+    }
+
+    if (now < due_time)
+    {
+        due.tv_sec = (time_t)(due_time / 1000000);
+        due.tv_nsec = (long)(due_time % 1000000) * 1000;
+
+        /* The ThreadX timer signal interrupts the sleep, so sleep again to the same time.  */
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NX_NULL) == EINTR)
+        {
+        }
+    }
+}
+
+/* Send a datagram stamped with its sequence number and due time.  */
+static VOID open_loop_send(NXD_ADDRESS *server_address, ULONG sequence, ULONG64 due_time)
+{
+UINT       status;
+NX_PACKET *packet_ptr;
+
+    memcpy(open_loop_data, &sequence, sizeof(ULONG));
+    memcpy(open_loop_data + sizeof(ULONG), &due_time, sizeof(ULONG64));
+
+    /* Allocate a packet without waiting, as the schedule does not wait.  */
+    status =  nx_packet_allocate(&default_pool, &packet_ptr, NX_UDP_PACKET, NX_NO_WAIT);
+
+    /* Check status.  */
+    if (status != NX_SUCCESS)
+    {
+        open_loop_send_errors++;
+        return;
+    }
+
+    status = nx_packet_data_append(packet_ptr, open_loop_data, SAMPLE_OPEN_LOOP_SIZE, &default_pool, NX_NO_WAIT);
+
+    /* Check status.  */
+    if (status != NX_SUCCESS)
+    {
+        nx_packet_release(packet_ptr);
+        open_loop_send_errors++;
+        return;
+    }
+
+    /* Send data to echo server.  */
+    status =  nxd_udp_socket_send(&udp_client, packet_ptr, server_address, ECHO_SERVER_PORT);
+
+    /* Check status.  */
+    if (status != NX_SUCCESS)
+    {
+        nx_packet_release(packet_ptr);
+        open_loop_send_errors++;
+    }
+}
+
+/* Print loss, reordering and latency percentiles.  */
+static VOID open_loop_report(VOID)
+{
+ULONG sent = open_loop_sent - open_loop_send_errors;
+ULONG lost = sent - open_loop_received;
+
+    printf("Sent %lu, send errors %lu, received %lu, lost %lu (%lu.%02lu%%), reordered %lu, duplicated %lu\r\n",
+           open_loop_sent, open_loop_send_errors, open_loop_received, lost,
+           sent ? (ULONG)((ULONG64)lost * 100 / sent) : 0, sent ? (ULONG)((ULONG64)lost * 10000 / sent % 100) : 0,
+           open_loop_reordered, open_loop_duplicated);
+
+    /* Replies that never came are lost, not slow, so the percentiles are over the replies.  */
+    sample_histogram_print(&open_loop_latency, "Latency", "us");
+}
+
+/* Read the host clock in microseconds; ThreadX ticks are too coarse for echo latency.  */
+static ULONG64 open_loop_time_get(VOID)
+{
+struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return((ULONG64)now.tv_sec * 1000000 + (ULONG64)now.tv_nsec / 1000);
+}
+#endif /* SAMPLE_ENABLE_OPEN_LOOP */
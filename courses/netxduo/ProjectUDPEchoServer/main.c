@@ -62,7 +62,7 @@ ULONG                   server_thread_stack[SAMPLE_THREAD_STACK_SIZE >> 2];
 ULONG                   error_counter;
 
 /***** Substitute your ethernet driver entry function here *********/
-extern  VOID _nx_linux_network_driver(NX_IP_DRIVER*);
+extern  VOID SAMPLE_NETWORK_DRIVER(NX_IP_DRIVER*);
 
 /* Define thread prototypes.  */
 void server_thread_entry(ULONG thread_input);
@@ -102,7 +102,7 @@ UINT    status;
 
     /* Create an IP instance.  */
     status = nx_ip_create(&default_ip, "NetX IP Instance 0", SAMPLE_IPV4_ADDRESS, SAMPLE_IPV4_MASK,
-                          &default_pool, _nx_linux_network_driver,
+                          &default_pool, SAMPLE_NETWORK_DRIVER,
                           (void *)ip_stack, sizeof(ip_stack), IP_THREAD_PRIORITY);
 
     /* Check for IP create errors.  */
@@ -7,6 +7,7 @@
    and modify the output section. */
 
 #include   "tx_api.h"
+#include   "sample_histogram.h"
 #include   <stdio.h>
 
 #define     STACK_SIZE         1024
@@ -22,6 +23,9 @@ TX_TIMER       stats_timer;
 ULONG         Urgent_counter = 0, total_Urgent_time = 0,
 Routine_counter = 0, total_Routine_time = 0;
 
+/* Define the distribution of cycle times, in timer ticks. */
+SAMPLE_HISTOGRAM  Urgent_cycle_times, Routine_cycle_times;
+
 /* Define variables for Routine thread performance info */
 ULONG Routine_resumptions, Routine_suspensions, Routine_solicited_preemptions;
 
@@ -48,6 +52,10 @@ void    tx_application_define(void* first_unused_memory)
 {
     CHAR* Urgent_stack_ptr, * Routine_stack_ptr;
 
+    /* Empty the cycle time histograms.  */
+    sample_histogram_reset(&Urgent_cycle_times);
+    sample_histogram_reset(&Routine_cycle_times);
+
     /* Create a byte memory pool from which to allocate the thread stacks.  */
     tx_byte_pool_create(&my_byte_pool, "my_byte_pool",
         first_unused_memory, BYTE_POOL_SIZE);
@@ -104,6 +112,7 @@ void    Urgent_entry(ULONG thread_input)
         current_time = tx_time_get();
         cycle_time = current_time - start_time;
         total_Urgent_time += cycle_time;
+        sample_histogram_record(&Urgent_cycle_times, cycle_time);
     }
 }
 
@@ -134,6 +143,7 @@ void    Routine_entry(ULONG thread_input)
         current_time = tx_time_get();
         cycle_time = current_time - start_time;
         total_Routine_time += cycle_time;
+        sample_histogram_record(&Routine_cycle_times, cycle_time);
     }
 }
 
@@ -165,6 +175,10 @@ void print_stats(ULONG invalue)
         printf("             Routine counter:    %lu\n", Routine_counter);
         printf("            Routine avg time:    %lu\n\n", avg_Routine_time);
 
+        sample_histogram_print(&Urgent_cycle_times, "   Urgent cycle time", "ticks");
+        sample_histogram_print(&Routine_cycle_times, "  Routine cycle time", "ticks");
+        printf("\n");
+
         printf("   Routine Thread resumptions:   %lu\n", Routine_resumptions);
         printf("   Routine Thread suspensions:   %lu\n", Routine_suspensions);
         printf("Routine solicited_preemptions:   %lu\n\n", Routine_solicited_preemptions);
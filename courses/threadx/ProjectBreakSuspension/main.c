@@ -6,6 +6,7 @@
    Sua tarefa é detectar a inatividade do thread Rotine e interromper sua suspensão. */
 
 #include   "tx_api.h"
+#include   "sample_histogram.h"
 #include   <stdio.h>
 
 #define     STACK_SIZE         1024
@@ -21,6 +22,9 @@ TX_TIMER       stats_timer;
 ULONG    Urgent_counter = 0, total_Urgent_time = 0;
 ULONG    Routine_counter = 0, total_Routine_time = 0;
 
+/* Defina a distribuição dos tempos de ciclo, em ticks. */
+SAMPLE_HISTOGRAM  Urgent_cycle_times, Routine_cycle_times;
+
 /* Defina a contagem de execuções atual para as threads Urgente e Routine. */
 ULONG	 Urgent_previous_run_count = 0;
 ULONG	 Routine_previous_run_count = 0;
@@ -56,6 +60,10 @@ void    tx_application_define(void* first_unused_memory)
 {
     CHAR* Urgent_stack_ptr, * Routine_stack_ptr, * Monitor_stack_ptr;
 
+    /* Esvazie os histogramas de tempo de ciclo.  */
+    sample_histogram_reset(&Urgent_cycle_times);
+    sample_histogram_reset(&Routine_cycle_times);
+
     /* Crie um pool de memória de bytes a partir do qual alocar as pilhas das threads.  */
     tx_byte_pool_create(&my_byte_pool, "my_byte_pool",
                         first_unused_memory, BYTE_POOL_SIZE);
@@ -126,6 +134,7 @@ void    Urgent_entry(ULONG thread_input)
         current_time = tx_time_get();
         cycle_time = current_time - start_time;
         total_Urgent_time += cycle_time;
+        sample_histogram_record(&Urgent_cycle_times, cycle_time);
     }
 }
 
@@ -167,6 +176,7 @@ void    Routine_entry(ULONG thread_input)
         current_time = tx_time_get();
         cycle_time = current_time - start_time;
         total_Routine_time += cycle_time;
+        sample_histogram_record(&Routine_cycle_times, cycle_time);
     }
 }
 
@@ -237,6 +247,11 @@ void print_stats(ULONG invalue)
         printf("           Routine counter:       %lu\n", Routine_counter); // Imprime informações sobre a thread Routine
         printf("          Routine avg time:       %lu\n\n", avg_Routine_time); // Imprime informações sobre a thread Routine
 
+        // Imprime a distribuição dos tempos de ciclo das duas threads
+        sample_histogram_print(&Urgent_cycle_times, "         Urgent cycle time", "ticks");
+        sample_histogram_print(&Routine_cycle_times, "        Routine cycle time", "ticks");
+        printf("\n");
+
         // Imprime informações sobre as operações de retomada e suspensão da thread Urgente
         printf(" Urgent Thread resumptions:       %lu\n", resumptions_Urgent);
         printf("               suspensions:       %lu\n", suspensions_Urgent);
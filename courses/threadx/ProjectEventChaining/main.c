@@ -14,6 +14,7 @@
    /*    Declarations, Definitions, and Prototypes     */
    /****************************************************/
 #include   "tx_api.h"
+#include   "sample_histogram.h"
 #include   <stdio.h>
 
 #define     STACK_SIZE         1024
@@ -53,6 +54,7 @@ ULONG          Enqueued_1 = 0, Enqueued_2 = 0;
 /* Define the variables used in the project application  */
 ULONG  Urgent_thread_counter = 0, total_Urgent_time = 0;
 ULONG  Routine_thread_counter = 0, total_Routine_time = 0;
+SAMPLE_HISTOGRAM  Urgent_cycle_times, Routine_cycle_times;
 ULONG  send_message_1[TX_1_ULONG] = { 0X0 },
 send_message_2[TX_1_ULONG] = { 0X0 };
 ULONG  receive_message_1[TX_1_ULONG],
@@ -94,6 +96,10 @@ void    tx_application_define(void* first_unused_memory)
     CHAR* Urgent_stack_ptr, * Routine_stack_ptr;
     CHAR* Queue_1_ptr, * Queue_2_ptr;
 
+    /* Empty the cycle time histograms.  */
+    sample_histogram_reset(&Urgent_cycle_times);
+    sample_histogram_reset(&Routine_cycle_times);
+
     /* Create a byte memory pool from which to allocate the thread stacks.  */
     tx_byte_pool_create(&my_byte_pool, "my_byte_pool",
         first_unused_memory, BYTE_POOL_SIZE);
@@ -192,6 +198,7 @@ void    Urgent_thread_entry(ULONG thread_input)
         current_time = tx_time_get();
         cycle_time = current_time - start_time;
         total_Urgent_time += cycle_time;
+        sample_histogram_record(&Urgent_cycle_times, cycle_time);
     }
 }
 
@@ -230,6 +237,7 @@ void   Routine_thread_entry(ULONG thread_input)
         current_time = tx_time_get();
         cycle_time = current_time - start_time;
         total_Routine_time += cycle_time;
+        sample_histogram_record(&Routine_cycle_times, cycle_time);
     }
 }
 
@@ -257,6 +265,10 @@ void print_stats(ULONG invalue)
     printf("          Routine_thread counter:   %lu\n", Routine_thread_counter);
     printf("         Routine_thread avg time:   %lu\n\n", avg_Routine_time);
 
+    sample_histogram_print(&Urgent_cycle_times, "        Urgent_thread cycle time", "ticks");
+    sample_histogram_print(&Routine_cycle_times, "       Routine_thread cycle time", "ticks");
+    printf("\n");
+
     printf(" total # messages sent to Queue_1:  %lu\n", send_message_1[TX_1_ULONG - 1]);
     printf(" total # messages sent to Queue_2:  %lu\n", send_message_2[TX_1_ULONG - 1]);
     printf("    current # messages in Queue_1:  %lu\n", Enqueued_1);